@@ -0,0 +1,96 @@
+#ifndef __INCL_ALIGNEDALLOCATOR_H__
+#define __INCL_ALIGNEDALLOCATOR_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include "MemoryResource.h"
+#include "Instrumentation.h"
+
+// Allocator returning storage aligned to Alignment bytes, so that the SIMD
+// kernels in VectorKernels.h never split a vector load across cache lines.
+// The storage comes from the memory resource current on the thread when the
+// allocator is made, the heap unless a MemoryResourceScope says otherwise;
+// see MemoryResource.h. The allocator follows the container on moves and
+// swaps, and copies of a container take the resource current at the copy.
+
+template < class T, std::size_t Alignment = 64 >
+class AlignedAllocator
+{
+	static_assert( Alignment >= alignof( T ) && Alignment <= 256 && ( Alignment & ( Alignment - 1 ) ) == 0,
+				   "Alignment must be a power of two no larger than 256 and no smaller than alignof( T )" );
+
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	template < class U >
+	struct rebind
+	{
+		typedef AlignedAllocator< U, Alignment > other;
+	};
+
+	AlignedAllocator() noexcept :
+		_resource( currentResource() )
+		{}
+	explicit AlignedAllocator( MemoryResource* resource ) noexcept :
+		_resource( resource )
+		{}
+	template < class U >
+		AlignedAllocator( const AlignedAllocator< U, Alignment >& other ) noexcept :
+			_resource( other.resource() )
+		{}
+
+	T* allocate( std::size_t );
+	void deallocate( T*, std::size_t ) noexcept;
+
+	AlignedAllocator< T, Alignment > select_on_container_copy_construction() const;
+	MemoryResource* resource() const noexcept;
+
+private:
+	MemoryResource* _resource;
+};
+
+template < class T, std::size_t Alignment >
+T* AlignedAllocator< T, Alignment >::allocate( std::size_t n )
+{
+	if( n > ( std::size_t( -1 ) - Alignment ) / sizeof( T ) )
+		throw std::bad_alloc();
+
+	LINEAR_ALGEBRA_INSTRUMENT_ALLOCATION( n * sizeof( T ) );
+
+	return static_cast< T* >( _resource->allocate( n * sizeof( T ), Alignment ) );
+}
+
+template < class T, std::size_t Alignment >
+void AlignedAllocator< T, Alignment >::deallocate( T* p, std::size_t n ) noexcept
+{
+	_resource->deallocate( p, n * sizeof( T ), Alignment );
+}
+
+template < class T, std::size_t Alignment >
+AlignedAllocator< T, Alignment > AlignedAllocator< T, Alignment >::select_on_container_copy_construction() const
+{
+	return AlignedAllocator< T, Alignment >();
+}
+
+template < class T, std::size_t Alignment >
+MemoryResource* AlignedAllocator< T, Alignment >::resource() const noexcept
+{
+	return _resource;
+}
+
+template < class T, class U, std::size_t Alignment >
+bool operator== ( const AlignedAllocator< T, Alignment >& lhs, const AlignedAllocator< U, Alignment >& rhs )
+{
+	return lhs.resource() == rhs.resource();
+}
+
+template < class T, class U, std::size_t Alignment >
+bool operator!= ( const AlignedAllocator< T, Alignment >& lhs, const AlignedAllocator< U, Alignment >& rhs )
+{
+	return !( lhs == rhs );
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef __INCL_CHECKED_H__
+#define __INCL_CHECKED_H__
+
+#include "Matrix.h"
+#include <limits>
+#include <type_traits>
+#include <iostream>
+#include <exception>
+
+// Checked< T > wraps a signed integer and throws instead of wrapping around
+// when an operation overflows. It is an exact type as far as
+// std::numeric_limits is concerned, so Matrix< Checked< T > > takes the
+// fraction-free rref path and reports overflow rather than returning a
+// silently wrong result.
+
+template < class T >
+class Checked
+{
+	static_assert( std::is_integral< T >::value && std::is_signed< T >::value, "Checked needs a signed integer type" );
+
+public:
+	constexpr Checked() :
+		_value( 0 )
+		{}
+	constexpr Checked( const T value ) :
+		_value( value )
+		{}
+	template < class U >
+		explicit Checked( const Checked< U >& );
+
+	constexpr T value() const;
+	explicit constexpr operator T() const;
+
+	Checked< T >& operator+= ( const Checked< T >& );
+	Checked< T >& operator-= ( const Checked< T >& );
+	Checked< T >& operator*= ( const Checked< T >& );
+	Checked< T >& operator/= ( const Checked< T >& );
+	Checked< T >& operator%= ( const Checked< T >& );
+
+	Checked< T > operator- () const;
+
+	// Defined here so that mixed expressions such as x != 0 convert.
+	friend Checked< T > operator+ ( Checked< T > lhs, const Checked< T >& rhs ) { return lhs += rhs; }
+	friend Checked< T > operator- ( Checked< T > lhs, const Checked< T >& rhs ) { return lhs -= rhs; }
+	friend Checked< T > operator* ( Checked< T > lhs, const Checked< T >& rhs ) { return lhs *= rhs; }
+	friend Checked< T > operator/ ( Checked< T > lhs, const Checked< T >& rhs ) { return lhs /= rhs; }
+	friend Checked< T > operator% ( Checked< T > lhs, const Checked< T >& rhs ) { return lhs %= rhs; }
+
+	friend constexpr bool operator== ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value == rhs._value; }
+	friend constexpr bool operator!= ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value != rhs._value; }
+	friend constexpr bool operator< ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value < rhs._value; }
+	friend constexpr bool operator> ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value > rhs._value; }
+	friend constexpr bool operator<= ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value <= rhs._value; }
+	friend constexpr bool operator>= ( const Checked< T >& lhs, const Checked< T >& rhs ) { return lhs._value >= rhs._value; }
+
+private:
+	static void overflow();
+
+	T _value;
+};
+
+template < class T >
+template < class U >
+Checked< T >::Checked( const Checked< U >& other ) :
+	_value( T( other.value() ) )
+{
+	if( U( _value ) != other.value() || ( _value < 0 ) != ( other.value() < 0 ) )
+		overflow();
+}
+
+template < class T >
+constexpr T Checked< T >::value() const
+{
+	return _value;
+}
+
+template < class T >
+constexpr Checked< T >::operator T() const
+{
+	return _value;
+}
+
+template < class T >
+Checked< T >& Checked< T >::operator+= ( const Checked< T >& rhs )
+{
+	if( __builtin_add_overflow( _value, rhs._value, &_value ) )
+		overflow();
+
+	return *this;
+}
+
+template < class T >
+Checked< T >& Checked< T >::operator-= ( const Checked< T >& rhs )
+{
+	if( __builtin_sub_overflow( _value, rhs._value, &_value ) )
+		overflow();
+
+	return *this;
+}
+
+template < class T >
+Checked< T >& Checked< T >::operator*= ( const Checked< T >& rhs )
+{
+	if( __builtin_mul_overflow( _value, rhs._value, &_value ) )
+		overflow();
+
+	return *this;
+}
+
+template < class T >
+Checked< T >& Checked< T >::operator/= ( const Checked< T >& rhs )
+{
+	if( rhs._value == 0 || ( _value == std::numeric_limits< T >::min() && rhs._value == -1 ) )
+		overflow();
+
+	_value /= rhs._value;
+
+	return *this;
+}
+
+template < class T >
+Checked< T >& Checked< T >::operator%= ( const Checked< T >& rhs )
+{
+	if( rhs._value == 0 )
+		overflow();
+
+	_value = ( rhs._value == -1 ) ? 0 : _value % rhs._value;
+
+	return *this;
+}
+
+template < class T >
+Checked< T > Checked< T >::operator- () const
+{
+	if( _value == std::numeric_limits< T >::min() )
+		overflow();
+
+	return Checked< T >( -_value );
+}
+
+template < class T >
+void Checked< T >::overflow()
+{
+	class IntegerOverflowException
+		: public std::exception
+	{
+		virtual const char* what() const throw()
+		{
+			return "Integer operation overflowed or divided by zero.";
+		}
+	} ex;
+
+	throw ex;
+}
+
+template < class T >
+std::ostream& operator<< ( std::ostream& out, const Checked< T >& cChecked )
+{
+	return out << cChecked.value();
+}
+
+// The cross products of fraction-free elimination are formed in a wider
+// checked type where one exists, so only results that really do not fit
+// in T are reported.
+template < class T >
+struct WideInteger< Checked< T > >
+{
+	typedef Checked< typename std::conditional< ( sizeof( T ) < sizeof( long long ) ), long long, T >::type > type;
+};
+
+namespace std
+{
+	template < class T >
+	class numeric_limits< Checked< T > >
+		: public numeric_limits< T >
+	{
+	public:
+		static constexpr Checked< T > min() noexcept { return numeric_limits< T >::min(); }
+		static constexpr Checked< T > max() noexcept { return numeric_limits< T >::max(); }
+		static constexpr Checked< T > lowest() noexcept { return numeric_limits< T >::lowest(); }
+	};
+}
+
+#endif
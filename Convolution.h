@@ -0,0 +1,391 @@
+#ifndef __INCL_CONVOLUTION_H__
+#define __INCL_CONVOLUTION_H__
+
+#include "VectorKernels.h"
+#include "AlignedAllocator.h"
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+
+// Convolution< T >::multiply writes the product of the polynomials with
+// coefficients a[0..n) and b[0..m) to out[0..n+m-1), which must be zeroed
+// and must not overlap either input. The method is chosen by size:
+//
+//   - schoolbook, one SIMD axpy per coefficient, below KARATSUBA;
+//   - Karatsuba, O( n^1.58 ), for any coefficient ring;
+//   - above TRANSFORM, a floating point FFT for float and double, or for
+//     integral types an NTT over three primes recombined by the Chinese
+//     remainder theorem. The thresholds are where the transforms overtook
+//     Karatsuba on an AVX-512 machine. The NTT is only used when the
+//     coefficients are small enough for every output to be recovered
+//     exactly; otherwise the product stays on Karatsuba.
+
+template < class T >
+struct Convolution
+{
+	// The FFT computes in double, so it only serves types no more precise
+	// than that; long double stays on Karatsuba rather than lose digits.
+	static const bool FFT = std::is_floating_point< T >::value && std::numeric_limits< T >::digits <= std::numeric_limits< double >::digits;
+
+	static const std::size_t KARATSUBA = 32;
+	static const std::size_t TRANSFORM = FFT ? 4096 : 8192;
+
+	static void multiply( const T*, const std::size_t, const T*, const std::size_t, T* );
+	static void schoolbook( const T*, const std::size_t, const T*, const std::size_t, T* );
+	static void karatsuba( const T*, const std::size_t, const T*, const std::size_t, T* );
+
+private:
+	// Transform buffers come from the current memory resource, like the
+	// containers they serve.
+	typedef std::vector< std::complex< double >, AlignedAllocator< std::complex< double > > > ComplexBuffer;
+	typedef std::vector< std::uint32_t, AlignedAllocator< std::uint32_t > > ResidueBuffer;
+
+	static void karatsubaSquare( const T*, const T*, const std::size_t, T*, T* );
+
+	static void fft( ComplexBuffer&, const bool );
+	static std::uint32_t powMod( std::uint64_t, std::uint64_t, const std::uint32_t );
+	static void ntt( ResidueBuffer&, const std::uint32_t, const bool );
+	static void nttMultiply( ResidueBuffer&, ResidueBuffer, const std::uint32_t );
+	static std::uint32_t residue( const T, const std::uint32_t, std::true_type );
+	static std::uint32_t residue( const T, const std::uint32_t, std::false_type );
+
+	static bool transform( const T*, const std::size_t, const T*, const std::size_t, T*, std::true_type, std::false_type );
+	static bool transform( const T*, const std::size_t, const T*, const std::size_t, T*, std::false_type, std::true_type );
+	static bool transform( const T*, const std::size_t, const T*, const std::size_t, T*, std::false_type, std::false_type );
+};
+
+template < class T >
+void Convolution< T >::multiply( const T* a, const std::size_t n, const T* b, const std::size_t m, T* out )
+{
+	if( n == 0 || m == 0 )
+		return;
+
+	if( std::min( n, m ) >= TRANSFORM &&
+		transform( a, n, b, m, out, std::integral_constant< bool, FFT >(), std::integral_constant< bool, std::is_integral< T >::value && sizeof( T ) <= 8 >() ) )
+		return;
+
+	karatsuba( a, n, b, m, out );
+}
+
+template < class T >
+void Convolution< T >::schoolbook( const T* a, const std::size_t n, const T* b, const std::size_t m, T* out )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		if( a[i] != T( 0 ) )
+			VectorKernels< T >::axpy( out + i, a[i], b, m );
+}
+
+// Unbalanced operands are cut into pieces the length of the shorter one,
+// each multiplied square and added in at its offset.
+template < class T >
+void Convolution< T >::karatsuba( const T* a, const std::size_t n, const T* b, const std::size_t m, T* out )
+{
+	if( n < m )
+		return karatsuba( b, m, a, n, out );
+
+	if( m < KARATSUBA )
+		return schoolbook( a, n, b, m, out );
+
+	std::vector< T, AlignedAllocator< T > > piece( m, T( 0 ) ), product( 2 * m - 1 ), scratch( 6 * m + 64 );
+
+	for( std::size_t i = 0; i < n; i += m )
+	{
+		const std::size_t length = std::min( m, n - i );
+
+		std::copy( a + i, a + i + length, piece.begin() );
+		std::fill( piece.begin() + length, piece.end(), T( 0 ) );
+		std::fill( product.begin(), product.end(), T( 0 ) );
+
+		karatsubaSquare( piece.data(), b, m, product.data(), scratch.data() );
+		VectorKernels< T >::add( out + i, product.data(), std::min( product.size(), n + m - 1 - i ) );
+	}
+}
+
+// a and b both have n coefficients; out ( 2n - 1, zeroed ) receives
+// a0 b0 + ( ( a0 + a1 )( b0 + b1 ) - a0 b0 - a1 b1 ) x^h + a1 b1 x^2h.
+template < class T >
+void Convolution< T >::karatsubaSquare( const T* a, const T* b, const std::size_t n, T* out, T* scratch )
+{
+	if( n < KARATSUBA )
+		return schoolbook( a, n, b, n, out );
+
+	const std::size_t h = n / 2, k = n - h;
+
+	karatsubaSquare( a, b, h, out, scratch );
+	karatsubaSquare( a + h, b + h, k, out + 2 * h, scratch );
+
+	T* sa = scratch;
+	T* sb = sa + k;
+	T* middle = sb + k;
+
+	std::copy( a + h, a + n, sa );
+	std::copy( b + h, b + n, sb );
+	VectorKernels< T >::add( sa, a, h );
+	VectorKernels< T >::add( sb, b, h );
+	std::fill( middle, middle + 2 * k - 1, T( 0 ) );
+
+	karatsubaSquare( sa, sb, k, middle, middle + 2 * k - 1 );
+
+	VectorKernels< T >::subtract( middle, out, 2 * h - 1 );
+	VectorKernels< T >::subtract( middle, out + 2 * h, 2 * k - 1 );
+	VectorKernels< T >::add( out + h, middle, 2 * k - 1 );
+}
+
+// Transforms
+
+// In-place iterative radix-2 transform of length a.size(), a power of two.
+// The roots come from a table computed directly rather than by repeated
+// multiplication, which keeps the rounding error at O( log n ) ulps.
+template < class T >
+void Convolution< T >::fft( ComplexBuffer& a, const bool inverse )
+{
+	const std::size_t n = a.size();
+
+	for( std::size_t i = 1, j = 0; i < n; i++ )
+	{
+		std::size_t bit = n >> 1;
+		for( ; j & bit; bit >>= 1 )
+			j ^= bit;
+		j ^= bit;
+
+		if( i < j )
+			std::swap( a[i], a[j] );
+	}
+
+	const double pi = std::acos( -1.0 );
+	ComplexBuffer roots( n / 2 );
+
+	for( std::size_t i = 0; i < n / 2; i++ )
+		roots[i] = std::polar( 1.0, ( inverse ? 2 : -2 ) * pi * i / n );
+
+	for( std::size_t length = 2; length <= n; length <<= 1 )
+	{
+		const std::size_t step = n / length;
+
+		for( std::size_t i = 0; i < n; i += length )
+			for( std::size_t j = 0; j < length / 2; j++ )
+			{
+				const std::complex< double > u = a[ i + j ];
+				const std::complex< double > v = a[ i + j + length / 2 ] * roots[ j * step ];
+
+				a[ i + j ] = u + v;
+				a[ i + j + length / 2 ] = u - v;
+			}
+	}
+
+	if( inverse )
+		for( std::size_t i = 0; i < n; i++ )
+			a[i] /= double( n );
+}
+
+// Floating point: a is packed into the real part and b into the imaginary
+// part of one transform, and the two spectra are separated afterwards, so
+// the product costs two transforms instead of three.
+template < class T >
+bool Convolution< T >::transform( const T* a, const std::size_t n, const T* b, const std::size_t m, T* out, std::true_type, std::false_type )
+{
+	const std::size_t length = n + m - 1;
+	std::size_t size = 1;
+	while( size < length )
+		size <<= 1;
+
+	ComplexBuffer p( size );
+
+	for( std::size_t i = 0; i < n; i++ )
+		p[i].real( double( a[i] ) );
+	for( std::size_t i = 0; i < m; i++ )
+		p[i].imag( double( b[i] ) );
+
+	fft( p, false );
+
+	// A[k] B[k] = ( P[k]^2 - conj( P[-k] )^2 ) / 4i
+	ComplexBuffer q( size );
+	const std::complex< double > scale( 0.0, -0.25 );
+
+	for( std::size_t k = 0; k < size; k++ )
+	{
+		const std::complex< double > x = p[k], y = std::conj( p[ ( size - k ) & ( size - 1 ) ] );
+		q[k] = ( x * x - y * y ) * scale;
+	}
+
+	fft( q, true );
+
+	for( std::size_t i = 0; i < length; i++ )
+		out[i] = T( q[i].real() );
+
+	return true;
+}
+
+// Arithmetic modulo one of the NTT primes, all of the form c 2^k + 1 with
+// primitive root 3.
+
+template < class T >
+std::uint32_t Convolution< T >::powMod( std::uint64_t base, std::uint64_t exponent, const std::uint32_t p )
+{
+	std::uint64_t out = 1;
+	base %= p;
+
+	for( ; exponent; exponent >>= 1 )
+	{
+		if( exponent & 1 )
+			out = out * base % p;
+		base = base * base % p;
+	}
+
+	return std::uint32_t( out );
+}
+
+template < class T >
+void Convolution< T >::ntt( ResidueBuffer& a, const std::uint32_t p, const bool inverse )
+{
+	const std::size_t n = a.size();
+
+	for( std::size_t i = 1, j = 0; i < n; i++ )
+	{
+		std::size_t bit = n >> 1;
+		for( ; j & bit; bit >>= 1 )
+			j ^= bit;
+		j ^= bit;
+
+		if( i < j )
+			std::swap( a[i], a[j] );
+	}
+
+	for( std::size_t length = 2; length <= n; length <<= 1 )
+	{
+		std::uint64_t root = powMod( 3, ( p - 1 ) / length, p );
+		if( inverse )
+			root = powMod( root, p - 2, p );
+
+		ResidueBuffer roots( length / 2 );
+		roots[0] = 1;
+		for( std::size_t j = 1; j < length / 2; j++ )
+			roots[j] = std::uint32_t( roots[ j - 1 ] * root % p );
+
+		for( std::size_t i = 0; i < n; i += length )
+			for( std::size_t j = 0; j < length / 2; j++ )
+			{
+				const std::uint32_t u = a[ i + j ];
+				const std::uint32_t v = std::uint32_t( std::uint64_t( a[ i + j + length / 2 ] ) * roots[j] % p );
+
+				a[ i + j ] = ( u + v >= p ) ? u + v - p : u + v;
+				a[ i + j + length / 2 ] = ( u >= v ) ? u - v : u + p - v;
+			}
+	}
+
+	if( inverse )
+	{
+		const std::uint64_t scale = powMod( n, p - 2, p );
+		for( std::size_t i = 0; i < n; i++ )
+			a[i] = std::uint32_t( a[i] * scale % p );
+	}
+}
+
+// Cyclic product of a and b modulo p, left in a.
+template < class T >
+void Convolution< T >::nttMultiply( ResidueBuffer& a, ResidueBuffer b, const std::uint32_t p )
+{
+	ntt( a, p, false );
+	ntt( b, p, false );
+
+	for( std::size_t i = 0; i < a.size(); i++ )
+		a[i] = std::uint32_t( std::uint64_t( a[i] ) * b[i] % p );
+
+	ntt( a, p, true );
+}
+
+template < class T >
+std::uint32_t Convolution< T >::residue( const T value, const std::uint32_t p, std::true_type )
+{
+	const long long r = static_cast< long long >( value ) % p;
+	return std::uint32_t( r < 0 ? r + p : r );
+}
+
+template < class T >
+std::uint32_t Convolution< T >::residue( const T value, const std::uint32_t p, std::false_type )
+{
+	return std::uint32_t( static_cast< unsigned long long >( value ) % p );
+}
+
+// Integral: the residues modulo three primes whose product P exceeds 2^85
+// determine every output coefficient below 2^84 in magnitude, which the
+// coefficient bound checked first guarantees. Converting the result back
+// to T then wraps exactly as the schoolbook product would.
+template < class T >
+bool Convolution< T >::transform( const T* a, const std::size_t n, const T* b, const std::size_t m, T* out, std::false_type, std::true_type )
+{
+#ifdef __SIZEOF_INT128__
+	static const std::uint32_t primes[3] = { 998244353u, 167772161u, 469762049u };
+
+	const std::size_t length = n + m - 1;
+	std::size_t size = 1;
+	while( size < length )
+		size <<= 1;
+
+	if( size > ( std::size_t( 1 ) << 23 ) )
+		return false;
+
+	long double maxA = 0, maxB = 0;
+	for( std::size_t i = 0; i < n; i++ )
+		maxA = std::max( maxA, std::fabs( static_cast< long double >( a[i] ) ) );
+	for( std::size_t i = 0; i < m; i++ )
+		maxB = std::max( maxB, std::fabs( static_cast< long double >( b[i] ) ) );
+
+	if( maxA * maxB * std::min( n, m ) >= std::ldexp( 1.0L, 84 ) )
+		return false;
+
+	ResidueBuffer residues[3];
+
+	for( unsigned int j = 0; j < 3; j++ )
+	{
+		ResidueBuffer x( size, 0 ), y( size, 0 );
+
+		for( std::size_t i = 0; i < n; i++ )
+			x[i] = residue( a[i], primes[j], std::is_signed< T >() );
+		for( std::size_t i = 0; i < m; i++ )
+			y[i] = residue( b[i], primes[j], std::is_signed< T >() );
+
+		nttMultiply( x, std::move( y ), primes[j] );
+		residues[j] = std::move( x );
+	}
+
+	// Garner's mixed-radix reconstruction.
+	__extension__ typedef unsigned __int128 Wide;
+	__extension__ typedef __int128 SignedWide;
+
+	const std::uint64_t p0 = primes[0], p1 = primes[1], p2 = primes[2];
+	const std::uint64_t inv0mod1 = powMod( p0, p1 - 2, p1 );
+	const std::uint64_t inv01mod2 = powMod( p0 * p1 % p2, p2 - 2, p2 );
+	const Wide product = Wide( p0 ) * p1 * p2;
+
+	for( std::size_t i = 0; i < length; i++ )
+	{
+		const std::uint64_t x0 = residues[0][i];
+		const std::uint64_t x1 = ( residues[1][i] + p1 - x0 % p1 ) % p1 * inv0mod1 % p1;
+		const std::uint64_t partial = ( x0 + p0 * x1 ) % p2;
+		const std::uint64_t x2 = ( residues[2][i] + p2 - partial ) % p2 * inv01mod2 % p2;
+
+		const Wide x = Wide( x0 ) + Wide( p0 ) * x1 + Wide( p0 ) * p1 * x2;
+		const SignedWide value = ( x > product / 2 ) ? SignedWide( x ) - SignedWide( product ) : SignedWide( x );
+
+		out[i] = static_cast< T >( value );
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+template < class T >
+bool Convolution< T >::transform( const T*, const std::size_t, const T*, const std::size_t, T*, std::false_type, std::false_type )
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef __INCL_EVALUATION_H__
+#define __INCL_EVALUATION_H__
+
+#include "VectorKernels.h"
+#include <cstddef>
+#include <algorithm>
+
+// EvaluationKernels< T >::horner writes the value of the polynomial with
+// coefficients c[0..n) at each of x[0..count) to out[0..count). Horner's rule
+// is one long chain of dependent multiply-adds per point, so the points are
+// taken several at a time and their chains interleaved: LANES scalar
+// accumulators in the plain loop, or four registers of points with SIMD.
+// out may alias x.
+
+template < class T, bool Simd = SimdTraits< T >::supported >
+struct EvaluationKernels
+{
+	static const std::size_t LANES = 8;
+
+	static void horner( const T*, const std::size_t, const T*, const std::size_t, T* );
+	static T horner( const T*, const std::size_t, const T& );
+};
+
+template < class T, bool Simd >
+void EvaluationKernels< T, Simd >::horner( const T* c, const std::size_t n, const T* x, const std::size_t count, T* out )
+{
+	if( n == 0 )
+	{
+		std::fill( out, out + count, T( 0 ) );
+		return;
+	}
+
+	std::size_t i = 0;
+	for( ; i + LANES <= count; i += LANES )
+	{
+		T point[ LANES ], acc[ LANES ];
+		for( std::size_t j = 0; j < LANES; j++ )
+		{
+			point[j] = x[ i + j ];
+			acc[j] = c[ n - 1 ];
+		}
+
+		for( std::size_t k = n - 1; k-- > 0; )
+			for( std::size_t j = 0; j < LANES; j++ )
+				acc[j] = acc[j] * point[j] + c[k];
+
+		std::copy( acc, acc + LANES, out + i );
+	}
+
+	for( ; i < count; i++ )
+		out[i] = horner( c, n, x[i] );
+}
+
+template < class T, bool Simd >
+T EvaluationKernels< T, Simd >::horner( const T* c, const std::size_t n, const T& x )
+{
+	if( n == 0 )
+		return T( 0 );
+
+	T acc = c[ n - 1 ];
+	for( std::size_t k = n - 1; k-- > 0; )
+		acc = acc * x + c[k];
+
+	return acc;
+}
+
+#ifdef LINEAR_ALGEBRA_SIMD
+
+// As with the vector kernels, the loop is spelled out once per instruction
+// set. Each coefficient is broadcast once and shared by all four registers.
+
+template < class T >
+struct Sse41Horner
+{
+	typedef Sse41Ops< typename SimdTraits< T >::lane > Ops;
+	typedef typename Ops::reg reg;
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static std::size_t apply( const T* c, const std::size_t n, const T* x, const std::size_t count, T* out )
+	{
+		const std::size_t w = Ops::width;
+		std::size_t i = 0;
+
+		for( ; i + 4 * w <= count; i += 4 * w )
+		{
+			const reg x0 = Ops::load( x + i ), x1 = Ops::load( x + i + w ), x2 = Ops::load( x + i + 2 * w ), x3 = Ops::load( x + i + 3 * w );
+			reg a0 = Ops::set1( c[ n - 1 ] ), a1 = a0, a2 = a0, a3 = a0;
+
+			for( std::size_t k = n - 1; k-- > 0; )
+			{
+				const reg ck = Ops::set1( c[k] );
+				a0 = Ops::add( Ops::mul( a0, x0 ), ck );
+				a1 = Ops::add( Ops::mul( a1, x1 ), ck );
+				a2 = Ops::add( Ops::mul( a2, x2 ), ck );
+				a3 = Ops::add( Ops::mul( a3, x3 ), ck );
+			}
+
+			Ops::store( out + i, a0 );
+			Ops::store( out + i + w, a1 );
+			Ops::store( out + i + 2 * w, a2 );
+			Ops::store( out + i + 3 * w, a3 );
+		}
+
+		for( ; i + w <= count; i += w )
+		{
+			const reg x0 = Ops::load( x + i );
+			reg a0 = Ops::set1( c[ n - 1 ] );
+
+			for( std::size_t k = n - 1; k-- > 0; )
+				a0 = Ops::add( Ops::mul( a0, x0 ), Ops::set1( c[k] ) );
+
+			Ops::store( out + i, a0 );
+		}
+
+		return i;
+	}
+};
+
+template < class T >
+struct Avx2Horner
+{
+	typedef Avx2Ops< typename SimdTraits< T >::lane > Ops;
+	typedef typename Ops::reg reg;
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static std::size_t apply( const T* c, const std::size_t n, const T* x, const std::size_t count, T* out )
+	{
+		const std::size_t w = Ops::width;
+		std::size_t i = 0;
+
+		for( ; i + 4 * w <= count; i += 4 * w )
+		{
+			const reg x0 = Ops::load( x + i ), x1 = Ops::load( x + i + w ), x2 = Ops::load( x + i + 2 * w ), x3 = Ops::load( x + i + 3 * w );
+			reg a0 = Ops::set1( c[ n - 1 ] ), a1 = a0, a2 = a0, a3 = a0;
+
+			for( std::size_t k = n - 1; k-- > 0; )
+			{
+				const reg ck = Ops::set1( c[k] );
+				a0 = Ops::add( Ops::mul( a0, x0 ), ck );
+				a1 = Ops::add( Ops::mul( a1, x1 ), ck );
+				a2 = Ops::add( Ops::mul( a2, x2 ), ck );
+				a3 = Ops::add( Ops::mul( a3, x3 ), ck );
+			}
+
+			Ops::store( out + i, a0 );
+			Ops::store( out + i + w, a1 );
+			Ops::store( out + i + 2 * w, a2 );
+			Ops::store( out + i + 3 * w, a3 );
+		}
+
+		for( ; i + w <= count; i += w )
+		{
+			const reg x0 = Ops::load( x + i );
+			reg a0 = Ops::set1( c[ n - 1 ] );
+
+			for( std::size_t k = n - 1; k-- > 0; )
+				a0 = Ops::add( Ops::mul( a0, x0 ), Ops::set1( c[k] ) );
+
+			Ops::store( out + i, a0 );
+		}
+
+		return i;
+	}
+};
+
+template < class T >
+struct Avx512Horner
+{
+	typedef Avx512Ops< typename SimdTraits< T >::lane > Ops;
+	typedef typename Ops::reg reg;
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static std::size_t apply( const T* c, const std::size_t n, const T* x, const std::size_t count, T* out )
+	{
+		const std::size_t w = Ops::width;
+		std::size_t i = 0;
+
+		for( ; i + 4 * w <= count; i += 4 * w )
+		{
+			const reg x0 = Ops::load( x + i ), x1 = Ops::load( x + i + w ), x2 = Ops::load( x + i + 2 * w ), x3 = Ops::load( x + i + 3 * w );
+			reg a0 = Ops::set1( c[ n - 1 ] ), a1 = a0, a2 = a0, a3 = a0;
+
+			for( std::size_t k = n - 1; k-- > 0; )
+			{
+				const reg ck = Ops::set1( c[k] );
+				a0 = Ops::add( Ops::mul( a0, x0 ), ck );
+				a1 = Ops::add( Ops::mul( a1, x1 ), ck );
+				a2 = Ops::add( Ops::mul( a2, x2 ), ck );
+				a3 = Ops::add( Ops::mul( a3, x3 ), ck );
+			}
+
+			Ops::store( out + i, a0 );
+			Ops::store( out + i + w, a1 );
+			Ops::store( out + i + 2 * w, a2 );
+			Ops::store( out + i + 3 * w, a3 );
+		}
+
+		for( ; i + w <= count; i += w )
+		{
+			const reg x0 = Ops::load( x + i );
+			reg a0 = Ops::set1( c[ n - 1 ] );
+
+			for( std::size_t k = n - 1; k-- > 0; )
+				a0 = Ops::add( Ops::mul( a0, x0 ), Ops::set1( c[k] ) );
+
+			Ops::store( out + i, a0 );
+		}
+
+		return i;
+	}
+};
+
+template < class T >
+struct EvaluationKernels< T, true >
+{
+	static void horner( const T*, const std::size_t, const T*, const std::size_t, T* );
+	static T horner( const T*, const std::size_t, const T& );
+};
+
+template < class T >
+void EvaluationKernels< T, true >::horner( const T* c, const std::size_t n, const T* x, const std::size_t count, T* out )
+{
+	if( n == 0 )
+	{
+		std::fill( out, out + count, T( 0 ) );
+		return;
+	}
+
+	std::size_t done;
+
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: done = Avx512Horner< T >::apply( c, n, x, count, out ); break;
+	case SIMD_AVX2: done = Avx2Horner< T >::apply( c, n, x, count, out ); break;
+	case SIMD_SSE41: done = Sse41Horner< T >::apply( c, n, x, count, out ); break;
+	default: done = 0;
+	}
+
+	EvaluationKernels< T, false >::horner( c, n, x + done, count - done, out + done );
+}
+
+template < class T >
+T EvaluationKernels< T, true >::horner( const T* c, const std::size_t n, const T& x )
+{
+	return EvaluationKernels< T, false >::horner( c, n, x );
+}
+
+#endif
+
+#endif
@@ -0,0 +1,377 @@
+#ifndef __INCL_FIXEDMATRIX_H__
+#define __INCL_FIXEDMATRIX_H__
+
+#include "Matrix.h"
+#include "FixedVector.h"
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <iomanip>
+
+// Matrix< T, R, C > for R, C > 0 stores its R * C elements row-major in a
+// std::array. Products, transposes and element-wise arithmetic are
+// constexpr and fully unrolled, and the dimensions of every operation are
+// checked by the type system.
+
+template < class T, unsigned int R, unsigned int C >
+class Matrix
+{
+	static_assert( R > 0 && C > 0, "A fixed-size Matrix needs at least one row and one column" );
+
+public:
+	typedef T value_type;
+	typedef std::array< T, R * C > container_type;
+
+	constexpr Matrix() :
+		_values{}
+		{}
+	template < class... Ts, class = typename std::enable_if< sizeof...( Ts ) == R * C >::type >
+		constexpr Matrix( const Ts&... values ) :
+			_values{ { T( values )... } }
+			{}
+
+	static constexpr Matrix< T, R, C > identity();
+
+	Matrix< T, R, C >& operator+= ( const Matrix< T, R, C >& );
+	Matrix< T, R, C >& operator-= ( const Matrix< T, R, C >& );
+	template < class V > Matrix< T, R, C >& operator*= ( const V& );
+	template < class V > Matrix< T, R, C >& operator/= ( const V& );
+
+	T* operator[] ( const unsigned int );
+	constexpr const T* operator[] ( const unsigned int ) const;
+
+	constexpr const T& element( const unsigned int ) const;
+
+	T* data() noexcept;
+	const T* data() const noexcept;
+
+	constexpr Vector< T, C > getRow( const unsigned int ) const;
+	constexpr Vector< T, R > getColumn( const unsigned int ) const;
+
+	constexpr unsigned int numRows() const;
+	constexpr unsigned int numColumns() const;
+	constexpr unsigned int length() const;
+
+	constexpr Matrix< T, C, R > transpose() const;
+
+	template < class Op >
+		static constexpr Matrix< T, R, C > elementwise( const Matrix< T, R, C >&, const Matrix< T, R, C >& );
+	template < class Op, class U >
+		static constexpr Matrix< T, R, C > elementwise( const Matrix< T, R, C >&, const U& );
+	template < unsigned int K >
+		static constexpr Matrix< T, R, C > product( const Matrix< T, R, K >&, const Matrix< T, K, C >& );
+	static constexpr Vector< T, R > product( const Matrix< T, R, C >&, const Vector< T, C >& );
+
+private:
+	template < std::size_t... I >
+		static constexpr Matrix< T, R, C > identity( std::index_sequence< I... > );
+	template < std::size_t... I >
+		constexpr Vector< T, C > getRow( const unsigned int, std::index_sequence< I... > ) const;
+	template < std::size_t... I >
+		constexpr Vector< T, R > getColumn( const unsigned int, std::index_sequence< I... > ) const;
+	template < std::size_t... I >
+		constexpr Matrix< T, C, R > transpose( std::index_sequence< I... > ) const;
+
+	template < class Op, std::size_t... I >
+		static constexpr Matrix< T, R, C > elementwise( const Matrix< T, R, C >&, const Matrix< T, R, C >&, std::index_sequence< I... > );
+	template < class Op, class U, std::size_t... I >
+		static constexpr Matrix< T, R, C > elementwise( const Matrix< T, R, C >&, const U&, std::index_sequence< I... > );
+	template < unsigned int K >
+		static constexpr T productElement( const Matrix< T, R, K >&, const Matrix< T, K, C >&, const unsigned int, const unsigned int );
+	template < unsigned int K, std::size_t... I >
+		static constexpr Matrix< T, R, C > product( const Matrix< T, R, K >&, const Matrix< T, K, C >&, std::index_sequence< I... > );
+	template < std::size_t... I >
+		static constexpr Vector< T, R > product( const Matrix< T, R, C >&, const Vector< T, C >&, std::index_sequence< I... > );
+
+	container_type _values;
+};
+
+template < class T, unsigned int R, unsigned int C >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::identity()
+{
+	return identity( std::make_index_sequence< R * C >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < std::size_t... I >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::identity( std::index_sequence< I... > )
+{
+	return Matrix< T, R, C >( T( I / C == I % C ? 1 : 0 )... );
+}
+
+// Member operator overloads
+
+template < class T, unsigned int R, unsigned int C >
+Matrix< T, R, C >& Matrix< T, R, C >::operator+= ( const Matrix< T, R, C >& cMatrix )
+{
+	for( unsigned int i = 0; i < R * C; i++ )
+		_values[i] += cMatrix._values[i];
+
+	return *this;
+}
+
+template < class T, unsigned int R, unsigned int C >
+Matrix< T, R, C >& Matrix< T, R, C >::operator-= ( const Matrix< T, R, C >& cMatrix )
+{
+	for( unsigned int i = 0; i < R * C; i++ )
+		_values[i] -= cMatrix._values[i];
+
+	return *this;
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < class V >
+Matrix< T, R, C >& Matrix< T, R, C >::operator*= ( const V& scalar )
+{
+	for( unsigned int i = 0; i < R * C; i++ )
+		_values[i] *= scalar;
+
+	return *this;
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < class V >
+Matrix< T, R, C >& Matrix< T, R, C >::operator/= ( const V& scalar )
+{
+	for( unsigned int i = 0; i < R * C; i++ )
+		_values[i] /= scalar;
+
+	return *this;
+}
+
+template < class T, unsigned int R, unsigned int C >
+T* Matrix< T, R, C >::operator[] ( const unsigned int r )
+{
+	return &( _values[ r * C ] );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr const T* Matrix< T, R, C >::operator[] ( const unsigned int r ) const
+{
+	return &( _values[ r * C ] );
+}
+
+// Element i of the row-major storage.
+template < class T, unsigned int R, unsigned int C >
+constexpr const T& Matrix< T, R, C >::element( const unsigned int i ) const
+{
+	return _values[i];
+}
+
+template < class T, unsigned int R, unsigned int C >
+T* Matrix< T, R, C >::data() noexcept
+{
+	return _values.data();
+}
+
+template < class T, unsigned int R, unsigned int C >
+const T* Matrix< T, R, C >::data() const noexcept
+{
+	return _values.data();
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr Vector< T, C > Matrix< T, R, C >::getRow( const unsigned int r ) const
+{
+	return getRow( r, std::make_index_sequence< C >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < std::size_t... I >
+constexpr Vector< T, C > Matrix< T, R, C >::getRow( const unsigned int r, std::index_sequence< I... > ) const
+{
+	return Vector< T, C >( _values[ r * C + I ]... );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr Vector< T, R > Matrix< T, R, C >::getColumn( const unsigned int c ) const
+{
+	return getColumn( c, std::make_index_sequence< R >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < std::size_t... I >
+constexpr Vector< T, R > Matrix< T, R, C >::getColumn( const unsigned int c, std::index_sequence< I... > ) const
+{
+	return Vector< T, R >( _values[ I * C + c ]... );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr unsigned int Matrix< T, R, C >::numRows() const
+{
+	return R;
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr unsigned int Matrix< T, R, C >::numColumns() const
+{
+	return C;
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr unsigned int Matrix< T, R, C >::length() const
+{
+	return R * C;
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr Matrix< T, C, R > Matrix< T, R, C >::transpose() const
+{
+	return transpose( std::make_index_sequence< R * C >() );
+}
+
+// Element I of the transpose is element ( I / R, I % R ) of the transpose,
+// i.e. ( I % R, I / R ) of this matrix.
+template < class T, unsigned int R, unsigned int C >
+template < std::size_t... I >
+constexpr Matrix< T, C, R > Matrix< T, R, C >::transpose( std::index_sequence< I... > ) const
+{
+	return Matrix< T, C, R >( _values[ ( I % R ) * C + I / R ]... );
+}
+
+// Arithmetic, expanded over the index pack like the transpose.
+
+template < class T, unsigned int R, unsigned int C >
+template < class Op >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::elementwise( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs )
+{
+	return elementwise< Op >( lhs, rhs, std::make_index_sequence< R * C >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < class Op, class U >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::elementwise( const Matrix< T, R, C >& lhs, const U& scalar )
+{
+	return elementwise< Op >( lhs, scalar, std::make_index_sequence< R * C >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < unsigned int K >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::product( const Matrix< T, R, K >& lhs, const Matrix< T, K, C >& rhs )
+{
+	return product( lhs, rhs, std::make_index_sequence< R * C >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr Vector< T, R > Matrix< T, R, C >::product( const Matrix< T, R, C >& lhs, const Vector< T, C >& rhs )
+{
+	return product( lhs, rhs, std::make_index_sequence< R >() );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < class Op, std::size_t... I >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::elementwise( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs, std::index_sequence< I... > )
+{
+	return Matrix< T, R, C >( Op::apply( lhs.element( I ), rhs.element( I ) )... );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < class Op, class U, std::size_t... I >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::elementwise( const Matrix< T, R, C >& lhs, const U& scalar, std::index_sequence< I... > )
+{
+	return Matrix< T, R, C >( Op::apply( lhs.element( I ), scalar )... );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < unsigned int K >
+constexpr T Matrix< T, R, C >::productElement( const Matrix< T, R, K >& lhs, const Matrix< T, K, C >& rhs, const unsigned int r, const unsigned int c )
+{
+	T out( 0 );
+
+	for( unsigned int k = 0; k < K; k++ )
+		out += lhs[r][k] * rhs[k][c];
+
+	return out;
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < unsigned int K, std::size_t... I >
+constexpr Matrix< T, R, C > Matrix< T, R, C >::product( const Matrix< T, R, K >& lhs, const Matrix< T, K, C >& rhs, std::index_sequence< I... > )
+{
+	return Matrix< T, R, C >( productElement( lhs, rhs, I / C, I % C )... );
+}
+
+template < class T, unsigned int R, unsigned int C >
+template < std::size_t... I >
+constexpr Vector< T, R > Matrix< T, R, C >::product( const Matrix< T, R, C >& lhs, const Vector< T, C >& rhs, std::index_sequence< I... > )
+{
+	return Vector< T, R >( dot( lhs.getRow( I ), rhs )... );
+}
+
+// Free operator overloads
+
+template < class T, unsigned int R, unsigned int K, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && K > 0 && C > 0 ), Matrix< T, R, C > > operator* ( const Matrix< T, R, K >& lhs, const Matrix< T, K, C >& rhs )
+{
+	return Matrix< T, R, C >::product( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && C > 0 ), Vector< T, R > > operator* ( const Matrix< T, R, C >& lhs, const Vector< T, C >& rhs )
+{
+	return Matrix< T, R, C >::product( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && C > 0 ), Matrix< T, R, C > > operator+ ( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs )
+{
+	return Matrix< T, R, C >::template elementwise< VectorAdd >( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && C > 0 ), Matrix< T, R, C > > operator- ( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs )
+{
+	return Matrix< T, R, C >::template elementwise< VectorSubtract >( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C, class U >
+constexpr EnableIfFixed< ( R > 0 && C > 0 && std::is_arithmetic< U >::value ), Matrix< T, R, C > >
+operator* ( const Matrix< T, R, C >& lhs, const U& rhs )
+{
+	return Matrix< T, R, C >::template elementwise< VectorMultiply >( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C, class U >
+constexpr EnableIfFixed< ( R > 0 && C > 0 && std::is_arithmetic< U >::value ), Matrix< T, R, C > >
+operator* ( const U& lhs, const Matrix< T, R, C >& rhs )
+{
+	return Matrix< T, R, C >::template elementwise< VectorMultiplyLeft >( rhs, lhs );
+}
+
+template < class T, unsigned int R, unsigned int C, class U >
+constexpr EnableIfFixed< ( R > 0 && C > 0 && std::is_arithmetic< U >::value ), Matrix< T, R, C > >
+operator/ ( const Matrix< T, R, C >& lhs, const U& rhs )
+{
+	return Matrix< T, R, C >::template elementwise< VectorDivide >( lhs, rhs );
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && C > 0 ), bool > operator== ( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs )
+{
+	for( unsigned int i = 0; i < R * C; i++ )
+		if( !( lhs.element( i ) == rhs.element( i ) ) )
+			return false;
+
+	return true;
+}
+
+template < class T, unsigned int R, unsigned int C >
+constexpr EnableIfFixed< ( R > 0 && C > 0 ), bool > operator!= ( const Matrix< T, R, C >& lhs, const Matrix< T, R, C >& rhs )
+{
+	return !( lhs == rhs );
+}
+
+template < class T, unsigned int R, unsigned int C >
+EnableIfFixed< ( R > 0 && C > 0 ), std::ostream& > operator<< ( std::ostream& out, const Matrix< T, R, C >& cMatrix )
+{
+	for( unsigned int r = 0; r < R; r++ )
+	{
+		for( unsigned int c = 0; c < C; c++ )
+			out << std::setw( 10 ) << cMatrix[r][c] << ' ';
+		out << '\n';
+	}
+
+	return out;
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef __INCL_FIXEDVECTOR_H__
+#define __INCL_FIXEDVECTOR_H__
+
+#include "Vector.h"
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <iostream>
+
+// Vector< T, N > for N > 0 holds its elements inline in a std::array. It
+// never allocates, is not polymorphic, and all of its arithmetic is
+// constexpr and unrolled over the compile-time length. Mismatched lengths
+// fail to compile rather than being padded.
+
+template < class T, unsigned int N >
+class Vector
+{
+public:
+	typedef T value_type;
+	typedef std::array< T, N > container_type;
+
+	constexpr Vector() :
+		_values{}
+		{}
+	template < class... Ts, class = typename std::enable_if< sizeof...( Ts ) == N >::type >
+		constexpr Vector( const Ts&... values ) :
+			_values{ { T( values )... } }
+			{}
+
+	typename container_type::iterator begin();
+	typename container_type::iterator end();
+	typename container_type::const_iterator cbegin() const noexcept;
+	typename container_type::const_iterator cend() const noexcept;
+
+	Vector< T, N >& operator+= ( const Vector< T, N >& );
+	Vector< T, N >& operator-= ( const Vector< T, N >& );
+	template < class V > Vector< T, N >& operator*= ( const V& );
+	template < class V > Vector< T, N >& operator/= ( const V& );
+
+	T& operator[] ( const unsigned int );
+	constexpr const T& operator[] ( const unsigned int ) const;
+
+	T* data() noexcept;
+	const T* data() const noexcept;
+
+	constexpr unsigned int length() const;
+
+	template < class Op >
+		static constexpr Vector< T, N > elementwise( const Vector< T, N >&, const Vector< T, N >& );
+	template < class Op, class U >
+		static constexpr Vector< T, N > elementwise( const Vector< T, N >&, const U& );
+
+private:
+	template < class Op, std::size_t... I >
+		static constexpr Vector< T, N > elementwise( const Vector< T, N >&, const Vector< T, N >&, std::index_sequence< I... > );
+	template < class Op, class U, std::size_t... I >
+		static constexpr Vector< T, N > elementwise( const Vector< T, N >&, const U&, std::index_sequence< I... > );
+
+	container_type _values;
+};
+
+// Iterators
+
+template < class T, unsigned int N >
+typename Vector< T, N >::container_type::iterator Vector< T, N >::begin()
+{
+	return _values.begin();
+}
+
+template < class T, unsigned int N >
+typename Vector< T, N >::container_type::iterator Vector< T, N >::end()
+{
+	return _values.end();
+}
+
+template < class T, unsigned int N >
+typename Vector< T, N >::container_type::const_iterator Vector< T, N >::cbegin() const noexcept
+{
+	return _values.cbegin();
+}
+
+template < class T, unsigned int N >
+typename Vector< T, N >::container_type::const_iterator Vector< T, N >::cend() const noexcept
+{
+	return _values.cend();
+}
+
+// Member operator overloads
+
+template < class T, unsigned int N >
+Vector< T, N >& Vector< T, N >::operator+= ( const Vector< T, N >& otherVector )
+{
+	for( unsigned int i = 0; i < N; i++ )
+		_values[i] += otherVector[i];
+
+	return *this;
+}
+
+template < class T, unsigned int N >
+Vector< T, N >& Vector< T, N >::operator-= ( const Vector< T, N >& otherVector )
+{
+	for( unsigned int i = 0; i < N; i++ )
+		_values[i] -= otherVector[i];
+
+	return *this;
+}
+
+template < class T, unsigned int N >
+template < class V >
+Vector< T, N >& Vector< T, N >::operator*= ( const V& scalar )
+{
+	for( unsigned int i = 0; i < N; i++ )
+		_values[i] *= scalar;
+
+	return *this;
+}
+
+template < class T, unsigned int N >
+template < class V >
+Vector< T, N >& Vector< T, N >::operator/= ( const V& scalar )
+{
+	for( unsigned int i = 0; i < N; i++ )
+		_values[i] /= scalar;
+
+	return *this;
+}
+
+template < class T, unsigned int N >
+T& Vector< T, N >::operator[] ( const unsigned int index )
+{
+	return _values[ index ];
+}
+
+template < class T, unsigned int N >
+constexpr const T& Vector< T, N >::operator[] ( const unsigned int index ) const
+{
+	return _values[ index ];
+}
+
+template < class T, unsigned int N >
+T* Vector< T, N >::data() noexcept
+{
+	return _values.data();
+}
+
+template < class T, unsigned int N >
+const T* Vector< T, N >::data() const noexcept
+{
+	return _values.data();
+}
+
+template < class T, unsigned int N >
+constexpr unsigned int Vector< T, N >::length() const
+{
+	return N;
+}
+
+// Element-wise arithmetic, expanded over the index pack so that each
+// result is built in a single constexpr initializer.
+
+template < class T, unsigned int N >
+template < class Op >
+constexpr Vector< T, N > Vector< T, N >::elementwise( const Vector< T, N >& lhs, const Vector< T, N >& rhs )
+{
+	return elementwise< Op >( lhs, rhs, std::make_index_sequence< N >() );
+}
+
+template < class T, unsigned int N >
+template < class Op, class U >
+constexpr Vector< T, N > Vector< T, N >::elementwise( const Vector< T, N >& lhs, const U& scalar )
+{
+	return elementwise< Op >( lhs, scalar, std::make_index_sequence< N >() );
+}
+
+template < class T, unsigned int N >
+template < class Op, std::size_t... I >
+constexpr Vector< T, N > Vector< T, N >::elementwise( const Vector< T, N >& lhs, const Vector< T, N >& rhs, std::index_sequence< I... > )
+{
+	return Vector< T, N >( Op::apply( lhs[ I ], rhs[ I ] )... );
+}
+
+template < class T, unsigned int N >
+template < class Op, class U, std::size_t... I >
+constexpr Vector< T, N > Vector< T, N >::elementwise( const Vector< T, N >& lhs, const U& scalar, std::index_sequence< I... > )
+{
+	return Vector< T, N >( Op::apply( lhs[ I ], scalar )... );
+}
+
+// Restricts the free functions below to N > 0, keeping them away from the
+// dynamic Vector< T > == Vector< T, 0 >.
+template < bool Fixed, class Result >
+using EnableIfFixed = typename std::enable_if< Fixed, Result >::type;
+
+// Free operator overloads
+
+template < class T, unsigned int N >
+constexpr EnableIfFixed< ( N > 0 ), Vector< T, N > > operator+ ( const Vector< T, N >& lhs, const Vector< T, N >& rhs )
+{
+	return Vector< T, N >::template elementwise< VectorAdd >( lhs, rhs );
+}
+
+template < class T, unsigned int N >
+constexpr EnableIfFixed< ( N > 0 ), Vector< T, N > > operator- ( const Vector< T, N >& lhs, const Vector< T, N >& rhs )
+{
+	return Vector< T, N >::template elementwise< VectorSubtract >( lhs, rhs );
+}
+
+template < class T, unsigned int N, class U >
+constexpr EnableIfFixed< ( N > 0 && std::is_arithmetic< U >::value ), Vector< T, N > >
+operator* ( const Vector< T, N >& lhs, const U& rhs )
+{
+	return Vector< T, N >::template elementwise< VectorMultiply >( lhs, rhs );
+}
+
+template < class T, unsigned int N, class U >
+constexpr EnableIfFixed< ( N > 0 && std::is_arithmetic< U >::value ), Vector< T, N > >
+operator* ( const U& lhs, const Vector< T, N >& rhs )
+{
+	return Vector< T, N >::template elementwise< VectorMultiplyLeft >( rhs, lhs );
+}
+
+template < class T, unsigned int N, class U >
+constexpr EnableIfFixed< ( N > 0 && std::is_arithmetic< U >::value ), Vector< T, N > >
+operator/ ( const Vector< T, N >& lhs, const U& rhs )
+{
+	return Vector< T, N >::template elementwise< VectorDivide >( lhs, rhs );
+}
+
+template < class T, unsigned int N >
+constexpr EnableIfFixed< ( N > 0 ), bool > operator== ( const Vector< T, N >& lhs, const Vector< T, N >& rhs )
+{
+	for( unsigned int i = 0; i < N; i++ )
+		if( !( lhs[i] == rhs[i] ) )
+			return false;
+
+	return true;
+}
+
+template < class T, unsigned int N >
+constexpr EnableIfFixed< ( N > 0 ), bool > operator!= ( const Vector< T, N >& lhs, const Vector< T, N >& rhs )
+{
+	return !( lhs == rhs );
+}
+
+template < class T, unsigned int N >
+EnableIfFixed< ( N > 0 ), std::ostream& > operator<< ( std::ostream &out, const Vector< T, N > &cVector )
+{
+	out << "< ";
+
+	for( unsigned int i = 0; i < N; i++ )
+	{
+		out << cVector[i];
+		if( i < N - 1 )
+			out << ", ";
+	}
+
+	out << " >";
+
+	return out;
+}
+
+// Vector arithmetic
+
+template < class T, unsigned int N >
+constexpr EnableIfFixed< ( N > 0 ), T > dot( const Vector< T, N > &firstVector, const Vector< T, N > &secondVector )
+{
+	T out( 0 );
+
+	for( unsigned int i = 0; i < N; i++ )
+		out += firstVector[i] * secondVector[i];
+
+	return out;
+}
+
+template < class T >
+constexpr Vector< T, 3 > cross( const Vector< T, 3 > &lhVector, const Vector< T, 3 > &rhVector )
+{
+	return Vector< T, 3 >( lhVector[1] * rhVector[2] - lhVector[2] * rhVector[1],
+						   lhVector[2] * rhVector[0] - lhVector[0] * rhVector[2],
+						   lhVector[0] * rhVector[1] - lhVector[1] * rhVector[0] );
+}
+
+#endif
@@ -0,0 +1,279 @@
+#ifndef __INCL_GEMM_H__
+#define __INCL_GEMM_H__
+
+#include <vector>
+#include <algorithm>
+#include "AlignedAllocator.h"
+#include "ThreadPool.h"
+
+// Blocking parameters for the packed kernel. MR x NR is the register tile
+// computed by the micro-kernel; KC, MC and NC size the packed panels of B
+// and A so that they stay resident in L1, L2 and L3 respectively.
+
+template < class T >
+struct GemmTraits
+{
+	static const bool packed = false;
+};
+
+template <>
+struct GemmTraits< float >
+{
+	static const bool packed = true;
+	static const unsigned int MR = 6;
+	static const unsigned int NR = 16;
+	static const unsigned int KC = 256;
+	static const unsigned int MC = 144;
+	static const unsigned int NC = 4080;
+};
+
+template <>
+struct GemmTraits< double >
+{
+	static const bool packed = true;
+	static const unsigned int MR = 4;
+	static const unsigned int NR = 8;
+	static const unsigned int KC = 256;
+	static const unsigned int MC = 96;
+	static const unsigned int NC = 4080;
+};
+
+template <>
+struct GemmTraits< int >
+{
+	static const bool packed = true;
+	static const unsigned int MR = 4;
+	static const unsigned int NR = 16;
+	static const unsigned int KC = 256;
+	static const unsigned int MC = 128;
+	static const unsigned int NC = 4080;
+};
+template <>
+struct GemmTraits< unsigned int >
+{
+	static const bool packed = true;
+	static const unsigned int MR = 4;
+	static const unsigned int NR = 16;
+	static const unsigned int KC = 256;
+	static const unsigned int MC = 128;
+	static const unsigned int NC = 4080;
+};
+
+// Gemm< T >::multiply computes C += A * B, where A is m x k, B is k x n and
+// C is m x n, all stored row-major with leading dimensions lda, ldb and ldc.
+
+template < class T, bool Packed = GemmTraits< T >::packed >
+class Gemm;
+
+template < class T >
+class Gemm< T, false >
+{
+public:
+	static void multiply( const unsigned int m, const unsigned int n, const unsigned int k,
+						  const T* a, const unsigned int lda,
+						  const T* b, const unsigned int ldb,
+						  T* c, const unsigned int ldc );
+};
+
+template < class T >
+class Gemm< T, true >
+{
+public:
+	static void multiply( const unsigned int m, const unsigned int n, const unsigned int k,
+						  const T* a, const unsigned int lda,
+						  const T* b, const unsigned int ldb,
+						  T* c, const unsigned int ldc );
+
+private:
+	typedef GemmTraits< T > Traits;
+
+	static void packA( const unsigned int mc, const unsigned int kc,
+					   const T* a, const unsigned int lda, T* packed );
+	static void packB( const unsigned int kc, const unsigned int nc,
+					   const T* b, const unsigned int ldb, T* packed );
+	static void microKernel( const unsigned int kc, const T* a, const T* b,
+							 T* c, const unsigned int ldc,
+							 const unsigned int mr, const unsigned int nr );
+};
+
+// Generic fallback: no packing, but unit-stride access to every operand and
+// no temporaries.
+
+template < class T >
+void Gemm< T, false >::multiply( const unsigned int m, const unsigned int n, const unsigned int k,
+								 const T* a, const unsigned int lda,
+								 const T* b, const unsigned int ldb,
+								 T* c, const unsigned int ldc )
+{
+	for( unsigned int i = 0; i < m; i++ )
+		for( unsigned int p = 0; p < k; p++ )
+		{
+			const T& scalar = a[ i * lda + p ];
+			const T* bRow = b + p * ldb;
+			T* cRow = c + i * ldc;
+
+			for( unsigned int j = 0; j < n; j++ )
+				cRow[j] += scalar * bRow[j];
+		}
+}
+
+// Packed, cache-blocked kernel
+
+template < class T >
+void Gemm< T, true >::multiply( const unsigned int m, const unsigned int n, const unsigned int k,
+								const T* a, const unsigned int lda,
+								const T* b, const unsigned int ldb,
+								T* c, const unsigned int ldc )
+{
+	if( m == 0 || n == 0 || k == 0 )
+		return;
+
+	const unsigned int MR = Traits::MR, NR = Traits::NR;
+	const unsigned int KC = Traits::KC, MC = Traits::MC, NC = Traits::NC;
+
+	std::vector< T, AlignedAllocator< T > > packedA( ( ( std::min( m, MC ) + MR - 1 ) / MR ) * MR * std::min( k, KC ) );
+	std::vector< T, AlignedAllocator< T > > packedB( ( ( std::min( n, NC ) + NR - 1 ) / NR ) * NR * std::min( k, KC ) );
+
+	for( unsigned int jc = 0; jc < n; jc += NC )
+	{
+		const unsigned int nc = std::min( n - jc, NC );
+
+		for( unsigned int pc = 0; pc < k; pc += KC )
+		{
+			const unsigned int kc = std::min( k - pc, KC );
+
+			packB( kc, nc, b + pc * ldb + jc, ldb, packedB.data() );
+
+			for( unsigned int ic = 0; ic < m; ic += MC )
+			{
+				const unsigned int mc = std::min( m - ic, MC );
+
+				packA( mc, kc, a + ic * lda + pc, lda, packedA.data() );
+
+				for( unsigned int jr = 0; jr < nc; jr += NR )
+					for( unsigned int ir = 0; ir < mc; ir += MR )
+						microKernel( kc, packedA.data() + ir * kc, packedB.data() + jr * kc,
+									 c + ( ic + ir ) * ldc + jc + jr, ldc,
+									 std::min( mc - ir, MR ), std::min( nc - jr, NR ) );
+			}
+		}
+	}
+}
+
+// Packs an mc x kc block of A into row panels of height MR, each stored
+// column by column, zero-padding the last panel.
+template < class T >
+void Gemm< T, true >::packA( const unsigned int mc, const unsigned int kc,
+							 const T* a, const unsigned int lda, T* packed )
+{
+	const unsigned int MR = Traits::MR;
+
+	for( unsigned int ir = 0; ir < mc; ir += MR )
+	{
+		const unsigned int mr = std::min( mc - ir, MR );
+
+		for( unsigned int p = 0; p < kc; p++ )
+		{
+			for( unsigned int i = 0; i < mr; i++ )
+				packed[i] = a[ ( ir + i ) * lda + p ];
+			for( unsigned int i = mr; i < MR; i++ )
+				packed[i] = T( 0 );
+			packed += MR;
+		}
+	}
+}
+
+// Packs a kc x nc block of B into column panels of width NR, each stored
+// row by row, zero-padding the last panel.
+template < class T >
+void Gemm< T, true >::packB( const unsigned int kc, const unsigned int nc,
+							 const T* b, const unsigned int ldb, T* packed )
+{
+	const unsigned int NR = Traits::NR;
+
+	for( unsigned int jr = 0; jr < nc; jr += NR )
+	{
+		const unsigned int nr = std::min( nc - jr, NR );
+
+		for( unsigned int p = 0; p < kc; p++ )
+		{
+			const T* bRow = b + p * ldb + jr;
+
+			for( unsigned int j = 0; j < nr; j++ )
+				packed[j] = bRow[j];
+			for( unsigned int j = nr; j < NR; j++ )
+				packed[j] = T( 0 );
+			packed += NR;
+		}
+	}
+}
+
+// Computes an MR x NR tile in registers and adds the top-left mr x nr of it
+// into C.
+template < class T >
+void Gemm< T, true >::microKernel( const unsigned int kc, const T* a, const T* b,
+								   T* c, const unsigned int ldc,
+								   const unsigned int mr, const unsigned int nr )
+{
+	const unsigned int MR = Traits::MR, NR = Traits::NR;
+	T accumulator[ Traits::MR ][ Traits::NR ] = {};
+
+	for( unsigned int p = 0; p < kc; p++ )
+	{
+		for( unsigned int i = 0; i < MR; i++ )
+		{
+			const T scalar = a[i];
+
+			for( unsigned int j = 0; j < NR; j++ )
+				accumulator[i][j] += scalar * b[j];
+		}
+
+		a += MR;
+		b += NR;
+	}
+
+	for( unsigned int i = 0; i < mr; i++ )
+		for( unsigned int j = 0; j < nr; j++ )
+			c[ i * ldc + j ] += accumulator[i][j];
+}
+
+// C += A * B like Gemm< T >::multiply, spread over the pool of the policy
+// when the product is large enough. The product is split into a grid of
+// output tiles, each at least minTile on a side so that repacking the
+// operands stays cheap relative to the tile's arithmetic.
+template < class T >
+void gemm( const unsigned int m, const unsigned int n, const unsigned int k,
+		   const T* a, const unsigned int lda,
+		   const T* b, const unsigned int ldb,
+		   T* c, const unsigned int ldc,
+		   const ExecutionPolicy& policy )
+{
+	if( !policy.parallel( (unsigned long)m * n * k ) )
+	{
+		Gemm< T >::multiply( m, n, k, a, lda, b, ldb, c, ldc );
+		return;
+	}
+
+	const unsigned int minTile = 128;
+	const unsigned int tiles = policy.pool().size() * 4;
+	const unsigned int rowTiles = std::max( 1u, std::min( tiles, m / minTile ) );
+	const unsigned int columnTiles = std::max( 1u, std::min( ( tiles + rowTiles - 1 ) / rowTiles, n / minTile ) );
+
+	policy.pool().parallelFor( 0, rowTiles * columnTiles, [&]( std::size_t first, std::size_t last )
+	{
+		for( std::size_t t = first; t < last; t++ )
+		{
+			const unsigned int r0 = (unsigned long)m * ( t / columnTiles ) / rowTiles;
+			const unsigned int r1 = (unsigned long)m * ( t / columnTiles + 1 ) / rowTiles;
+			const unsigned int c0 = (unsigned long)n * ( t % columnTiles ) / columnTiles;
+			const unsigned int c1 = (unsigned long)n * ( t % columnTiles + 1 ) / columnTiles;
+
+			Gemm< T >::multiply( r1 - r0, c1 - c0, k,
+								 a + (std::size_t)r0 * lda, lda,
+								 b + c0, ldb,
+								 c + (std::size_t)r0 * ldc + c0, ldc );
+		}
+	} );
+}
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef __INCL_INSTRUMENTATION_H__
+#define __INCL_INSTRUMENTATION_H__
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+// Counters of the calls, floating point operations, allocations and wall
+// time of the main operations, kept per thread. They are compiled in only
+// when LINEAR_ALGEBRA_INSTRUMENT is defined; otherwise the hooks expand to
+// nothing and the snapshots below stay empty.
+//
+//   - Times are inclusive: an operation calling another is charged for it
+//     too, and work handed to a ThreadPool counts towards the thread that
+//     called the operation.
+//   - FLOPs are the nominal counts of the classical algorithms, 2 m n k for
+//     a product of m x k by k x n matrices for instance, whichever algorithm
+//     runs, so that rates compare across algorithm choices.
+//   - Allocations made by AlignedAllocator go to the innermost operation
+//     running on the allocating thread, or to OP_OTHER outside any.
+//
+// Each thread writes only its own counters, so recording takes no lock;
+// snapshot() and threads() read them under the registry lock, together
+// with what threads that have since exited left behind.
+
+enum InstrumentedOperation
+{
+	OP_VECTOR_ARITHMETIC,
+	OP_VECTOR_DOT,
+	OP_VECTOR_CROSS,
+	OP_MATRIX_MULTIPLY,
+	OP_MATRIX_TRANSPOSE,
+	OP_MATRIX_RREF,
+	OP_MATRIX_APPEND,
+	OP_POLYNOMIAL_MULTIPLY,
+	OP_POLYNOMIAL_DIVIDE,
+	OP_POLYNOMIAL_POW,
+	OP_POLYNOMIAL_EVALUATE,
+	OP_POLYNOMIAL_DERIVATIVE,
+	OP_OTHER,
+	OP_COUNT
+};
+
+struct OperationStatistics
+{
+	unsigned long long calls;
+	unsigned long long flops;
+	unsigned long long allocations;
+	unsigned long long bytesAllocated;
+	unsigned long long nanoseconds;
+
+	OperationStatistics& operator+= ( const OperationStatistics& );
+};
+
+struct InstrumentationSnapshot
+{
+	std::array< OperationStatistics, OP_COUNT > operations;
+
+	const OperationStatistics& operator[] ( const InstrumentedOperation ) const;
+	InstrumentationSnapshot& operator+= ( const InstrumentationSnapshot& );
+};
+
+struct ThreadStatistics
+{
+	std::thread::id thread;
+	InstrumentationSnapshot statistics;
+};
+
+class Instrumentation
+{
+public:
+	static bool enabled();
+	static const char* name( const InstrumentedOperation );
+
+	static InstrumentationSnapshot snapshot();
+	static std::vector< ThreadStatistics > threads();
+	static void reset();
+
+	static void allocated( const unsigned long long );
+
+private:
+	friend class InstrumentationScope;
+
+	enum Field
+	{
+		CALLS,
+		FLOPS,
+		ALLOCATIONS,
+		BYTES,
+		NANOSECONDS,
+		FIELDS
+	};
+
+	// The counters of one thread, registered for as long as it runs. Only
+	// the owning thread writes values; baseline holds the values at the last
+	// reset() and is guarded by the registry lock.
+	struct ThreadCounters
+	{
+		std::thread::id thread;
+		InstrumentedOperation current;
+		std::atomic< unsigned long long > values[ OP_COUNT ][ FIELDS ];
+		unsigned long long baseline[ OP_COUNT ][ FIELDS ];
+
+		ThreadCounters();
+		~ThreadCounters();
+
+		void add( const InstrumentedOperation, const Field, const unsigned long long );
+		InstrumentationSnapshot read() const;
+	};
+
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector< ThreadCounters* > threads;
+		InstrumentationSnapshot retired;
+	};
+
+	static Registry& registry();
+	static ThreadCounters& local();
+};
+
+// Charges the enclosing block to an operation: one call, the given FLOPs,
+// the time until the end of the block and the allocations made meanwhile.
+class InstrumentationScope
+{
+public:
+	InstrumentationScope( const InstrumentedOperation, const unsigned long long );
+	InstrumentationScope( const InstrumentationScope& ) = delete;
+	~InstrumentationScope();
+
+	InstrumentationScope& operator= ( const InstrumentationScope& ) = delete;
+
+private:
+	Instrumentation::ThreadCounters& _counters;
+	const InstrumentedOperation _operation;
+	const InstrumentedOperation _previous;
+	const std::chrono::steady_clock::time_point _start;
+};
+
+#ifdef LINEAR_ALGEBRA_INSTRUMENT
+#define LINEAR_ALGEBRA_INSTRUMENT_SCOPE( operation, flops ) \
+	InstrumentationScope instrumentationScope( operation, flops )
+#define LINEAR_ALGEBRA_INSTRUMENT_ALLOCATION( bytes ) \
+	Instrumentation::allocated( bytes )
+#else
+#define LINEAR_ALGEBRA_INSTRUMENT_SCOPE( operation, flops ) ( (void)0 )
+#define LINEAR_ALGEBRA_INSTRUMENT_ALLOCATION( bytes ) ( (void)0 )
+#endif
+
+inline OperationStatistics& OperationStatistics::operator+= ( const OperationStatistics& other )
+{
+	calls += other.calls;
+	flops += other.flops;
+	allocations += other.allocations;
+	bytesAllocated += other.bytesAllocated;
+	nanoseconds += other.nanoseconds;
+
+	return *this;
+}
+
+inline const OperationStatistics& InstrumentationSnapshot::operator[] ( const InstrumentedOperation operation ) const
+{
+	return operations[ operation ];
+}
+
+inline InstrumentationSnapshot& InstrumentationSnapshot::operator+= ( const InstrumentationSnapshot& other )
+{
+	for( unsigned int op = 0; op < OP_COUNT; op++ )
+		operations[ op ] += other.operations[ op ];
+
+	return *this;
+}
+
+inline bool Instrumentation::enabled()
+{
+#ifdef LINEAR_ALGEBRA_INSTRUMENT
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline const char* Instrumentation::name( const InstrumentedOperation operation )
+{
+	static const char* const names[ OP_COUNT ] =
+	{
+		"vector_arithmetic",
+		"vector_dot",
+		"vector_cross",
+		"matrix_multiply",
+		"matrix_transpose",
+		"matrix_rref",
+		"matrix_append",
+		"polynomial_multiply",
+		"polynomial_divide",
+		"polynomial_pow",
+		"polynomial_evaluate",
+		"polynomial_derivative",
+		"other"
+	};
+
+	return names[ operation ];
+}
+
+// Totals over every thread, running or exited, since the last reset().
+inline InstrumentationSnapshot Instrumentation::snapshot()
+{
+	Registry& r = registry();
+	std::lock_guard< std::mutex > lock( r.mutex );
+
+	InstrumentationSnapshot total = r.retired;
+	for( const ThreadCounters* counters : r.threads )
+		total += counters->read();
+
+	return total;
+}
+
+// The counters of each running thread that has recorded anything since it
+// started, relative to the last reset().
+inline std::vector< ThreadStatistics > Instrumentation::threads()
+{
+	Registry& r = registry();
+	std::lock_guard< std::mutex > lock( r.mutex );
+
+	std::vector< ThreadStatistics > out;
+	for( const ThreadCounters* counters : r.threads )
+		out.push_back( ThreadStatistics{ counters->thread, counters->read() } );
+
+	return out;
+}
+
+inline void Instrumentation::reset()
+{
+	Registry& r = registry();
+	std::lock_guard< std::mutex > lock( r.mutex );
+
+	r.retired = InstrumentationSnapshot();
+	for( ThreadCounters* counters : r.threads )
+		for( unsigned int op = 0; op < OP_COUNT; op++ )
+			for( unsigned int f = 0; f < FIELDS; f++ )
+				counters->baseline[ op ][f] = counters->values[ op ][f].load( std::memory_order_relaxed );
+}
+
+inline void Instrumentation::allocated( const unsigned long long bytes )
+{
+	ThreadCounters& counters = local();
+	counters.add( counters.current, ALLOCATIONS, 1 );
+	counters.add( counters.current, BYTES, bytes );
+}
+
+inline Instrumentation::Registry& Instrumentation::registry()
+{
+	static Registry r;
+
+	return r;
+}
+
+inline Instrumentation::ThreadCounters& Instrumentation::local()
+{
+	static thread_local ThreadCounters counters;
+
+	return counters;
+}
+
+inline Instrumentation::ThreadCounters::ThreadCounters() :
+	thread( std::this_thread::get_id() ),
+	current( OP_OTHER )
+{
+	for( unsigned int op = 0; op < OP_COUNT; op++ )
+		for( unsigned int f = 0; f < FIELDS; f++ )
+		{
+			values[ op ][f].store( 0, std::memory_order_relaxed );
+			baseline[ op ][f] = 0;
+		}
+
+	Registry& r = registry();
+	std::lock_guard< std::mutex > lock( r.mutex );
+	r.threads.push_back( this );
+}
+
+inline Instrumentation::ThreadCounters::~ThreadCounters()
+{
+	Registry& r = registry();
+	std::lock_guard< std::mutex > lock( r.mutex );
+
+	r.retired += read();
+	r.threads.erase( std::find( r.threads.begin(), r.threads.end(), this ) );
+}
+
+// A plain load and store rather than an atomic increment: this thread is
+// the only writer, and readers only need to see whole values.
+inline void Instrumentation::ThreadCounters::add( const InstrumentedOperation operation, const Field field, const unsigned long long amount )
+{
+	std::atomic< unsigned long long >& value = values[ operation ][ field ];
+	value.store( value.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+}
+
+inline InstrumentationSnapshot Instrumentation::ThreadCounters::read() const
+{
+	InstrumentationSnapshot out;
+
+	for( unsigned int op = 0; op < OP_COUNT; op++ )
+	{
+		unsigned long long v[ FIELDS ];
+		for( unsigned int f = 0; f < FIELDS; f++ )
+			v[f] = values[ op ][f].load( std::memory_order_relaxed ) - baseline[ op ][f];
+
+		out.operations[ op ] = OperationStatistics{ v[ CALLS ], v[ FLOPS ], v[ ALLOCATIONS ], v[ BYTES ], v[ NANOSECONDS ] };
+	}
+
+	return out;
+}
+
+inline InstrumentationScope::InstrumentationScope( const InstrumentedOperation operation, const unsigned long long flops ) :
+	_counters( Instrumentation::local() ),
+	_operation( operation ),
+	_previous( _counters.current ),
+	_start( std::chrono::steady_clock::now() )
+{
+	_counters.current = operation;
+	_counters.add( operation, Instrumentation::CALLS, 1 );
+	_counters.add( operation, Instrumentation::FLOPS, flops );
+}
+
+inline InstrumentationScope::~InstrumentationScope()
+{
+	const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - _start;
+
+	_counters.add( _operation, Instrumentation::NANOSECONDS, elapsed.count() );
+	_counters.current = _previous;
+}
+
+// One line per operation that has been called or allocated:
+//
+//   name calls flops allocations bytes seconds
+inline std::ostream& operator<< ( std::ostream& out, const InstrumentationSnapshot& snapshot )
+{
+	for( unsigned int op = 0; op < OP_COUNT; op++ )
+	{
+		const OperationStatistics& s = snapshot.operations[ op ];
+		if( !s.calls && !s.allocations )
+			continue;
+
+		out << Instrumentation::name( InstrumentedOperation( op ) ) << ' ' << s.calls << ' ' << s.flops << ' '
+			<< s.allocations << ' ' << s.bytesAllocated << ' ' << s.nanoseconds * 1e-9 << '\n';
+	}
+
+	return out;
+}
+
+// The snapshot lines of one thread, each prefixed by the thread's id.
+inline std::ostream& operator<< ( std::ostream& out, const ThreadStatistics& statistics )
+{
+	for( unsigned int op = 0; op < OP_COUNT; op++ )
+	{
+		const OperationStatistics& s = statistics.statistics.operations[ op ];
+		if( !s.calls && !s.allocations )
+			continue;
+
+		out << statistics.thread << ' ' << Instrumentation::name( InstrumentedOperation( op ) ) << ' ' << s.calls << ' ' << s.flops << ' '
+			<< s.allocations << ' ' << s.bytesAllocated << ' ' << s.nanoseconds * 1e-9 << '\n';
+	}
+
+	return out;
+}
+
+#endif
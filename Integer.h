@@ -0,0 +1,73 @@
+#ifndef __INCL_INTEGER_H__
+#define __INCL_INTEGER_H__
+
+#include <type_traits>
+
+// Integer helpers shared by the exact paths of Matrix and Polynomial.
+
+template < class T >
+constexpr T abs( const T a )
+{
+	return ( a < 0 ) ? -a : a;
+}
+
+template < class T >
+constexpr T gcd( T a, T b )
+{
+	a = abs( a );
+	b = abs( b );
+	
+	while( b != 0 )
+	{
+		const T r = a % b;
+		a = b;
+		b = r;
+	}
+	
+	return a;
+}
+
+template < typename T, typename... Ts >
+constexpr T gcd( const T a, const T b, const Ts... others )
+{
+	return gcd( gcd( a, b ), others... );
+}
+
+// WideInteger< T >::type holds the product of two T without overflow where
+// the platform has such a type. Fraction-free elimination forms its
+// cross products in it before dividing back down to T.
+template < class T, class = void >
+struct WideInteger
+{
+	typedef T type;
+};
+
+template < class T >
+struct WideInteger< T, typename std::enable_if< std::is_integral< T >::value && std::is_signed< T >::value >::type >
+{
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef typename std::conditional< ( sizeof( T ) < sizeof( long long ) ), long long, __int128 >::type type;
+#else
+	typedef long long type;
+#endif
+};
+
+// WrappingInteger< T >::type is the unsigned type that the arithmetic of an
+// integral T is promoted to. Sums and products there wrap modulo a power
+// of two instead of overflowing, and converting back keeps the low bits,
+// so a computation whose intermediate values leave the range of T still
+// gives the wrapped result of T without undefined behaviour. Other types
+// map to themselves.
+template < class T, class = void >
+struct WrappingInteger
+{
+	typedef T type;
+};
+
+template < class T >
+struct WrappingInteger< T, typename std::enable_if< std::is_integral< T >::value && !std::is_same< T, bool >::value >::type >
+{
+	typedef typename std::make_unsigned< decltype( T() + T() ) >::type type;
+};
+
+#endif
@@ -0,0 +1,701 @@
+#ifndef __INCL_ITERATIVESOLVERS_H__
+#define __INCL_ITERATIVESOLVERS_H__
+
+#include "Matrix.h"
+#include "SparseMatrix.h"
+#include "ThreadPool.h"
+#include "VectorKernels.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <exception>
+
+// Krylov solvers for A x = b: ConjugateGradient for symmetric positive
+// definite A, BiCGStab and Gmres for general A. They touch A only through
+//
+//     a.numRows(), a.numColumns()
+//     multiplyInto( a, x, y, policy )	// y = A x, reusing y
+//
+// which Matrix< T > and SparseMatrix< T > provide, so another matrix type,
+// or an operator that is never stored at all, joins them by overloading
+// multiplyInto. A preconditioner is any object with
+//
+//     void apply( const Vector< T >& r, Vector< T >& z ) const	// z = M^-1 r
+//
+// and IdentityPreconditioner, JacobiPreconditioner and ILU0Preconditioner
+// are given here. BiCGStab and Gmres precondition on the right, so that
+// every solver tests convergence on the true residual b - A x.
+//
+// A solver object owns its workspace: it is sized by the first solve and
+// reused by every later one of the same dimension, so repeated solves do
+// not allocate. x holds the starting guess on entry and the solution on
+// return.
+
+struct IterativeTolerance
+{
+	// Iteration stops once || b - A x || <= max( relative * || b ||, absolute ).
+	double relative;
+	double absolute;
+	unsigned int maxIterations;
+
+	IterativeTolerance( double relative = 1e-8, double absolute = 0.0, unsigned int maxIterations = 1000 ) :
+		relative( relative ),
+		absolute( absolute ),
+		maxIterations( maxIterations )
+		{}
+};
+
+struct IterativeResult
+{
+	unsigned int iterations;
+	double residual;
+	bool converged;
+};
+
+// Preconditioners
+
+template < class T >
+class IdentityPreconditioner
+{
+public:
+	void apply( const Vector< T >&, Vector< T >& ) const;
+};
+
+template < class T >
+void IdentityPreconditioner< T >::apply( const Vector< T >& r, Vector< T >& z ) const
+{
+	std::copy( r.data(), r.data() + r.length(), z.data() );
+}
+
+// Scales by the inverse of the diagonal; cheap, and effective when A is
+// diagonally dominant or badly scaled.
+template < class T >
+class JacobiPreconditioner
+{
+public:
+	explicit JacobiPreconditioner( const Matrix< T >& );
+	explicit JacobiPreconditioner( const SparseMatrix< T >& );
+
+	void apply( const Vector< T >&, Vector< T >& ) const;
+
+private:
+	void invert();
+
+	Vector< T > _inverse;
+};
+
+template < class T >
+JacobiPreconditioner< T >::JacobiPreconditioner( const Matrix< T >& a ) :
+	_inverse( std::min( a.numRows(), a.numColumns() ) )
+{
+	for( unsigned int i = 0; i < _inverse.length(); i++ )
+		_inverse[i] = a[i][i];
+
+	invert();
+}
+
+template < class T >
+JacobiPreconditioner< T >::JacobiPreconditioner( const SparseMatrix< T >& a ) :
+	_inverse( std::min( a.numRows(), a.numColumns() ) )
+{
+	for( unsigned int i = 0; i < _inverse.length(); i++ )
+		_inverse[i] = a( i, i );
+
+	invert();
+}
+
+template < class T >
+void JacobiPreconditioner< T >::invert()
+{
+	for( unsigned int i = 0; i < _inverse.length(); i++ )
+	{
+		if( _inverse[i] == T( 0 ) )
+		{
+			class ZeroDiagonalException
+				: public std::exception
+			{
+				virtual const char* what() const throw()
+				{
+					return "Jacobi preconditioning needs a nonzero diagonal.";
+				}
+			} ex;
+
+			throw ex;
+		}
+
+		_inverse[i] = T( 1 ) / _inverse[i];
+	}
+}
+
+template < class T >
+void JacobiPreconditioner< T >::apply( const Vector< T >& r, Vector< T >& z ) const
+{
+	std::copy( r.data(), r.data() + r.length(), z.data() );
+	VectorKernels< T >::multiply( z.data(), _inverse.data(), _inverse.length() );
+}
+
+// Incomplete LU factorization with no fill-in: L and U are computed as by
+// Gaussian elimination, but only at the positions where A itself has an
+// entry, and are kept in A's CSR pattern with L's unit diagonal implied.
+// Applying it is one forward and one backward sparse triangular solve.
+template < class T >
+class ILU0Preconditioner
+{
+public:
+	explicit ILU0Preconditioner( const SparseMatrix< T >& );
+	explicit ILU0Preconditioner( const Matrix< T >& );
+
+	void apply( const Vector< T >&, Vector< T >& ) const;
+
+private:
+	void factorize();
+
+	SparseMatrix< T > _pattern;
+	std::vector< T > _lu;
+	std::vector< std::size_t > _diagonal;
+};
+
+template < class T >
+ILU0Preconditioner< T >::ILU0Preconditioner( const SparseMatrix< T >& a ) :
+	_pattern( a.toLayout( SPARSE_CSR ) )
+{
+	factorize();
+}
+
+template < class T >
+ILU0Preconditioner< T >::ILU0Preconditioner( const Matrix< T >& a ) :
+	_pattern( a )
+{
+	factorize();
+}
+
+template < class T >
+void ILU0Preconditioner< T >::factorize()
+{
+	class ILU0Exception
+		: public std::exception
+	{
+		virtual const char* what() const throw()
+		{
+			return "ILU(0) needs a square matrix with a nonzero diagonal, and met a zero pivot.";
+		}
+	} ex;
+
+	if( _pattern.numRows() != _pattern.numColumns() )
+		throw ex;
+
+	const unsigned int n = _pattern.numRows();
+	const std::size_t* offsets = _pattern.offsets().data();
+	const unsigned int* indices = _pattern.indices().data();
+
+	_lu = _pattern.values();
+	_diagonal.resize( n );
+
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		const unsigned int* first = indices + offsets[i];
+		const unsigned int* last = indices + offsets[ i + 1 ];
+		const unsigned int* it = std::lower_bound( first, last, i );
+
+		if( it == last || *it != i )
+			throw ex;
+
+		_diagonal[i] = it - indices;
+	}
+
+	// Row by row (the IKJ form): each L( i, k ) left of the diagonal is
+	// divided by U( k, k ), then row k of U is subtracted from row i at the
+	// columns the two rows share. position maps the columns of row i to
+	// their slots, or to npos outside the pattern.
+	const std::size_t npos = std::numeric_limits< std::size_t >::max();
+	std::vector< std::size_t > position( n, npos );
+
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		for( std::size_t p = offsets[i]; p < offsets[ i + 1 ]; p++ )
+			position[ indices[p] ] = p;
+
+		for( std::size_t p = offsets[i]; p < _diagonal[i]; p++ )
+		{
+			const unsigned int k = indices[p];
+
+			if( _lu[ _diagonal[k] ] == T( 0 ) )
+				throw ex;
+
+			const T multiplier = _lu[p] /= _lu[ _diagonal[k] ];
+
+			for( std::size_t q = _diagonal[k] + 1; q < offsets[ k + 1 ]; q++ )
+				if( position[ indices[q] ] != npos )
+					_lu[ position[ indices[q] ] ] -= multiplier * _lu[q];
+		}
+
+		if( _lu[ _diagonal[i] ] == T( 0 ) )
+			throw ex;
+
+		for( std::size_t p = offsets[i]; p < offsets[ i + 1 ]; p++ )
+			position[ indices[p] ] = npos;
+	}
+}
+
+template < class T >
+void ILU0Preconditioner< T >::apply( const Vector< T >& r, Vector< T >& z ) const
+{
+	const unsigned int n = _pattern.numRows();
+	const std::size_t* offsets = _pattern.offsets().data();
+	const unsigned int* indices = _pattern.indices().data();
+
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		T sum = r[i];
+
+		for( std::size_t p = offsets[i]; p < _diagonal[i]; p++ )
+			sum -= _lu[p] * z[ indices[p] ];
+
+		z[i] = sum;
+	}
+
+	for( unsigned int i = n; i-- > 0; )
+	{
+		T sum = z[i];
+
+		for( std::size_t p = _diagonal[i] + 1; p < offsets[ i + 1 ]; p++ )
+			sum -= _lu[p] * z[ indices[p] ];
+
+		z[i] = sum / _lu[ _diagonal[i] ];
+	}
+}
+
+// Solvers
+
+// Helpers shared by the solvers, kept out of the global namespace.
+template < class T >
+class IterativeSolver
+{
+protected:
+	template < class Operator >
+		static void checkSystem( const Operator&, const Vector< T >&, Vector< T >& );
+	static double norm( const Vector< T >& );
+};
+
+// Checks that a is square and matches b, and gives x the right length,
+// starting from zero when it had another.
+template < class T >
+template < class Operator >
+void IterativeSolver< T >::checkSystem( const Operator& a, const Vector< T >& b, Vector< T >& x )
+{
+	if( a.numRows() != a.numColumns() || a.numRows() != b.length() )
+	{
+		class IterativeSystemException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Iterative solvers need a square matrix and a right-hand side of matching length.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	if( x.length() != b.length() )
+		x = Vector< T >( b.length() );
+}
+
+template < class T >
+double IterativeSolver< T >::norm( const Vector< T >& v )
+{
+	return std::sqrt( (double)VectorKernels< T >::dot( v.data(), v.data(), v.length() ) );
+}
+
+// Preconditioned conjugate gradients. Needs A, and the preconditioner, to be
+// symmetric positive definite; a direction of nonpositive curvature shows
+// that A is not, and ends the solve unconverged.
+template < class T >
+class ConjugateGradient
+	: IterativeSolver< T >
+{
+	static_assert( !std::numeric_limits< T >::is_integer, "Iterative solvers need a floating point type" );
+
+public:
+	explicit ConjugateGradient( const IterativeTolerance& tolerance = IterativeTolerance(), const ExecutionPolicy& policy = ExecutionPolicy() ) :
+		_tolerance( tolerance ),
+		_policy( policy )
+		{}
+
+	template < class Operator >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >& );
+	template < class Operator, class Preconditioner >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >&, const Preconditioner& );
+
+private:
+	using IterativeSolver< T >::checkSystem;
+	using IterativeSolver< T >::norm;
+
+	IterativeTolerance _tolerance;
+	ExecutionPolicy _policy;
+
+	Vector< T > _r, _z, _p, _q;
+};
+
+template < class T >
+template < class Operator >
+IterativeResult ConjugateGradient< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x )
+{
+	return solve( a, b, x, IdentityPreconditioner< T >() );
+}
+
+template < class T >
+template < class Operator, class Preconditioner >
+IterativeResult ConjugateGradient< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x, const Preconditioner& preconditioner )
+{
+	checkSystem( a, b, x );
+
+	const unsigned int n = b.length();
+	const double target = std::max( _tolerance.relative * norm( b ), _tolerance.absolute );
+
+	if( _r.length() != n )
+	{
+		_r = Vector< T >( n );
+		_z = Vector< T >( n );
+		_p = Vector< T >( n );
+		_q = Vector< T >( n );
+	}
+
+	multiplyInto( a, x, _q, _policy );
+	std::copy( b.data(), b.data() + n, _r.data() );
+	VectorKernels< T >::subtract( _r.data(), _q.data(), n );
+
+	IterativeResult result = { 0, norm( _r ), false };
+
+	preconditioner.apply( _r, _z );
+	std::copy( _z.data(), _z.data() + n, _p.data() );
+	T rz = VectorKernels< T >::dot( _r.data(), _z.data(), n );
+
+	while( result.residual > target && result.iterations < _tolerance.maxIterations )
+	{
+		multiplyInto( a, _p, _q, _policy );
+		const T curvature = VectorKernels< T >::dot( _p.data(), _q.data(), n );
+
+		if( !( curvature > T( 0 ) ) )
+			return result;
+
+		const T alpha = rz / curvature;
+		VectorKernels< T >::axpy( x.data(), alpha, _p.data(), n );
+		VectorKernels< T >::axpy( _r.data(), -alpha, _q.data(), n );
+
+		result.iterations++;
+		result.residual = norm( _r );
+
+		if( result.residual <= target )
+			break;
+
+		preconditioner.apply( _r, _z );
+		const T next = VectorKernels< T >::dot( _r.data(), _z.data(), n );
+
+		// p = z + ( next / rz ) p
+		VectorKernels< T >::scale( _p.data(), next / rz, n );
+		VectorKernels< T >::add( _p.data(), _z.data(), n );
+		rz = next;
+	}
+
+	result.converged = result.residual <= target;
+
+	return result;
+}
+
+// Right-preconditioned BiCGSTAB. A breakdown (a vanishing inner product)
+// ends the solve unconverged; restarting from the returned x often
+// recovers.
+template < class T >
+class BiCGStab
+	: IterativeSolver< T >
+{
+	static_assert( !std::numeric_limits< T >::is_integer, "Iterative solvers need a floating point type" );
+
+public:
+	explicit BiCGStab( const IterativeTolerance& tolerance = IterativeTolerance(), const ExecutionPolicy& policy = ExecutionPolicy() ) :
+		_tolerance( tolerance ),
+		_policy( policy )
+		{}
+
+	template < class Operator >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >& );
+	template < class Operator, class Preconditioner >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >&, const Preconditioner& );
+
+private:
+	using IterativeSolver< T >::checkSystem;
+	using IterativeSolver< T >::norm;
+
+	IterativeTolerance _tolerance;
+	ExecutionPolicy _policy;
+
+	Vector< T > _r, _shadow, _p, _v, _pHat, _sHat, _t;
+};
+
+template < class T >
+template < class Operator >
+IterativeResult BiCGStab< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x )
+{
+	return solve( a, b, x, IdentityPreconditioner< T >() );
+}
+
+template < class T >
+template < class Operator, class Preconditioner >
+IterativeResult BiCGStab< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x, const Preconditioner& preconditioner )
+{
+	checkSystem( a, b, x );
+
+	const unsigned int n = b.length();
+	const double target = std::max( _tolerance.relative * norm( b ), _tolerance.absolute );
+
+	if( _r.length() != n )
+	{
+		_r = Vector< T >( n );
+		_shadow = Vector< T >( n );
+		_p = Vector< T >( n );
+		_v = Vector< T >( n );
+		_pHat = Vector< T >( n );
+		_sHat = Vector< T >( n );
+		_t = Vector< T >( n );
+	}
+
+	multiplyInto( a, x, _t, _policy );
+	std::copy( b.data(), b.data() + n, _r.data() );
+	VectorKernels< T >::subtract( _r.data(), _t.data(), n );
+	std::copy( _r.data(), _r.data() + n, _shadow.data() );
+	std::fill( _p.data(), _p.data() + n, T( 0 ) );
+	std::fill( _v.data(), _v.data() + n, T( 0 ) );
+
+	IterativeResult result = { 0, norm( _r ), false };
+	T rho( 1 ), alpha( 1 ), omega( 1 );
+
+	while( result.residual > target && result.iterations < _tolerance.maxIterations )
+	{
+		const T next = VectorKernels< T >::dot( _shadow.data(), _r.data(), n );
+
+		if( next == T( 0 ) || omega == T( 0 ) )
+			return result;
+
+		// p = r + beta ( p - omega v )
+		const T beta = ( next / rho ) * ( alpha / omega );
+		VectorKernels< T >::axpy( _p.data(), -omega, _v.data(), n );
+		VectorKernels< T >::scale( _p.data(), beta, n );
+		VectorKernels< T >::add( _p.data(), _r.data(), n );
+		rho = next;
+
+		preconditioner.apply( _p, _pHat );
+		multiplyInto( a, _pHat, _v, _policy );
+
+		const T shadowV = VectorKernels< T >::dot( _shadow.data(), _v.data(), n );
+
+		if( shadowV == T( 0 ) )
+			return result;
+
+		alpha = rho / shadowV;
+
+		// s = r - alpha v, kept in r
+		VectorKernels< T >::axpy( _r.data(), -alpha, _v.data(), n );
+		VectorKernels< T >::axpy( x.data(), alpha, _pHat.data(), n );
+
+		result.iterations++;
+		result.residual = norm( _r );
+
+		if( result.residual <= target )
+			break;
+
+		preconditioner.apply( _r, _sHat );
+		multiplyInto( a, _sHat, _t, _policy );
+
+		const T tt = VectorKernels< T >::dot( _t.data(), _t.data(), n );
+		omega = ( tt == T( 0 ) ) ? T( 0 ) : VectorKernels< T >::dot( _t.data(), _r.data(), n ) / tt;
+
+		VectorKernels< T >::axpy( x.data(), omega, _sHat.data(), n );
+		VectorKernels< T >::axpy( _r.data(), -omega, _t.data(), n );
+
+		result.residual = norm( _r );
+	}
+
+	result.converged = result.residual <= target;
+
+	return result;
+}
+
+// Right-preconditioned GMRES, restarted every restart() iterations. The
+// Arnoldi basis is orthogonalized by modified Gram-Schmidt and the small
+// least-squares problem is kept triangular by Givens rotations, whose last
+// component gives the residual norm without forming it. Each restart
+// recomputes the true residual. Memory grows with the restart length, as
+// ( restart + 1 ) vectors of length n.
+template < class T >
+class Gmres
+	: IterativeSolver< T >
+{
+	static_assert( !std::numeric_limits< T >::is_integer, "Iterative solvers need a floating point type" );
+
+public:
+	explicit Gmres( const unsigned int restart = 30, const IterativeTolerance& tolerance = IterativeTolerance(), const ExecutionPolicy& policy = ExecutionPolicy() ) :
+		_restart( std::max( restart, 1u ) ),
+		_tolerance( tolerance ),
+		_policy( policy )
+		{}
+
+	unsigned int restart() const;
+
+	template < class Operator >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >& );
+	template < class Operator, class Preconditioner >
+		IterativeResult solve( const Operator&, const Vector< T >&, Vector< T >&, const Preconditioner& );
+
+private:
+	using IterativeSolver< T >::checkSystem;
+	using IterativeSolver< T >::norm;
+
+	unsigned int _restart;
+	IterativeTolerance _tolerance;
+	ExecutionPolicy _policy;
+
+	Matrix< T > _basis;
+	Matrix< T > _hessenberg;
+	std::vector< T > _cosines, _sines, _rhs;
+	Vector< T > _w, _z;
+};
+
+template < class T >
+unsigned int Gmres< T >::restart() const
+{
+	return _restart;
+}
+
+template < class T >
+template < class Operator >
+IterativeResult Gmres< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x )
+{
+	return solve( a, b, x, IdentityPreconditioner< T >() );
+}
+
+template < class T >
+template < class Operator, class Preconditioner >
+IterativeResult Gmres< T >::solve( const Operator& a, const Vector< T >& b, Vector< T >& x, const Preconditioner& preconditioner )
+{
+	checkSystem( a, b, x );
+
+	const unsigned int n = b.length();
+	const unsigned int m = _restart;
+	const double target = std::max( _tolerance.relative * norm( b ), _tolerance.absolute );
+
+	if( _w.length() != n )
+	{
+		_basis = Matrix< T >( m + 1, n );
+		_hessenberg = Matrix< T >( m + 1, m );
+		_cosines.resize( m );
+		_sines.resize( m );
+		_rhs.resize( m + 1 );
+		_w = Vector< T >( n );
+		_z = Vector< T >( n );
+	}
+
+	IterativeResult result = { 0, 0.0, false };
+
+	for( ;; )
+	{
+		// w = b - A x
+		multiplyInto( a, x, _z, _policy );
+		std::copy( b.data(), b.data() + n, _w.data() );
+		VectorKernels< T >::subtract( _w.data(), _z.data(), n );
+
+		const double beta = norm( _w );
+		result.residual = beta;
+
+		if( beta <= target || result.iterations >= _tolerance.maxIterations )
+			break;
+
+		std::copy( _w.data(), _w.data() + n, _basis[0] );
+		VectorKernels< T >::scale( _basis[0], T( 1 / beta ), n );
+		std::fill( _rhs.begin(), _rhs.end(), T( 0 ) );
+		_rhs[0] = T( beta );
+
+		unsigned int j = 0;
+
+		while( j < m && result.iterations < _tolerance.maxIterations )
+		{
+			// w = A M^-1 v_j, orthogonalized against v_0 .. v_j
+			std::copy( _basis[j], _basis[j] + n, _w.data() );
+			preconditioner.apply( _w, _z );
+			multiplyInto( a, _z, _w, _policy );
+
+			for( unsigned int i = 0; i <= j; i++ )
+			{
+				const T h = VectorKernels< T >::dot( _w.data(), _basis[i], n );
+				_hessenberg[i][j] = h;
+				VectorKernels< T >::axpy( _w.data(), -h, _basis[i], n );
+			}
+
+			const T subdiagonal = T( norm( _w ) );
+			_hessenberg[ j + 1 ][j] = subdiagonal;
+
+			if( subdiagonal != T( 0 ) )
+			{
+				std::copy( _w.data(), _w.data() + n, _basis[ j + 1 ] );
+				VectorKernels< T >::scale( _basis[ j + 1 ], T( 1 ) / subdiagonal, n );
+			}
+
+			for( unsigned int i = 0; i < j; i++ )
+			{
+				const T upper = _hessenberg[i][j], lower = _hessenberg[ i + 1 ][j];
+				_hessenberg[i][j] = _cosines[i] * upper + _sines[i] * lower;
+				_hessenberg[ i + 1 ][j] = -_sines[i] * upper + _cosines[i] * lower;
+			}
+
+			const T diagonal = _hessenberg[j][j];
+			const T radius = std::sqrt( diagonal * diagonal + subdiagonal * subdiagonal );
+
+			if( radius == T( 0 ) )
+				break;
+
+			_cosines[j] = diagonal / radius;
+			_sines[j] = subdiagonal / radius;
+			_hessenberg[j][j] = radius;
+			_hessenberg[ j + 1 ][j] = T( 0 );
+			_rhs[ j + 1 ] = -_sines[j] * _rhs[j];
+			_rhs[j] = _cosines[j] * _rhs[j];
+
+			j++;
+			result.iterations++;
+			result.residual = std::fabs( (double)_rhs[j] );
+
+			if( result.residual <= target || subdiagonal == T( 0 ) )
+				break;
+		}
+
+		if( j == 0 )
+			break;
+
+		// Back substitution for y in H y = g, left in _rhs, then
+		// x += M^-1 ( V y ).
+		for( unsigned int i = j; i-- > 0; )
+		{
+			T sum = _rhs[i];
+
+			for( unsigned int l = i + 1; l < j; l++ )
+				sum -= _hessenberg[i][l] * _rhs[l];
+
+			_rhs[i] = sum / _hessenberg[i][i];
+		}
+
+		std::fill( _w.data(), _w.data() + n, T( 0 ) );
+		for( unsigned int i = 0; i < j; i++ )
+			VectorKernels< T >::axpy( _w.data(), _rhs[i], _basis[i], n );
+
+		preconditioner.apply( _w, _z );
+		VectorKernels< T >::add( x.data(), _z.data(), n );
+	}
+
+	result.converged = result.residual <= target;
+
+	return result;
+}
+
+#endif
@@ -0,0 +1,382 @@
+#ifndef __INCL_LUDECOMPOSITION_H__
+#define __INCL_LUDECOMPOSITION_H__
+
+#include "Matrix.h"
+#include "Gemm.h"
+#include "VectorKernels.h"
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <type_traits>
+#include <limits>
+#include <exception>
+
+// LUDecomposition< T > factors a square matrix once as P * A = L * U, with L
+// unit lower triangular and U upper triangular, both kept packed in a single
+// matrix. Every later solve costs O( n^2 ) per right-hand side, and the
+// determinant and inverse are derived from the same factors.
+//
+// The factorization is blocked: each panel of blockSize columns is reduced
+// with partial pivoting, then the trailing submatrix is updated through
+// Gemm, where nearly all of the O( n^3 ) work takes place.
+
+template < class T >
+class LUDecomposition
+{
+	static_assert( !std::numeric_limits< T >::is_integer, "LUDecomposition divides by pivots; use rref or determinant for exact types" );
+
+public:
+	explicit LUDecomposition( const Matrix< T >&, const unsigned int blockSize = 64 );
+	explicit LUDecomposition( Matrix< T >&&, const unsigned int blockSize = 64 );
+
+	unsigned int size() const;
+	bool isSingular() const;
+
+	const Matrix< T >& packed() const;
+	const std::vector< unsigned int >& permutation() const;
+	Matrix< T > lower() const;
+	Matrix< T > upper() const;
+
+	Vector< T > solve( const Vector< T >& ) const;
+	Matrix< T > solve( const Matrix< T >& ) const;
+
+	T determinant() const;
+	Matrix< T > inverse() const;
+
+private:
+	void factorize( const unsigned int );
+	void factorizePanel( const unsigned int, const unsigned int );
+	void checkSolvable( const unsigned int ) const;
+
+	Matrix< T > _lu;
+	std::vector< unsigned int > _permutation;
+	bool _oddPermutation;
+	bool _singular;
+};
+
+template < class T >
+LUDecomposition< T >::LUDecomposition( const Matrix< T >& cMatrix, const unsigned int blockSize ) :
+	_lu( cMatrix ),
+	_oddPermutation( false ),
+	_singular( false )
+{
+	factorize( blockSize );
+}
+
+template < class T >
+LUDecomposition< T >::LUDecomposition( Matrix< T >&& cMatrix, const unsigned int blockSize ) :
+	_lu( std::move( cMatrix ) ),
+	_oddPermutation( false ),
+	_singular( false )
+{
+	factorize( blockSize );
+}
+
+template < class T >
+unsigned int LUDecomposition< T >::size() const
+{
+	return _lu.numRows();
+}
+
+template < class T >
+bool LUDecomposition< T >::isSingular() const
+{
+	return _singular;
+}
+
+// L below the diagonal ( its unit diagonal is implied ) and U on and above.
+template < class T >
+const Matrix< T >& LUDecomposition< T >::packed() const
+{
+	return _lu;
+}
+
+// Row i of P * A is row permutation()[i] of A.
+template < class T >
+const std::vector< unsigned int >& LUDecomposition< T >::permutation() const
+{
+	return _permutation;
+}
+
+template < class T >
+Matrix< T > LUDecomposition< T >::lower() const
+{
+	const unsigned int n = size();
+	Matrix< T > out( n, n );
+
+	for( unsigned int r = 0; r < n; r++ )
+	{
+		std::copy( _lu[r], _lu[r] + r, out[r] );
+		out[r][r] = T( 1 );
+	}
+
+	return out;
+}
+
+template < class T >
+Matrix< T > LUDecomposition< T >::upper() const
+{
+	const unsigned int n = size();
+	Matrix< T > out( n, n );
+
+	for( unsigned int r = 0; r < n; r++ )
+		std::copy( _lu[r] + r, _lu[r] + n, out[r] + r );
+
+	return out;
+}
+
+template < class T >
+Vector< T > LUDecomposition< T >::solve( const Vector< T >& rhs ) const
+{
+	const unsigned int n = size();
+	checkSolvable( rhs.length() );
+
+	Vector< T > x( n );
+
+	for( unsigned int r = 0; r < n; r++ )
+		x[r] = rhs[ _permutation[r] ];
+
+	for( unsigned int r = 1; r < n; r++ )
+		x[r] -= VectorKernels< T >::dot( _lu[r], x.data(), r );
+
+	for( unsigned int r = n; r-- > 0; )
+		x[r] = ( x[r] - VectorKernels< T >::dot( _lu[r] + r + 1, x.data() + r + 1, n - r - 1 ) ) / _lu[r][r];
+
+	return x;
+}
+
+// Solves for every column of rhs at once. Substitution proceeds a whole row
+// of the right-hand side at a time, so the inner loops stay contiguous.
+template < class T >
+Matrix< T > LUDecomposition< T >::solve( const Matrix< T >& rhs ) const
+{
+	const unsigned int n = size();
+	const unsigned int m = rhs.numColumns();
+	checkSolvable( rhs.numRows() );
+
+	Matrix< T > x( n, m );
+
+	for( unsigned int r = 0; r < n; r++ )
+		std::copy( rhs[ _permutation[r] ], rhs[ _permutation[r] ] + m, x[r] );
+
+	for( unsigned int r = 1; r < n; r++ )
+		for( unsigned int k = 0; k < r; k++ )
+			if( _lu[r][k] != T( 0 ) )
+				VectorKernels< T >::axpy( x[r], -_lu[r][k], x[k], m );
+
+	for( unsigned int r = n; r-- > 0; )
+	{
+		for( unsigned int k = r + 1; k < n; k++ )
+			if( _lu[r][k] != T( 0 ) )
+				VectorKernels< T >::axpy( x[r], -_lu[r][k], x[k], m );
+
+		VectorKernels< T >::scale( x[r], T( 1 ) / _lu[r][r], m );
+	}
+
+	return x;
+}
+
+template < class T >
+T LUDecomposition< T >::determinant() const
+{
+	T out( _oddPermutation ? -1 : 1 );
+
+	for( unsigned int r = 0; r < size(); r++ )
+		out *= _lu[r][r];
+
+	return out;
+}
+
+template < class T >
+Matrix< T > LUDecomposition< T >::inverse() const
+{
+	const unsigned int n = size();
+	Matrix< T > identity( n, n );
+
+	for( unsigned int r = 0; r < n; r++ )
+		identity[r][r] = T( 1 );
+
+	return solve( identity );
+}
+
+template < class T >
+void LUDecomposition< T >::factorize( const unsigned int blockSize )
+{
+	if( _lu.numRows() != _lu.numColumns() )
+	{
+		class NonSquareMatrixException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot factor a non-square matrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const unsigned int n = size();
+	const unsigned int nb = std::max( blockSize, 1u );
+
+	_permutation.resize( n );
+	for( unsigned int r = 0; r < n; r++ )
+		_permutation[r] = r;
+
+	std::vector< T > panel;
+
+	for( unsigned int k = 0; k < n; k += nb )
+	{
+		const unsigned int kb = std::min( nb, n - k );
+		const unsigned int rest = n - k - kb;
+
+		factorizePanel( k, kb );
+
+		if( rest == 0 )
+			break;
+
+		// U12 = L11^-1 * A12
+		for( unsigned int j = k; j < k + kb; j++ )
+			for( unsigned int r = j + 1; r < k + kb; r++ )
+				if( _lu[r][j] != T( 0 ) )
+					VectorKernels< T >::axpy( _lu[r] + k + kb, -_lu[r][j], _lu[j] + k + kb, rest );
+
+		// A22 -= L21 * U12, with L21 negated into a contiguous panel so that
+		// Gemm's C += A * B applies.
+		panel.resize( std::size_t( rest ) * kb );
+		for( unsigned int r = 0; r < rest; r++ )
+			for( unsigned int j = 0; j < kb; j++ )
+				panel[ std::size_t( r ) * kb + j ] = -_lu[ k + kb + r ][ k + j ];
+
+		Gemm< T >::multiply( rest, rest, kb, panel.data(), kb, _lu[k] + k + kb, n, _lu[ k + kb ] + k + kb, n );
+	}
+}
+
+// Unblocked right-looking elimination of columns [ k, k + kb ) over rows
+// k and below. Row swaps are applied across the full width of the matrix.
+template < class T >
+void LUDecomposition< T >::factorizePanel( const unsigned int k, const unsigned int kb )
+{
+	using std::abs;
+
+	const unsigned int n = size();
+
+	for( unsigned int j = k; j < k + kb; j++ )
+	{
+		unsigned int p = j;
+		for( unsigned int r = j + 1; r < n; r++ )
+			if( abs( _lu[r][j] ) > abs( _lu[p][j] ) )
+				p = r;
+
+		if( _lu[p][j] == T( 0 ) )
+		{
+			_singular = true;
+			continue;
+		}
+
+		if( p != j )
+		{
+			std::swap_ranges( _lu[p], _lu[p] + n, _lu[j] );
+			std::swap( _permutation[p], _permutation[j] );
+			_oddPermutation = !_oddPermutation;
+		}
+
+		const T pivot = _lu[j][j];
+
+		for( unsigned int r = j + 1; r < n; r++ )
+		{
+			if( _lu[r][j] == T( 0 ) )
+				continue;
+
+			_lu[r][j] /= pivot;
+			VectorKernels< T >::axpy( _lu[r] + j + 1, -_lu[r][j], _lu[j] + j + 1, k + kb - j - 1 );
+		}
+	}
+}
+
+template < class T >
+void LUDecomposition< T >::checkSolvable( const unsigned int rhsRows ) const
+{
+	if( rhsRows != size() )
+	{
+		class SolveDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Right-hand side does not match the dimensions of the factored matrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	if( _singular )
+	{
+		class SingularMatrixException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot solve against a singular matrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+// Matrix functions
+
+template < class T >
+LUDecomposition< T > lu( const Matrix< T >& cMatrix )
+{
+	return LUDecomposition< T >( cMatrix );
+}
+
+template < class T >
+typename std::enable_if< !std::numeric_limits< T >::is_integer, T >::type determinant( const Matrix< T >& cMatrix )
+{
+	return LUDecomposition< T >( cMatrix ).determinant();
+}
+
+// Exact types are eliminated fraction-free, so the determinant is exact
+// whenever it fits in T.
+template < class T >
+typename std::enable_if< std::numeric_limits< T >::is_integer, T >::type determinant( const Matrix< T >& cMatrix )
+{
+	if( cMatrix.numRows() != cMatrix.numColumns() )
+	{
+		class NonSquareMatrixException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot take the determinant of a non-square matrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const unsigned int n = cMatrix.numRows();
+	Matrix< T > echelon = cMatrix;
+	bool oddPermutation;
+
+	if( echelon.fractionFreeEliminate( false, oddPermutation ) < n )
+		return T( 0 );
+
+	if( n == 0 )
+		return T( 1 );
+
+	return oddPermutation ? -echelon[ n - 1 ][ n - 1 ] : echelon[ n - 1 ][ n - 1 ];
+}
+
+template < class T >
+Matrix< T > inverse( const Matrix< T >& cMatrix )
+{
+	return LUDecomposition< T >( cMatrix ).inverse();
+}
+
+#endif
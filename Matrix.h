@@ -2,23 +2,44 @@
 #define __INCL_MATRIX_H__
 
 #include "Vector.h"
+#include "Gemm.h"
+#include "Strassen.h"
+#include "Transpose.h"
+#include "ThreadPool.h"
+#include "Integer.h"
+#include "Instrumentation.h"
 #include <iterator>
 #include <algorithm>
 #include <utility>
 #include <initializer_list>
 #include <type_traits>
 #include <iomanip>
-#include <sstream>
 #include <exception>
+#include <limits>
+#include <cmath>
+
+// Matrix< T > is the dynamically sized matrix defined here. Matrix< T, R, C >
+// with R, C > 0 is a fixed-size matrix; see FixedMatrix.h.
+template < class T, unsigned int R = 0, unsigned int C = R >
+class Matrix;
+
+template < class T >
+class VectorView;
+
+template < class T >
+class MatrixView;
 
 template < class T >
-class Matrix
+class Matrix< T, 0, 0 >
 	: Vector< T >
 {
 public:
+	typedef T value_type;
+	
 	using Vector< T >::length;
 	using Vector< T >::resize;
 	using Vector< T >::operator bool;
+	using Vector< T >::data;
 	
 	Matrix() :
 		Vector< T >::Vector()
@@ -28,6 +49,14 @@ public:
 		_numRows( cMatrix._numRows ),
 		_numColumns( cMatrix._numColumns )
 		{}
+	Matrix( Matrix< T >&& cMatrix ) noexcept :
+		Vector< T >::Vector( std::move( cMatrix ) ),
+		_numRows( cMatrix._numRows ),
+		_numColumns( cMatrix._numColumns )
+		{
+			cMatrix._numRows = 0;
+			cMatrix._numColumns = 0;
+		}
 	Matrix( const unsigned int r, const unsigned int c ) :
 		Vector< T >::Vector( r * c ),
 		_numRows( r ),
@@ -38,15 +67,30 @@ public:
 		_numRows( iList.size() ),
 		_numColumns( iList.begin()->size() )
 		{
-			std::vector< T > values;
+			_values.reserve( _numRows * _numColumns );
 			for( auto list : iList )
 				for( auto val : list )
-					values.push_back( val );
-			
-			_values = values;
+					_values.push_back( val );
 		}
+	template < class E >
+		Matrix( const VectorExpression< E >& expression ) :
+			Vector< T >::Vector( expression ),
+			_numRows( expression.self().shape().numRows() ),
+			_numColumns( expression.self().shape().numColumns() )
+			{}
+	template < class U >
+		explicit Matrix( const MatrixView< U >& );
 
 	Matrix< T >& operator= ( const Matrix< T >& );
+	Matrix< T >& operator= ( Matrix< T >&& ) noexcept;
+	template < class E > Matrix< T >& operator= ( const VectorExpression< E >& );
+	
+	Matrix< T >& operator+= ( const Matrix< T >& );
+	Matrix< T >& operator-= ( const Matrix< T >& );
+	template < class E > Matrix< T >& operator+= ( const VectorExpression< E >& );
+	template < class E > Matrix< T >& operator-= ( const VectorExpression< E >& );
+	template < class V > Matrix< T >& operator*= ( const V& );
+	template < class V > Matrix< T >& operator/= ( const V& );
 	
 	template < class InputIterator >
 		typename std::enable_if< std::is_same< T, typename std::iterator_traits< InputIterator >::value_type >::value, void >::type
@@ -60,17 +104,41 @@ public:
 	Vector< T > getRow( const unsigned int ) const;
 	Vector< T > getColumn( const unsigned int ) const;
 	
+	VectorView< T > row( const unsigned int );
+	VectorView< const T > row( const unsigned int ) const;
+	VectorView< T > column( const unsigned int );
+	VectorView< const T > column( const unsigned int ) const;
+	VectorView< T > diagonal();
+	VectorView< const T > diagonal() const;
+	MatrixView< T > block( const unsigned int, const unsigned int, const unsigned int, const unsigned int );
+	MatrixView< const T > block( const unsigned int, const unsigned int, const unsigned int, const unsigned int ) const;
+	
 	unsigned int numRows() const;
 	unsigned int numColumns() const;
 	
 	Matrix< T > transpose() const;
+	Matrix< T >& transposeInPlace();
 	
-	Matrix< T > rref() const;
+	Matrix< T > rref( const ExecutionPolicy& = ExecutionPolicy() ) const;
+	Matrix< T >& rrefInPlace( const ExecutionPolicy& = ExecutionPolicy() );
+	unsigned int rank() const;
+	
+	template < class U > friend void checkExpressionShapes( const Matrix< U >&, const Matrix< U >& );
+	template < class U > friend typename std::enable_if< std::numeric_limits< U >::is_integer, U >::type determinant( const Matrix< U >& );
 	
 protected:
+	void checkSameDimensions( const Matrix< T >& ) const;
 	void swapRows( const unsigned int, const unsigned int );
+	void eliminateRow( const unsigned int, const unsigned int, const unsigned int );
+	void normalizeRow( const unsigned int );
+	unsigned int fractionFreeEliminate( const bool, bool&, const ExecutionPolicy& = ExecutionPolicy() );
+	unsigned int rank( std::true_type ) const;
+	unsigned int rank( std::false_type ) const;
 
 private:
+	static T rowDivisor( const T*, const unsigned int, std::true_type );
+	static T rowDivisor( const T*, const unsigned int, std::false_type );
+	
 	using Vector< T >::_values;
 	
 	unsigned int _numRows;
@@ -87,6 +155,118 @@ Matrix< T >& Matrix< T >::operator= ( const Matrix< T >& cMatrix )
 	return *this;
 }
 
+template < class T >
+Matrix< T >& Matrix< T >::operator= ( Matrix< T >&& cMatrix ) noexcept
+{
+	_numRows = cMatrix._numRows;
+	_numColumns = cMatrix._numColumns;
+	_values = std::move( cMatrix._values );
+	
+	cMatrix._numRows = 0;
+	cMatrix._numColumns = 0;
+	
+	return *this;
+}
+
+template < class T >
+template < class E >
+Matrix< T >& Matrix< T >::operator= ( const VectorExpression< E >& expression )
+{
+	const unsigned int r = expression.self().shape().numRows();
+	const unsigned int c = expression.self().shape().numColumns();
+	
+	Vector< T >::operator=( expression );
+	_numRows = r;
+	_numColumns = c;
+	
+	return *this;
+}
+
+template < class T >
+Matrix< T >& Matrix< T >::operator+= ( const Matrix< T >& cMatrix )
+{
+	checkSameDimensions( cMatrix );
+	Vector< T >::operator+=( cMatrix );
+	
+	return *this;
+}
+
+template < class T >
+Matrix< T >& Matrix< T >::operator-= ( const Matrix< T >& cMatrix )
+{
+	checkSameDimensions( cMatrix );
+	Vector< T >::operator-=( cMatrix );
+	
+	return *this;
+}
+
+// The operands of the expression were checked against one another when it
+// was built (see checkExpressionShapes), so comparing its shape with this
+// matrix covers every leaf.
+template < class T >
+template < class E >
+Matrix< T >& Matrix< T >::operator+= ( const VectorExpression< E >& expression )
+{
+	checkSameDimensions( expression.self().shape() );
+	Vector< T >::operator+=( expression );
+	
+	return *this;
+}
+
+template < class T >
+template < class E >
+Matrix< T >& Matrix< T >::operator-= ( const VectorExpression< E >& expression )
+{
+	checkSameDimensions( expression.self().shape() );
+	Vector< T >::operator-=( expression );
+	
+	return *this;
+}
+
+template < class T >
+template < class V >
+Matrix< T >& Matrix< T >::operator*= ( const V& scalar )
+{
+	Vector< T >::operator*=( scalar );
+	
+	return *this;
+}
+
+template < class T >
+template < class V >
+Matrix< T >& Matrix< T >::operator/= ( const V& scalar )
+{
+	Vector< T >::operator/=( scalar );
+	
+	return *this;
+}
+
+template < class T >
+void Matrix< T >::checkSameDimensions( const Matrix< T >& cMatrix ) const
+{
+	if( _numRows != cMatrix._numRows || _numColumns != cMatrix._numColumns )
+	{
+		class MatrixDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot combine matrices of different dimensions.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+}
+
+// Element-wise expressions over matrices need every operand to have the
+// same dimensions; see VectorExpression.h.
+template < class T >
+void checkExpressionShapes( const Matrix< T >& lhs, const Matrix< T >& rhs )
+{
+	lhs.checkSameDimensions( rhs );
+}
+
 template < class T >
 template < class InputIterator >
 typename std::enable_if< std::is_same< T, typename std::iterator_traits< InputIterator >::value_type >::value, void >::type Matrix< T >::setValues( InputIterator begin, InputIterator end )
@@ -118,25 +298,13 @@ const T* Matrix< T >::operator[] ( const unsigned int r ) const
 template < class T >
 Vector< T > Matrix< T >::getRow( const unsigned int r ) const
 {
-	Vector< T > rowVector;
-	rowVector.resize( _numColumns );
-	
-	for( unsigned int c = 0; c < _numColumns; c++ )
-		rowVector[c] = (*this)[r][c];
-	
-	return rowVector;
+	return Vector< T >( (*this)[r], (*this)[r] + _numColumns );
 }
 
 template < class T >
 Vector< T > Matrix< T >::getColumn( const unsigned int c ) const
 {
-	Vector< T > columnVector;
-	columnVector.resize( _numRows );
-	
-	for( unsigned int r = 0; r < _numRows; r++ )
-		columnVector[r] = (*this)[r][c];
-	
-	return columnVector;
+	return Vector< T >( column( c ) );
 }
 
 template < class T >
@@ -154,18 +322,44 @@ unsigned int Matrix< T >::numColumns() const
 template < class T >
 Matrix< T > Matrix< T >::transpose() const
 {
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_TRANSPOSE, 0 );
+	
 	Matrix< T > transposeMatrix( _numColumns, _numRows );
 	
-	for( unsigned int c = 0; c < _numColumns; c++ )
-		for( unsigned int r = 0; r < _numRows; r++ )
-			transposeMatrix[c][r] = (*this)[r][c];
+	TransposeKernels< T >::transpose( _numRows, _numColumns, data(), _numColumns, transposeMatrix.data(), _numRows );
 	
 	return transposeMatrix;
 }
 
 template < class T >
-Matrix< T > operator* ( const Matrix< T >& lhs, const Matrix< T >& rhs )
+Matrix< T >& Matrix< T >::transposeInPlace()
 {
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_TRANSPOSE, 0 );
+	
+	if( _numRows != _numColumns )
+	{
+		class MatrixTransposeException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Only square matrices can be transposed in place.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+	
+	TransposeKernels< T >::transposeInPlace( _numRows, data(), _numColumns );
+	
+	return *this;
+}
+
+template < class T >
+Matrix< T > multiply( const Matrix< T >& lhs, const Matrix< T >& rhs, const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_MULTIPLY, 2ull * lhs.numRows() * rhs.numColumns() * lhs.numColumns() );
+	
 	if( lhs.numColumns() != rhs.numRows() )
 	{
 		class MatrixMultiplicationException
@@ -180,154 +374,375 @@ Matrix< T > operator* ( const Matrix< T >& lhs, const Matrix< T >& rhs )
 		throw ex;
 	}
 	
-	Matrix< T > productMatrix( lhs.numRows(), rhs.numColumns() );
+	const unsigned int m = lhs.numRows(), n = rhs.numColumns(), k = lhs.numColumns();
+	Matrix< T > productMatrix( m, n );
 	
-	for( unsigned int r = 0; r < lhs.numRows(); r++ )
-		for( unsigned int c = 0; c < rhs.numColumns(); c++ )
-			productMatrix[r][c] = dot( lhs.getRow( r ), rhs.getColumn( c ) );
+	if( Strassen< T >::preferred( m, n, k ) )
+		Strassen< T >::multiply( m, n, k, lhs.data(), k, rhs.data(), n, productMatrix.data(), n, policy );
+	else
+		gemm( m, n, k, lhs.data(), k, rhs.data(), n, productMatrix.data(), n, policy );
 	
 	return productMatrix;
 }
 
 template < class T >
-constexpr T abs( const T a )
+Matrix< T > operator* ( const Matrix< T >& lhs, const Matrix< T >& rhs )
 {
-	return ( a < 0 ) ? -a : a;
+	return multiply( lhs, rhs );
 }
 
+// product = lhs * rhs into a vector of the right length, which is reused
+// rather than reallocated; the form iterative solvers call on every step.
 template < class T >
-constexpr T gcd( const T a, const T b )
+void multiplyInto( const Matrix< T >& lhs, const Vector< T >& rhs, Vector< T >& product, const ExecutionPolicy& policy = ExecutionPolicy() )
 {
-	return ( a == b || b == 0 ) ? a : ( ( a < b ) ? gcd( abs( b ), abs( a ) ) : gcd( abs( a ) - abs( b ), abs( b ) ) );
+	if( lhs.numColumns() != rhs.length() )
+	{
+		class MatrixMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply matrices of incompatible dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	if( product.length() != lhs.numRows() )
+		product = Vector< T >( lhs.numRows() );
+
+	auto rows = [&]( std::size_t first, std::size_t last )
+	{
+		for( std::size_t r = first; r < last; r++ )
+			product[r] = VectorKernels< T >::dot( lhs[r], rhs.data(), lhs.numColumns() );
+	};
+
+	if( policy.parallel( (unsigned long)lhs.numRows() * lhs.numColumns() ) )
+		policy.pool().parallelFor( 0, lhs.numRows(), rows );
+	else
+		rows( 0, lhs.numRows() );
 }
 
-template < typename T, typename... Ts >
-constexpr T gcd( const T a, const T b, const Ts... others )
+// The product by Strassen-Winograd whatever the element type, for floating
+// point callers that can accept its weaker error bound in exchange for
+// fewer multiplications; see Strassen.h.
+template < class T >
+Matrix< T > strassenMultiply( const Matrix< T >& lhs, const Matrix< T >& rhs, const ExecutionPolicy& policy = ExecutionPolicy() )
 {
-	return gcd( gcd( a, b ), others... );
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_MULTIPLY, 2ull * lhs.numRows() * rhs.numColumns() * lhs.numColumns() );
+
+	if( lhs.numColumns() != rhs.numRows() )
+	{
+		class MatrixMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply matrices of incompatible dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const unsigned int m = lhs.numRows(), n = rhs.numColumns(), k = lhs.numColumns();
+	Matrix< T > productMatrix( m, n );
+
+	Strassen< T >::multiply( m, n, k, lhs.data(), k, rhs.data(), n, productMatrix.data(), n, policy );
+
+	return productMatrix;
 }
 
 template < class T >
-Matrix< T > Matrix< T >::rref() const
+Matrix< T > Matrix< T >::rref( const ExecutionPolicy& policy ) const
 {
 	Matrix< T > rrefMatrix = (*this);
-	unsigned int p = rrefMatrix._numColumns;
-	T mult = 0, mult1 = 0, mult2 = 0;
 	
-	for( unsigned int r1 = 0; r1 < rrefMatrix._numRows; r1++ )
+	rrefMatrix.rrefInPlace( policy );
+	
+	return rrefMatrix;
+}
+
+// Exact types ( those with std::numeric_limits< T >::is_integer ) are
+// reduced fraction-free, leaving each row in lowest terms; see
+// fractionFreeEliminate. Other types use Gauss-Jordan elimination.
+template < class T >
+Matrix< T >& Matrix< T >::rrefInPlace( const ExecutionPolicy& policy )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_RREF, 2ull * _numRows * _numColumns * std::min( _numRows, _numColumns ) );
+	
+	if( std::numeric_limits< T >::is_integer )
 	{
-		p = rrefMatrix._numColumns;
-		for( unsigned int r2 = r1; r2 < rrefMatrix._numRows; r2++ )
+		bool oddPermutation;
+		fractionFreeEliminate( true, oddPermutation, policy );
+		
+		for( unsigned int r = 0; r < _numRows; r++ )
+			normalizeRow( r );
+		
+		return *this;
+	}
+	
+	unsigned int p = 0;
+	const bool parallel = policy.parallel( (unsigned long)_numRows * _numColumns );
+	
+	for( unsigned int r1 = 0; r1 < _numRows; r1++, p++ )
+	{
+		// The pivot is the leftmost column with a non-zero entry in row r1
+		// or below.
+		unsigned int r2 = _numRows;
+		for( ; p < _numColumns; p++ )
 		{
-			for( unsigned int c = 0; c < rrefMatrix._numColumns; c++ )
-			{
-				if( rrefMatrix[r2][c] != T( 0 ) )
-				{
-					p = c;
+			for( r2 = r1; r2 < _numRows; r2++ )
+				if( (*this)[r2][p] != T( 0 ) )
 					break;
-				}
-			}
-			if( p != rrefMatrix._numColumns )
-			{
-				if( r2 > r1 )
-				{
-					rrefMatrix.swapRows( r1, r2 );
-				}
+			
+			if( r2 != _numRows )
 				break;
-			}
 		}
-		if( p == rrefMatrix._numColumns )
+		if( p == _numColumns )
 			break;
 		
-		for( unsigned int r2 = 0; r2 < rrefMatrix._numRows; r2++ )
-		{
-			if( r1 == r2 ) continue;
-			
-			if( std::is_integral< T >::value )
-				mult = gcd( rrefMatrix[r1][p], rrefMatrix[r2][p] );
-			else
-				mult = 1;
-			
-			mult1 = mult * rrefMatrix[r2][p];
-			mult2 = mult * rrefMatrix[r1][p];
-			
-			for( unsigned int c = 0; c < rrefMatrix._numColumns; c++ )
-			{
-				rrefMatrix[r1][c] *= mult1;
-				rrefMatrix[r2][c] *= mult2;
-			}
-			
-			for( unsigned int c = 0; c < rrefMatrix._numColumns; c++ )
+		if( r2 > r1 )
+			swapRows( r1, r2 );
+		
+		if( parallel )
+			policy.pool().parallelFor( 0, _numRows, [&]( std::size_t first, std::size_t last )
 			{
-				rrefMatrix[r2][c] -= rrefMatrix[r1][c];
-				rrefMatrix[r1][c] /= mult1;
-			}
-		}
+				for( std::size_t r2 = first; r2 < last; r2++ )
+					if( r2 != r1 )
+						eliminateRow( r1, r2, p );
+			} );
+		else
+			for( unsigned int r2 = 0; r2 < _numRows; r2++ )
+				if( r2 != r1 )
+					eliminateRow( r1, r2, p );
 	}
 	
-	for( unsigned int r = 0; r < rrefMatrix._numRows; r++ )
-	{
-		p = _numColumns;
-		for( unsigned int c = 0; c < rrefMatrix._numColumns; c++ )
+	if( parallel )
+		policy.pool().parallelFor( 0, _numRows, [&]( std::size_t first, std::size_t last )
 		{
-			if( rrefMatrix[r][c] != 0 )
-			{
-				p = c;
-				break;
-			}
-		}
+			for( std::size_t r = first; r < last; r++ )
+				normalizeRow( r );
+		} );
+	else
+		for( unsigned int r = 0; r < _numRows; r++ )
+			normalizeRow( r );
+	
+	return *this;
+}
+
+// Exact types are counted by fractionFreeEliminate. The choice is made at
+// compile time, since the inexact path needs abs and epsilon, which not
+// every exact type has.
+template < class T >
+unsigned int Matrix< T >::rank() const
+{
+	return rank( std::integral_constant< bool, std::numeric_limits< T >::is_integer >() );
+}
+
+template < class T >
+unsigned int Matrix< T >::rank( std::true_type ) const
+{
+	Matrix< T > echelon = (*this);
+	bool oddPermutation;
+	
+	return echelon.fractionFreeEliminate( false, oddPermutation );
+}
+
+// Inexact types: row echelon form with partial pivoting, where a pivot
+// within rounding error of zero, eps * max |a_ij| * max( rows, columns ),
+// counts as zero, so that nearly singular matrices are not reported to
+// have full rank.
+template < class T >
+unsigned int Matrix< T >::rank( std::false_type ) const
+{
+	using std::abs;
+	
+	Matrix< T > echelon = (*this);
+	
+	T scale( 0 );
+	for( unsigned int i = 0; i < length(); i++ )
+		scale = std::max( scale, T( abs( data()[i] ) ) );
+	
+	const T tolerance = std::numeric_limits< T >::epsilon() * scale * T( std::max( _numRows, _numColumns ) );
+	
+	unsigned int out = 0;
+	for( unsigned int c = 0; c < _numColumns && out < _numRows; c++ )
+	{
+		unsigned int best = out;
+		for( unsigned int r = out + 1; r < _numRows; r++ )
+			if( abs( echelon[r][c] ) > abs( echelon[ best ][c] ) )
+				best = r;
 		
-		if( p == rrefMatrix._numColumns ) continue;
+		if( !( abs( echelon[ best ][c] ) > tolerance ) )
+			continue;
 		
-		mult = rrefMatrix[r][p];
+		if( best != out )
+			echelon.swapRows( out, best );
 		
-		for( unsigned int c = 0; c < rrefMatrix._numColumns; c++ )
-		{
-			rrefMatrix[r][c] /= mult;
-			if( rrefMatrix[r][c] == -0 )
-				rrefMatrix[r][c] = 0;
-		}
+		for( unsigned int r = out + 1; r < _numRows; r++ )
+			echelon.eliminateRow( out, r, c );
+		
+		out++;
 	}
 	
-	return rrefMatrix;
+	return out;
 }
 
 template < class T >
 void Matrix< T >::swapRows( const unsigned int r1, const unsigned int r2 )
 {
+	swap( row( r1 ), row( r2 ) );
+}
+
+// Clears column p of row r2 using pivot row r1. Only row r2 is written, so
+// distinct rows may be eliminated concurrently.
+template < class T >
+void Matrix< T >::eliminateRow( const unsigned int r1, const unsigned int r2, const unsigned int p )
+{
+	if( (*this)[r2][p] == T( 0 ) )
+		return;
+	
+	const T mult = (*this)[r2][p] / (*this)[r1][p];
+	
+	VectorKernels< T >::axpy( (*this)[r2] + p, -mult, (*this)[r1] + p, _numColumns - p );
+	(*this)[r2][p] = T( 0 );
+}
+
+template < class T >
+void Matrix< T >::normalizeRow( const unsigned int r )
+{
+	unsigned int p = _numColumns;
+	for( unsigned int c = 0; c < _numColumns; c++ )
+	{
+		if( (*this)[r][c] != 0 )
+		{
+			p = c;
+			break;
+		}
+	}
+	
+	if( p == _numColumns ) return;
+	
+	const T mult = rowDivisor( (*this)[r] + p, _numColumns - p, std::integral_constant< bool, std::numeric_limits< T >::is_integer >() );
+	
 	for( unsigned int c = 0; c < _numColumns; c++ )
-		std::swap( (*this)[r1][c], (*this)[r2][c] );
+	{
+		(*this)[r][c] /= mult;
+		if( (*this)[r][c] == -0 )
+			(*this)[r][c] = 0;
+	}
 }
 
+// The value a row is divided by when normalized, given the row from its
+// leading non-zero entry on. Exact rows are divided by their content, with
+// the sign of the leading entry, so that nothing is truncated; the leading
+// entry still becomes 1 whenever the true rref is integral.
 template < class T >
-size_t strLength( const T& item )
+T Matrix< T >::rowDivisor( const T* row, const unsigned int n, std::true_type )
 {
-	std::stringstream ss;
-	ss << item;
-	std::string s = ss.str();
-	std::cout << s << ' ' << s.length() << std::endl;
-	return s.length();
+	T content = T( 0 );
+	for( unsigned int c = 0; c < n && content != T( 1 ); c++ )
+		content = gcd( content, row[c] );
+	
+	return ( row[0] < T( 0 ) ) ? -content : content;
 }
 
 template < class T >
-std::ostream& operator<< ( std::ostream& out, const Matrix< T >& cMatrix )
+T Matrix< T >::rowDivisor( const T* row, const unsigned int, std::false_type )
+{
+	return row[0];
+}
+
+// Fraction-free ( Bareiss ) elimination. Each step replaces every other row
+// i by ( p * a[i][j] - a[i][c] * a[r][j] ) / q, where p = a[r][c] is the new
+// pivot and q the previous one; the division is exact, and every entry stays
+// a minor of the input, so growth is bounded by the determinant rather than
+// compounding. With reduce set, rows above the pivot are cleared as well,
+// giving a reduced echelon form scaled by the last pivot; otherwise only
+// rows below are, and for a square matrix of full rank the last pivot is
+// the determinant up to the sign left in oddPermutation. Returns the rank.
+// Pivots are compared with zero exactly, so this is for exact types only.
+template < class T >
+unsigned int Matrix< T >::fractionFreeEliminate( const bool reduce, bool& oddPermutation, const ExecutionPolicy& policy )
 {
-	unsigned int maxLength = 0, currLength = 0;
+	typedef typename WideInteger< T >::type Wide;
 	
-	for( unsigned int r = 0; r < cMatrix.numRows(); r++ )
-		for( unsigned int c = 0; c < cMatrix.numColumns(); c++ )
+	const unsigned int rows = _numRows, columns = _numColumns;
+	const bool parallel = policy.parallel( (unsigned long)rows * columns );
+	
+	T previous = T( 1 );
+	unsigned int r = 0;
+	oddPermutation = false;
+	
+	for( unsigned int c = 0; c < columns && r < rows; c++ )
+	{
+		unsigned int p = r;
+		while( p < rows && (*this)[p][c] == T( 0 ) )
+			p++;
+		
+		if( p == rows )
+			continue;
+		
+		if( p != r )
 		{
-			//currLength = strLength( cMatrix[r][c] );
-			currLength = 10;
-			if( currLength > maxLength )
-				maxLength = currLength;
+			std::swap_ranges( (*this)[p], (*this)[p] + columns, (*this)[r] );
+			oddPermutation = !oddPermutation;
 		}
+		
+		const Wide pivot = Wide( (*this)[r][c] );
+		const Wide divisor = Wide( previous );
+		
+		auto update = [&]( std::size_t first, std::size_t last )
+		{
+			for( std::size_t i = first; i < last; i++ )
+			{
+				if( i == r )
+					continue;
+				
+				T* row = (*this)[i];
+				const Wide factor = Wide( row[c] );
+				
+				// Columns before c are zero in the pivot row, so only scale.
+				for( unsigned int j = 0; j < c; j++ )
+					if( row[j] != T( 0 ) )
+						row[j] = T( pivot * Wide( row[j] ) / divisor );
+				
+				for( unsigned int j = c + 1; j < columns; j++ )
+					row[j] = T( ( pivot * Wide( row[j] ) - factor * Wide( (*this)[r][j] ) ) / divisor );
+				
+				row[c] = T( 0 );
+			}
+		};
+		
+		const unsigned int first = reduce ? 0 : r + 1;
+		
+		if( parallel )
+			policy.pool().parallelFor( first, rows, update );
+		else
+			update( first, rows );
+		
+		previous = (*this)[r][c];
+		r++;
+	}
+	
+	return r;
+}
+
+// Every element is printed in a field of FIELD_WIDTH characters, so that
+// columns line up for the usual magnitudes.
+template < class T >
+std::ostream& operator<< ( std::ostream& out, const Matrix< T >& cMatrix )
+{
+	const int FIELD_WIDTH = 10;
 	
 	for( unsigned int r = 0; r < cMatrix.numRows(); r++ )
 	{
 		for( unsigned int c = 0; c < cMatrix.numColumns(); c++ )
-			out << std::setw( maxLength ) << cMatrix[r][c] << ' ';
-		out << std::endl;
+			out << std::setw( FIELD_WIDTH ) << cMatrix[r][c] << ' ';
+		out << '\n';
 	}
 	
 	return out;
@@ -336,20 +751,12 @@ std::ostream& operator<< ( std::ostream& out, const Matrix< T >& cMatrix )
 template < class T >
 Matrix< T > append( const Matrix< T >& lhs, const Matrix< T >& rhs )
 {
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_APPEND, 0 );
+	
 	Matrix< T > appendMatrix( lhs.numRows(), lhs.numColumns() + rhs.numColumns() );
 	
-	for( unsigned int r = 0; r < appendMatrix.numRows(); r++ )
-	{
-		for( unsigned int c = 0; c < lhs.numColumns(); c++ )
-		{
-			appendMatrix[r][c] = lhs[r][c];
-		}
-		
-		for( unsigned int c = 0; c < rhs.numColumns(); c++ )
-		{
-			appendMatrix[r][ c + lhs.numColumns() ] = rhs[r][c];
-		}
-	}
+	appendMatrix.block( 0, 0, lhs.numRows(), lhs.numColumns() ) = lhs;
+	appendMatrix.block( 0, lhs.numColumns(), rhs.numRows(), rhs.numColumns() ) = rhs;
 	
 	return appendMatrix;
 }
@@ -357,7 +764,10 @@ Matrix< T > append( const Matrix< T >& lhs, const Matrix< T >& rhs )
 template < class T >
 void rref( Matrix< T >& mat )
 {
-	mat = mat.rref();
+	mat.rrefInPlace();
 }
 
+#include "MatrixView.h"
+#include "FixedMatrix.h"
+
 #endif
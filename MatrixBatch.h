@@ -0,0 +1,406 @@
+#ifndef __INCL_MATRIXBATCH_H__
+#define __INCL_MATRIXBATCH_H__
+
+#include "Matrix.h"
+#include "VectorKernels.h"
+#include "ThreadPool.h"
+#include "AlignedAllocator.h"
+#include "Instrumentation.h"
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+
+// MatrixBatch< T > holds count() matrices of the same shape, stored
+// interleaved: element ( r, c ) of every matrix is contiguous, matrix b at
+// offset b, so element( r, c ) is a run of count() values. The runs start
+// stride() elements apart, on cache line boundaries, and never a multiple
+// of 4 KB apart, so that walking down a column of runs does not keep
+// evicting the same cache sets. An operation on
+// the batch applies the same step to element ( r, c ) of all the matrices
+// at once, through the element-wise kernels of VectorKernels.h, and so
+// fills whole SIMD registers with distinct matrices however small each one
+// is: multiplying two batches of 4 x 4 matrices is 16 runs of
+// multiplyAccumulate over the batch, one per element of the product.
+//
+// The operations walk the batch in blocks of matrices sized to keep a
+// block's operands in cache, and spread the blocks over an
+// ExecutionPolicy's pool. Moving single matrices in and out with
+// setMatrix() and matrix() costs a strided copy; code that produces many
+// small matrices is better off writing element( r, c ) directly.
+
+template < class T >
+class MatrixBatch;
+
+template < class T >
+MatrixBatch< T > multiply( const MatrixBatch< T >&, const MatrixBatch< T >&, const ExecutionPolicy& = ExecutionPolicy() );
+template < class T >
+unsigned int solve( const MatrixBatch< T >&, const MatrixBatch< T >&, MatrixBatch< T >&, const ExecutionPolicy& = ExecutionPolicy() );
+
+template < class T >
+class MatrixBatch
+{
+public:
+	typedef T value_type;
+	typedef std::vector< T, AlignedAllocator< T > > container_type;
+
+	MatrixBatch() :
+		_count( 0 ),
+		_numRows( 0 ),
+		_numColumns( 0 ),
+		_stride( 0 )
+		{}
+	MatrixBatch( const unsigned int count, const unsigned int rows, const unsigned int columns ) :
+		_count( count ),
+		_numRows( rows ),
+		_numColumns( columns ),
+		_stride( runStride( count ) ),
+		_values( _stride * rows * columns, T( 0 ) )
+		{}
+
+	T& operator() ( const unsigned int, const unsigned int, const unsigned int );
+	const T& operator() ( const unsigned int, const unsigned int, const unsigned int ) const;
+
+	T* element( const unsigned int, const unsigned int );
+	const T* element( const unsigned int, const unsigned int ) const;
+
+	void setMatrix( const unsigned int, const Matrix< T >& );
+	Matrix< T > matrix( const unsigned int ) const;
+
+	unsigned int count() const;
+	unsigned int numRows() const;
+	unsigned int numColumns() const;
+	std::size_t stride() const;
+
+	static unsigned int blockSize( const std::size_t );
+
+	template < class U >
+		friend MatrixBatch< U > multiply( const MatrixBatch< U >&, const MatrixBatch< U >&, const ExecutionPolicy& );
+	template < class U >
+		friend unsigned int solve( const MatrixBatch< U >&, const MatrixBatch< U >&, MatrixBatch< U >&, const ExecutionPolicy& );
+
+private:
+	static const std::size_t BLOCK_ELEMENTS = 1 << 15;
+	static const unsigned int MIN_BLOCK = 16;
+	static const unsigned int MAX_BLOCK = 256;
+	static const std::size_t LINE = ( 64 / sizeof( T ) ) ? 64 / sizeof( T ) : 1;
+	static const std::size_t PAGE = ( 4096 / sizeof( T ) ) ? 4096 / sizeof( T ) : 1;
+
+	static std::size_t runStride( const unsigned int );
+
+	template < class Function >
+		static void forEachBlock( const unsigned int, const unsigned int, const unsigned long long, const ExecutionPolicy&, Function );
+
+	unsigned int _count;
+	unsigned int _numRows;
+	unsigned int _numColumns;
+	std::size_t _stride;
+	container_type _values;
+};
+
+template < class T >
+T& MatrixBatch< T >::operator() ( const unsigned int b, const unsigned int r, const unsigned int c )
+{
+	return element( r, c )[b];
+}
+
+template < class T >
+const T& MatrixBatch< T >::operator() ( const unsigned int b, const unsigned int r, const unsigned int c ) const
+{
+	return element( r, c )[b];
+}
+
+// Element ( r, c ) of every matrix, count() of them in a row.
+template < class T >
+T* MatrixBatch< T >::element( const unsigned int r, const unsigned int c )
+{
+	return _values.data() + ( std::size_t( r ) * _numColumns + c ) * _stride;
+}
+
+template < class T >
+const T* MatrixBatch< T >::element( const unsigned int r, const unsigned int c ) const
+{
+	return _values.data() + ( std::size_t( r ) * _numColumns + c ) * _stride;
+}
+
+template < class T >
+void MatrixBatch< T >::setMatrix( const unsigned int b, const Matrix< T >& cMatrix )
+{
+	if( cMatrix.numRows() != _numRows || cMatrix.numColumns() != _numColumns )
+	{
+		class MatrixDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Matrix does not have the shape of the batch.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	for( unsigned int r = 0; r < _numRows; r++ )
+		for( unsigned int c = 0; c < _numColumns; c++ )
+			element( r, c )[b] = cMatrix[r][c];
+}
+
+template < class T >
+Matrix< T > MatrixBatch< T >::matrix( const unsigned int b ) const
+{
+	Matrix< T > out( _numRows, _numColumns );
+
+	for( unsigned int r = 0; r < _numRows; r++ )
+		for( unsigned int c = 0; c < _numColumns; c++ )
+			out[r][c] = element( r, c )[b];
+
+	return out;
+}
+
+template < class T >
+unsigned int MatrixBatch< T >::count() const
+{
+	return _count;
+}
+
+template < class T >
+unsigned int MatrixBatch< T >::numRows() const
+{
+	return _numRows;
+}
+
+template < class T >
+unsigned int MatrixBatch< T >::numColumns() const
+{
+	return _numColumns;
+}
+
+template < class T >
+std::size_t MatrixBatch< T >::stride() const
+{
+	return _stride;
+}
+
+// The number of matrices to process together when an operation touches
+// the given number of elements of each: enough that the runs amortize the
+// kernel dispatch, few enough that the block stays in cache.
+template < class T >
+unsigned int MatrixBatch< T >::blockSize( const std::size_t elementsPerMatrix )
+{
+	const std::size_t block = BLOCK_ELEMENTS / std::max< std::size_t >( elementsPerMatrix, 1 ) / MIN_BLOCK * MIN_BLOCK;
+
+	return std::min( std::max( block, std::size_t( MIN_BLOCK ) ), std::size_t( MAX_BLOCK ) );
+}
+
+template < class T >
+std::size_t MatrixBatch< T >::runStride( const unsigned int count )
+{
+	const std::size_t stride = ( count + LINE - 1 ) / LINE * LINE;
+
+	return ( stride % PAGE == 0 && stride ) ? stride + LINE : stride;
+}
+
+// Calls work( first, last ) over blocks of matrices covering [0, count ),
+// on the pool when the total work, in multiply-adds, is large enough.
+template < class T >
+template < class Function >
+void MatrixBatch< T >::forEachBlock( const unsigned int count, const unsigned int block, const unsigned long long cost,
+									 const ExecutionPolicy& policy, Function work )
+{
+	const unsigned int blocks = ( count + block - 1 ) / block;
+
+	auto run = [&]( std::size_t first, std::size_t last )
+	{
+		for( std::size_t i = first; i < last; i++ )
+			work( i * block, std::min< std::size_t >( count, ( i + 1 ) * block ) );
+	};
+
+	if( policy.parallel( cost ) && blocks > 1 )
+		policy.pool().parallelFor( 0, blocks, run );
+	else
+		run( 0, blocks );
+}
+
+template < class T >
+MatrixBatch< T > multiply( const MatrixBatch< T >& lhs, const MatrixBatch< T >& rhs, const ExecutionPolicy& policy )
+{
+	const unsigned int m = lhs.numRows(), n = rhs.numColumns(), k = lhs.numColumns();
+
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_MULTIPLY, 2ull * lhs.count() * m * n * k );
+
+	if( lhs.numColumns() != rhs.numRows() || lhs.count() != rhs.count() )
+	{
+		class MatrixMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply batches of different sizes or incompatible dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	MatrixBatch< T > product( lhs.count(), m, n );
+	const unsigned int block = MatrixBatch< T >::blockSize( m * k + k * n + m * n );
+
+	MatrixBatch< T >::forEachBlock( lhs.count(), block, (unsigned long long)lhs.count() * m * n * k, policy, [&]( std::size_t first, std::size_t last )
+	{
+		for( unsigned int r = 0; r < m; r++ )
+			for( unsigned int c = 0; c < n; c++ )
+				VectorKernels< T >::multiplyAccumulate( product.element( r, c ) + first, lhs.element( r, 0 ) + first, lhs.stride(),
+														rhs.element( 0, c ) + first, n * rhs.stride(), k, last - first );
+	} );
+
+	return product;
+}
+
+template < class T >
+MatrixBatch< T > operator* ( const MatrixBatch< T >& lhs, const MatrixBatch< T >& rhs )
+{
+	return multiply( lhs, rhs );
+}
+
+// Transposing the batch only moves whole runs: element ( r, c ) of the
+// input becomes element ( c, r ) of the output.
+template < class T >
+MatrixBatch< T > transpose( const MatrixBatch< T >& batch )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_TRANSPOSE, 0 );
+
+	MatrixBatch< T > out( batch.count(), batch.numColumns(), batch.numRows() );
+
+	for( unsigned int r = 0; r < batch.numRows(); r++ )
+		for( unsigned int c = 0; c < batch.numColumns(); c++ )
+			std::copy( batch.element( r, c ), batch.element( r, c ) + batch.count(), out.element( c, r ) );
+
+	return out;
+}
+
+// Solves a[b] x[b] = rhs[b] for every b by Gauss-Jordan elimination with
+// partial pivoting, which reduces each [ a[b] | rhs[b] ] to its rref. Each
+// matrix picks its own pivot rows; the elimination itself runs on whole
+// runs. The solutions of singular systems are left NaN, and their number
+// is returned.
+template < class T >
+unsigned int solve( const MatrixBatch< T >& a, const MatrixBatch< T >& rhs, MatrixBatch< T >& x, const ExecutionPolicy& policy )
+{
+	static_assert( !std::numeric_limits< T >::is_integer, "Batched solves need a floating point type" );
+
+	const unsigned int n = a.numRows(), m = rhs.numColumns();
+
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_RREF, 2ull * a.count() * n * n * ( n + m ) );
+
+	if( a.numColumns() != n || rhs.numRows() != n || rhs.count() != a.count() )
+	{
+		class SolveDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Batched solves need square matrices and right-hand sides of matching size and count.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	x = rhs;
+
+	const unsigned int block = MatrixBatch< T >::blockSize( n * n + n * m );
+	std::vector< unsigned int > singularCounts( ( a.count() + block - 1 ) / block, 0 );
+
+	MatrixBatch< T >::forEachBlock( a.count(), block, (unsigned long long)a.count() * n * n * ( n + m ), policy, [&]( std::size_t first, std::size_t last )
+	{
+		const std::size_t lanes = last - first;
+
+		// The block's matrices, copied so that a stays untouched.
+		std::vector< T, AlignedAllocator< T > > work( std::size_t( n ) * n * lanes ), factor( lanes );
+		std::vector< unsigned int > pivot( lanes );
+		std::vector< bool > singular( lanes, false );
+
+		auto w = [&]( unsigned int r, unsigned int c ) { return work.data() + ( std::size_t( r ) * n + c ) * lanes; };
+		auto y = [&]( unsigned int r, unsigned int c ) { return x.element( r, c ) + first; };
+
+		for( unsigned int r = 0; r < n; r++ )
+			for( unsigned int c = 0; c < n; c++ )
+				std::copy( a.element( r, c ) + first, a.element( r, c ) + last, w( r, c ) );
+
+		for( unsigned int p = 0; p < n; p++ )
+		{
+			for( std::size_t l = 0; l < lanes; l++ )
+			{
+				pivot[l] = p;
+				factor[l] = std::abs( w( p, p )[l] );
+			}
+			for( unsigned int r = p + 1; r < n; r++ )
+				for( std::size_t l = 0; l < lanes; l++ )
+					if( std::abs( w( r, p )[l] ) > factor[l] )
+					{
+						pivot[l] = r;
+						factor[l] = std::abs( w( r, p )[l] );
+					}
+
+			for( std::size_t l = 0; l < lanes; l++ )
+			{
+				if( pivot[l] != p )
+				{
+					for( unsigned int c = p; c < n; c++ )
+						std::swap( w( p, c )[l], w( pivot[l], c )[l] );
+					for( unsigned int c = 0; c < m; c++ )
+						std::swap( y( p, c )[l], y( pivot[l], c )[l] );
+				}
+
+				// A zero pivot column makes the system singular; a unit pivot
+				// keeps its arithmetic finite until the lane is cleared.
+				if( w( p, p )[l] == T( 0 ) )
+				{
+					singular[l] = true;
+					w( p, p )[l] = T( 1 );
+				}
+				factor[l] = T( 1 ) / w( p, p )[l];
+			}
+
+			for( unsigned int c = p + 1; c < n; c++ )
+				VectorKernels< T >::multiply( w( p, c ), factor.data(), lanes );
+			for( unsigned int c = 0; c < m; c++ )
+				VectorKernels< T >::multiply( y( p, c ), factor.data(), lanes );
+
+			for( unsigned int r = 0; r < n; r++ )
+			{
+				if( r == p )
+					continue;
+
+				std::copy( w( r, p ), w( r, p ) + lanes, factor.data() );
+				for( unsigned int c = p + 1; c < n; c++ )
+					VectorKernels< T >::multiplySubtract( w( r, c ), factor.data(), w( p, c ), lanes );
+				for( unsigned int c = 0; c < m; c++ )
+					VectorKernels< T >::multiplySubtract( y( r, c ), factor.data(), y( p, c ), lanes );
+			}
+		}
+
+		unsigned int singularCount = 0;
+		for( std::size_t l = 0; l < lanes; l++ )
+			if( singular[l] )
+			{
+				singularCount++;
+				for( unsigned int r = 0; r < n; r++ )
+					for( unsigned int c = 0; c < m; c++ )
+						y( r, c )[l] = std::numeric_limits< T >::quiet_NaN();
+			}
+
+		singularCounts[ first / block ] = singularCount;
+	} );
+
+	unsigned int out = 0;
+	for( const unsigned int s : singularCounts )
+		out += s;
+
+	return out;
+}
+
+#endif
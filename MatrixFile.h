@@ -0,0 +1,570 @@
+#ifndef __INCL_MATRIXFILE_H__
+#define __INCL_MATRIXFILE_H__
+
+#include "Matrix.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <fstream>
+#include <utility>
+#include <exception>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// A binary file format for dense matrices, meant to be mapped rather than
+// parsed. A file is a 64 byte MatrixFileHeader followed, at dataOffset, by
+// the rows * columns elements in the byte order of the machine that wrote
+// them, row after row or column after column as the header's layout says.
+// dataOffset is a multiple of the header's alignment, so a mapped file
+// hands out elements as aligned as a Vector's own.
+//
+//   - MappedMatrix< T > maps a file read-only and views it in place as a
+//     MatrixView< const T >: opening costs a few system calls whatever the
+//     size, and pages are read on first touch. A column-major file views as
+//     the transpose of the matrix it stores.
+//   - MatrixFileWriter< T > streams a file out in pieces, so a matrix need
+//     never be whole in memory to be written.
+//   - writeMatrix and readMatrix save and load a whole Matrix< T >; reading
+//     copies straight into the matrix's storage.
+//
+// The element type must match T exactly: nothing is converted. Files are
+// refused when their version, byte order, element type or layout is not
+// understood, or when they are shorter than the header says. Mapping uses
+// POSIX mmap.
+//
+// A FILE_TILED file stores square tiles of tileSize x tileSize elements one
+// after the other, in row-major order of tiles and each row-major inside,
+// with the tiles along the bottom and right edges padded with zeros. Those
+// are the backing files of TiledMatrix; see TiledMatrix.h.
+
+enum MatrixFileLayout
+{
+	FILE_ROW_MAJOR,
+	FILE_COLUMN_MAJOR,
+	FILE_TILED
+};
+
+// The element type is coded as a kind, 1 for signed integers, 2 for
+// unsigned integers and 3 for floating point, times 256 plus the size in
+// bytes: 0x308 is double.
+template < class T >
+std::uint32_t matrixFileElementType()
+{
+	static_assert( std::is_arithmetic< T >::value && !std::is_same< T, bool >::value,
+				   "Only integer and floating point matrices can be stored" );
+
+	const std::uint32_t kind = std::is_floating_point< T >::value ? 3 : std::is_signed< T >::value ? 1 : 2;
+
+	return kind * 256 + sizeof( T );
+}
+
+struct MatrixFileHeader
+{
+	static const std::uint32_t VERSION = 1;
+	static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+	static const std::uint32_t ALIGNMENT = 64;
+
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint32_t elementType;
+	std::uint32_t elementSize;
+	std::uint32_t layout;
+	std::uint32_t alignment;
+	std::uint64_t rows;
+	std::uint64_t columns;
+	std::uint64_t dataOffset;
+	std::uint64_t tileSize;
+
+	template < class T > static MatrixFileHeader describe( const std::uint64_t, const std::uint64_t, const MatrixFileLayout, const std::uint64_t = 0 );
+	template < class T > void check( const std::uint64_t, const bool = false ) const;
+
+	std::uint64_t elements() const;
+	std::uint64_t paddedRows() const;
+	std::uint64_t paddedColumns() const;
+	std::uint64_t storedRows() const;
+	std::uint64_t storedColumns() const;
+};
+
+static_assert( sizeof( MatrixFileHeader ) == 64, "MatrixFileHeader must be packed into 64 bytes" );
+
+template < class T >
+class MappedMatrix
+{
+public:
+	explicit MappedMatrix( const std::string& );
+	MappedMatrix( const MappedMatrix< T >& ) = delete;
+	MappedMatrix( MappedMatrix< T >&& ) noexcept;
+	~MappedMatrix();
+
+	MappedMatrix< T >& operator= ( const MappedMatrix< T >& ) = delete;
+	MappedMatrix< T >& operator= ( MappedMatrix< T >&& ) noexcept;
+
+	const T* operator[] ( const unsigned int ) const;
+
+	MatrixView< const T > view() const;
+	const T* data() const noexcept;
+	unsigned int numRows() const;
+	unsigned int numColumns() const;
+	MatrixFileLayout layout() const;
+
+	void willNeed() const;
+
+private:
+	void unmap();
+
+	void* _mapping;
+	std::size_t _mappedBytes;
+	MatrixFileHeader _header;
+};
+
+template < class T >
+class MatrixFileWriter
+{
+public:
+	MatrixFileWriter( const std::string&, const unsigned int, const unsigned int, const MatrixFileLayout = FILE_ROW_MAJOR );
+	MatrixFileWriter( const MatrixFileWriter< T >& ) = delete;
+	~MatrixFileWriter();
+
+	MatrixFileWriter< T >& operator= ( const MatrixFileWriter< T >& ) = delete;
+
+	void write( const T*, const std::size_t );
+	void write( const MatrixView< const T >& );
+
+	std::uint64_t remaining() const;
+	void close();
+
+private:
+	void checkStream() const;
+
+	std::ofstream _out;
+	MatrixFileHeader _header;
+	std::uint64_t _written;
+};
+
+// MatrixFileHeader
+
+template < class T >
+MatrixFileHeader MatrixFileHeader::describe( const std::uint64_t rows, const std::uint64_t columns, const MatrixFileLayout layout, const std::uint64_t tileSize )
+{
+	MatrixFileHeader header;
+
+	std::memcpy( header.magic, "LAMATRIX", 8 );
+	header.version = VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.elementType = matrixFileElementType< T >();
+	header.elementSize = sizeof( T );
+	header.layout = layout;
+	header.alignment = ALIGNMENT;
+	header.rows = rows;
+	header.columns = columns;
+	header.dataOffset = ALIGNMENT;
+	header.tileSize = ( layout == FILE_TILED ) ? tileSize : 0;
+
+	return header;
+}
+
+// Checks that the header describes a matrix of T that fits in a file of
+// the given size, tiled or not as the caller expects.
+template < class T >
+void MatrixFileHeader::check( const std::uint64_t fileSize, const bool tiled ) const
+{
+	const std::uint64_t limit = std::numeric_limits< unsigned int >::max();
+
+	if( std::memcmp( magic, "LAMATRIX", 8 ) != 0 || version != VERSION || byteOrder != BYTE_ORDER_MARK || layout > FILE_TILED ||
+		( layout == FILE_TILED ) != tiled || ( tiled ? ( tileSize == 0 || tileSize > limit ) : tileSize != 0 ) )
+	{
+		class MatrixFileFormatException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Not a matrix file of a known version, byte order and layout, tiled as expected.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	if( elementType != matrixFileElementType< T >() || elementSize != sizeof( T ) )
+	{
+		class MatrixFileTypeException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Matrix file holds elements of a different type.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const bool aligned = alignment && !( alignment & ( alignment - 1 ) ) && dataOffset % alignment == 0 && dataOffset >= sizeof( MatrixFileHeader );
+	const bool fits = rows <= limit && columns <= limit &&
+		( !paddedColumns() || paddedRows() <= ( std::numeric_limits< std::size_t >::max() / sizeof( T ) ) / paddedColumns() );
+
+	if( !aligned || !fits || dataOffset > fileSize || paddedRows() * paddedColumns() > ( fileSize - dataOffset ) / sizeof( T ) )
+	{
+		class MatrixFileSizeException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Matrix file is truncated or its dimensions are out of range.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+inline std::uint64_t MatrixFileHeader::elements() const
+{
+	return rows * columns;
+}
+
+// The dimensions rounded up to whole tiles in a tiled file, and as they are
+// otherwise.
+inline std::uint64_t MatrixFileHeader::paddedRows() const
+{
+	return tileSize ? ( rows + tileSize - 1 ) / tileSize * tileSize : rows;
+}
+
+inline std::uint64_t MatrixFileHeader::paddedColumns() const
+{
+	return tileSize ? ( columns + tileSize - 1 ) / tileSize * tileSize : columns;
+}
+
+// The dimensions of the array as laid out in the file: those of the
+// transpose for a column-major file.
+inline std::uint64_t MatrixFileHeader::storedRows() const
+{
+	return ( layout == FILE_ROW_MAJOR ) ? rows : columns;
+}
+
+inline std::uint64_t MatrixFileHeader::storedColumns() const
+{
+	return ( layout == FILE_ROW_MAJOR ) ? columns : rows;
+}
+
+// MappedMatrix
+
+template < class T >
+MappedMatrix< T >::MappedMatrix( const std::string& path ) :
+	_mapping( nullptr ),
+	_mappedBytes( 0 )
+{
+	class MatrixFileOpenException
+		: public std::exception
+	{
+		virtual const char* what() const throw()
+		{
+			return "Cannot open or map the matrix file.";
+		}
+	} ex;
+
+	const int fd = ::open( path.c_str(), O_RDONLY );
+	if( fd < 0 )
+		throw ex;
+
+	struct stat status;
+	if( ::fstat( fd, &status ) != 0 || std::uint64_t( status.st_size ) < sizeof( MatrixFileHeader ) )
+	{
+		::close( fd );
+		throw ex;
+	}
+
+	_mappedBytes = status.st_size;
+	_mapping = ::mmap( nullptr, _mappedBytes, PROT_READ, MAP_SHARED, fd, 0 );
+	::close( fd );
+
+	if( _mapping == MAP_FAILED )
+	{
+		_mapping = nullptr;
+		throw ex;
+	}
+
+	std::memcpy( &_header, _mapping, sizeof( MatrixFileHeader ) );
+
+	try
+	{
+		_header.check< T >( _mappedBytes );
+	}
+	catch( ... )
+	{
+		unmap();
+		throw;
+	}
+}
+
+template < class T >
+MappedMatrix< T >::MappedMatrix( MappedMatrix< T >&& other ) noexcept :
+	_mapping( other._mapping ),
+	_mappedBytes( other._mappedBytes ),
+	_header( other._header )
+{
+	other._mapping = nullptr;
+	other._mappedBytes = 0;
+}
+
+template < class T >
+MappedMatrix< T >::~MappedMatrix()
+{
+	unmap();
+}
+
+template < class T >
+MappedMatrix< T >& MappedMatrix< T >::operator= ( MappedMatrix< T >&& other ) noexcept
+{
+	if( this != &other )
+	{
+		unmap();
+		std::swap( _mapping, other._mapping );
+		std::swap( _mappedBytes, other._mappedBytes );
+		_header = other._header;
+	}
+
+	return *this;
+}
+
+template < class T >
+const T* MappedMatrix< T >::operator[] ( const unsigned int r ) const
+{
+	return data() + std::size_t( r ) * numColumns();
+}
+
+template < class T >
+MatrixView< const T > MappedMatrix< T >::view() const
+{
+	return MatrixView< const T >( data(), numRows(), numColumns(), numColumns() );
+}
+
+template < class T >
+const T* MappedMatrix< T >::data() const noexcept
+{
+	return reinterpret_cast< const T* >( static_cast< const char* >( _mapping ) + _header.dataOffset );
+}
+
+// The dimensions of the array as stored, which are those of the transpose
+// for a column-major file.
+template < class T >
+unsigned int MappedMatrix< T >::numRows() const
+{
+	return _header.storedRows();
+}
+
+template < class T >
+unsigned int MappedMatrix< T >::numColumns() const
+{
+	return _header.storedColumns();
+}
+
+template < class T >
+MatrixFileLayout MappedMatrix< T >::layout() const
+{
+	return MatrixFileLayout( _header.layout );
+}
+
+// Asks the kernel to start reading the whole file in ahead of use, for
+// callers about to sweep all of it.
+template < class T >
+void MappedMatrix< T >::willNeed() const
+{
+	if( _mapping )
+		::madvise( _mapping, _mappedBytes, MADV_WILLNEED );
+}
+
+template < class T >
+void MappedMatrix< T >::unmap()
+{
+	if( _mapping )
+		::munmap( _mapping, _mappedBytes );
+
+	_mapping = nullptr;
+	_mappedBytes = 0;
+}
+
+// MatrixFileWriter
+
+// Writes the header at once; the elements follow through write(), in the
+// order of the layout, and close() checks that all of them came.
+template < class T >
+MatrixFileWriter< T >::MatrixFileWriter( const std::string& path, const unsigned int rows, const unsigned int columns, const MatrixFileLayout layout ) :
+	_out( path, std::ios::binary | std::ios::trunc ),
+	_header( MatrixFileHeader::describe< T >( rows, columns, layout ) ),
+	_written( 0 )
+{
+	if( layout == FILE_TILED )
+	{
+		class MatrixFileLayoutException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Tiled matrix files are written through TiledMatrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	char padding[ MatrixFileHeader::ALIGNMENT ] = {};
+
+	_out.write( reinterpret_cast< const char* >( &_header ), sizeof( MatrixFileHeader ) );
+	_out.write( padding, _header.dataOffset - sizeof( MatrixFileHeader ) );
+	checkStream();
+}
+
+// An unfinished file is left as it is; its header promises more elements
+// than it holds, so readers refuse it.
+template < class T >
+MatrixFileWriter< T >::~MatrixFileWriter()
+{
+	if( _out.is_open() )
+		_out.close();
+}
+
+template < class T >
+void MatrixFileWriter< T >::write( const T* values, const std::size_t count )
+{
+	if( count > remaining() )
+	{
+		class MatrixFileOverflowException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "More elements written than the matrix file holds.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	_out.write( reinterpret_cast< const char* >( values ), count * sizeof( T ) );
+	checkStream();
+	_written += count;
+}
+
+// Appends the rows of a view, one contiguous run at a time.
+template < class T >
+void MatrixFileWriter< T >::write( const MatrixView< const T >& view )
+{
+	if( view.leadingDimension() == view.numColumns() )
+		write( view.data(), std::size_t( view.numRows() ) * view.numColumns() );
+	else
+		for( unsigned int r = 0; r < view.numRows(); r++ )
+			write( view[r], view.numColumns() );
+}
+
+template < class T >
+std::uint64_t MatrixFileWriter< T >::remaining() const
+{
+	return _header.elements() - _written;
+}
+
+template < class T >
+void MatrixFileWriter< T >::close()
+{
+	if( remaining() )
+	{
+		class MatrixFileIncompleteException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Matrix file closed before all of its elements were written.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	_out.close();
+	checkStream();
+}
+
+template < class T >
+void MatrixFileWriter< T >::checkStream() const
+{
+	if( !_out )
+	{
+		class MatrixFileWriteException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot write the matrix file.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+// Whole matrices
+
+template < class T >
+void writeMatrix( const std::string& path, const Matrix< T >& cMatrix )
+{
+	MatrixFileWriter< T > writer( path, cMatrix.numRows(), cMatrix.numColumns() );
+
+	writer.write( cMatrix.data(), cMatrix.length() );
+	writer.close();
+}
+
+template < class T >
+Matrix< T > readMatrix( const std::string& path )
+{
+	class MatrixFileReadException
+		: public std::exception
+	{
+		virtual const char* what() const throw()
+		{
+			return "Cannot read the matrix file.";
+		}
+	} ex;
+
+	std::ifstream in( path, std::ios::binary | std::ios::ate );
+	if( !in )
+		throw ex;
+
+	const std::uint64_t fileSize = in.tellg();
+	MatrixFileHeader header;
+
+	in.seekg( 0 );
+	if( fileSize < sizeof( MatrixFileHeader ) || !in.read( reinterpret_cast< char* >( &header ), sizeof( MatrixFileHeader ) ) )
+		throw ex;
+
+	header.check< T >( fileSize );
+
+	if( header.elements() > std::numeric_limits< unsigned int >::max() )
+	{
+		class MatrixFileTooLargeException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Matrix file holds more elements than a Matrix can; map it instead.";
+			}
+		} tooLarge;
+
+		throw tooLarge;
+	}
+
+	Matrix< T > stored( header.storedRows(), header.storedColumns() );
+
+	in.seekg( header.dataOffset );
+	if( !in.read( reinterpret_cast< char* >( stored.data() ), header.elements() * sizeof( T ) ) )
+		throw ex;
+
+	return ( header.layout == FILE_ROW_MAJOR ) ? std::move( stored ) : stored.transpose();
+}
+
+#endif
@@ -0,0 +1,654 @@
+#ifndef __INCL_MATRIXVIEW_H__
+#define __INCL_MATRIXVIEW_H__
+
+#include "Matrix.h"
+#include "Gemm.h"
+#include "VectorKernels.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <exception>
+#include <algorithm>
+
+// Non-owning views over the storage of a Matrix< T > or Vector< T >.
+//
+// VectorView< T > is a strided run of elements: a row ( stride 1 ), a
+// column ( stride numColumns ) or the diagonal ( stride numColumns + 1 ). It
+// is a VectorExpression leaf, so it mixes with Vector in the element-wise
+// operators and evaluates into a Vector. MatrixView< T > is a rectangular
+// block with its own leading dimension.
+//
+// Both are written through: assigning to a view stores into the matrix it
+// was taken from. T may be const-qualified for read-only views, and a view
+// of T converts to a view of const T. A view must not outlive its matrix,
+// nor be used after the matrix is resized.
+
+template < class T >
+class VectorView
+	: public VectorExpression< VectorView< T > >
+{
+public:
+	typedef typename std::remove_const< T >::type value_type;
+	typedef Vector< value_type > result_type;
+	typedef typename std::conditional< std::is_const< T >::value, const result_type, result_type >::type vector_type;
+
+	VectorView( T* first, const unsigned int length, const std::size_t stride = 1 ) :
+		_first( first ),
+		_length( length ),
+		_stride( stride )
+		{}
+	VectorView( vector_type& cVector ) :
+		_first( cVector.data() ),
+		_length( cVector.length() ),
+		_stride( 1 )
+		{}
+	template < class U, class = typename std::enable_if< std::is_convertible< U*, T* >::value >::type >
+		VectorView( const VectorView< U >& other ) :
+			_first( other.data() ),
+			_length( other.length() ),
+			_stride( other.stride() )
+			{}
+	VectorView( const VectorView< T >& ) = default;
+
+	VectorView< T >& operator= ( const VectorView< T >& );
+	VectorView< T >& operator= ( const result_type& );
+	VectorView< T >& operator+= ( const result_type& );
+	VectorView< T >& operator-= ( const result_type& );
+	template < class E > VectorView< T >& operator= ( const VectorExpression< E >& );
+	template < class E > VectorView< T >& operator+= ( const VectorExpression< E >& );
+	template < class E > VectorView< T >& operator-= ( const VectorExpression< E >& );
+	template < class V > VectorView< T >& operator*= ( const V& );
+	template < class V > VectorView< T >& operator/= ( const V& );
+
+	T& operator[] ( const unsigned int );
+	value_type operator[] ( const unsigned int ) const;
+
+	T* data() const noexcept;
+	unsigned int length() const;
+	std::size_t stride() const;
+	bool contiguous() const;
+
+private:
+	template < class E > void checkLength( const E& ) const;
+
+	T* _first;
+	unsigned int _length;
+	std::size_t _stride;
+};
+
+template < class T >
+class MatrixView
+{
+public:
+	typedef typename std::remove_const< T >::type value_type;
+	typedef typename std::conditional< std::is_const< T >::value, const Matrix< value_type >, Matrix< value_type > >::type matrix_type;
+
+	MatrixView( T* first, const unsigned int rows, const unsigned int columns, const std::size_t leadingDimension ) :
+		_first( first ),
+		_numRows( rows ),
+		_numColumns( columns ),
+		_leadingDimension( leadingDimension )
+		{}
+	MatrixView( matrix_type& cMatrix ) :
+		_first( cMatrix.data() ),
+		_numRows( cMatrix.numRows() ),
+		_numColumns( cMatrix.numColumns() ),
+		_leadingDimension( cMatrix.numColumns() )
+		{}
+	template < class U, class = typename std::enable_if< std::is_convertible< U*, T* >::value >::type >
+		MatrixView( const MatrixView< U >& other ) :
+			_first( other.data() ),
+			_numRows( other.numRows() ),
+			_numColumns( other.numColumns() ),
+			_leadingDimension( other.leadingDimension() )
+			{}
+	MatrixView( const MatrixView< T >& ) = default;
+
+	MatrixView< T >& operator= ( const MatrixView< T >& );
+	template < class U > MatrixView< T >& operator= ( const MatrixView< U >& );
+	template < class U > MatrixView< T >& operator+= ( const MatrixView< U >& );
+	template < class U > MatrixView< T >& operator-= ( const MatrixView< U >& );
+	MatrixView< T >& operator= ( const Matrix< value_type >& );
+	MatrixView< T >& operator+= ( const Matrix< value_type >& );
+	MatrixView< T >& operator-= ( const Matrix< value_type >& );
+	template < class V > MatrixView< T >& operator*= ( const V& );
+	template < class V > MatrixView< T >& operator/= ( const V& );
+
+	T* operator[] ( const unsigned int ) const;
+
+	VectorView< T > row( const unsigned int ) const;
+	VectorView< T > column( const unsigned int ) const;
+	VectorView< T > diagonal() const;
+	MatrixView< T > block( const unsigned int, const unsigned int, const unsigned int, const unsigned int ) const;
+
+	T* data() const noexcept;
+	unsigned int numRows() const;
+	unsigned int numColumns() const;
+	std::size_t leadingDimension() const;
+
+private:
+	template < class U > void assign( const MatrixView< U >& );
+	template < class U > void checkSameDimensions( const MatrixView< U >& ) const;
+
+	T* _first;
+	unsigned int _numRows;
+	unsigned int _numColumns;
+	std::size_t _leadingDimension;
+};
+
+// VectorView
+
+// Assignment stores element-wise into the viewed storage rather than
+// rebinding the view.
+template < class T >
+VectorView< T >& VectorView< T >::operator= ( const VectorView< T >& other )
+{
+	return operator=( static_cast< const VectorExpression< VectorView< T > >& >( other ) );
+}
+
+template < class T >
+VectorView< T >& VectorView< T >::operator= ( const result_type& cVector )
+{
+	return operator=( VectorReference< result_type >( cVector ) );
+}
+
+template < class T >
+VectorView< T >& VectorView< T >::operator+= ( const result_type& cVector )
+{
+	checkLength( cVector );
+
+	if( contiguous() )
+		VectorKernels< value_type >::add( _first, cVector.data(), _length );
+	else
+		operator+=( VectorReference< result_type >( cVector ) );
+
+	return *this;
+}
+
+template < class T >
+VectorView< T >& VectorView< T >::operator-= ( const result_type& cVector )
+{
+	checkLength( cVector );
+
+	if( contiguous() )
+		VectorKernels< value_type >::subtract( _first, cVector.data(), _length );
+	else
+		operator-=( VectorReference< result_type >( cVector ) );
+
+	return *this;
+}
+
+template < class T >
+template < class E >
+VectorView< T >& VectorView< T >::operator= ( const VectorExpression< E >& expression )
+{
+	const E& e = expression.self();
+	checkLength( e );
+
+	for( unsigned int i = 0; i < _length; i++ )
+		_first[ i * _stride ] = e[i];
+
+	return *this;
+}
+
+template < class T >
+template < class E >
+VectorView< T >& VectorView< T >::operator+= ( const VectorExpression< E >& expression )
+{
+	const E& e = expression.self();
+	checkLength( e );
+
+	for( unsigned int i = 0; i < _length; i++ )
+		_first[ i * _stride ] += e[i];
+
+	return *this;
+}
+
+template < class T >
+template < class E >
+VectorView< T >& VectorView< T >::operator-= ( const VectorExpression< E >& expression )
+{
+	const E& e = expression.self();
+	checkLength( e );
+
+	for( unsigned int i = 0; i < _length; i++ )
+		_first[ i * _stride ] -= e[i];
+
+	return *this;
+}
+
+template < class T >
+template < class V >
+VectorView< T >& VectorView< T >::operator*= ( const V& scalar )
+{
+	if( contiguous() )
+		VectorKernels< value_type >::scale( _first, scalar, _length );
+	else
+		for( unsigned int i = 0; i < _length; i++ )
+			_first[ i * _stride ] *= scalar;
+
+	return *this;
+}
+
+template < class T >
+template < class V >
+VectorView< T >& VectorView< T >::operator/= ( const V& scalar )
+{
+	for( unsigned int i = 0; i < _length; i++ )
+		_first[ i * _stride ] /= scalar;
+
+	return *this;
+}
+
+template < class T >
+T& VectorView< T >::operator[] ( const unsigned int index )
+{
+	return _first[ index * _stride ];
+}
+
+// Reads past the end yield zero, as for the other expression leaves.
+template < class T >
+typename VectorView< T >::value_type VectorView< T >::operator[] ( const unsigned int index ) const
+{
+	return ( index < _length ) ? _first[ index * _stride ] : value_type( 0 );
+}
+
+template < class T >
+T* VectorView< T >::data() const noexcept
+{
+	return _first;
+}
+
+template < class T >
+unsigned int VectorView< T >::length() const
+{
+	return _length;
+}
+
+template < class T >
+std::size_t VectorView< T >::stride() const
+{
+	return _stride;
+}
+
+template < class T >
+bool VectorView< T >::contiguous() const
+{
+	return _stride == 1;
+}
+
+template < class T >
+template < class E >
+void VectorView< T >::checkLength( const E& e ) const
+{
+	if( e.length() != _length )
+	{
+		class ViewLengthException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot store a vector of a different length into a view.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+// MatrixView
+
+template < class T >
+MatrixView< T >& MatrixView< T >::operator= ( const MatrixView< T >& other )
+{
+	assign( other );
+
+	return *this;
+}
+
+template < class T >
+template < class U >
+MatrixView< T >& MatrixView< T >::operator= ( const MatrixView< U >& other )
+{
+	assign( other );
+
+	return *this;
+}
+
+template < class T >
+template < class U >
+MatrixView< T >& MatrixView< T >::operator+= ( const MatrixView< U >& other )
+{
+	checkSameDimensions( other );
+
+	for( unsigned int r = 0; r < _numRows; r++ )
+		VectorKernels< value_type >::add( (*this)[r], other[r], _numColumns );
+
+	return *this;
+}
+
+template < class T >
+template < class U >
+MatrixView< T >& MatrixView< T >::operator-= ( const MatrixView< U >& other )
+{
+	checkSameDimensions( other );
+
+	for( unsigned int r = 0; r < _numRows; r++ )
+		VectorKernels< value_type >::subtract( (*this)[r], other[r], _numColumns );
+
+	return *this;
+}
+
+template < class T >
+MatrixView< T >& MatrixView< T >::operator= ( const Matrix< value_type >& cMatrix )
+{
+	return operator=( MatrixView< const value_type >( cMatrix ) );
+}
+
+template < class T >
+MatrixView< T >& MatrixView< T >::operator+= ( const Matrix< value_type >& cMatrix )
+{
+	return operator+=( MatrixView< const value_type >( cMatrix ) );
+}
+
+template < class T >
+MatrixView< T >& MatrixView< T >::operator-= ( const Matrix< value_type >& cMatrix )
+{
+	return operator-=( MatrixView< const value_type >( cMatrix ) );
+}
+
+template < class T >
+template < class V >
+MatrixView< T >& MatrixView< T >::operator*= ( const V& scalar )
+{
+	for( unsigned int r = 0; r < _numRows; r++ )
+		VectorKernels< value_type >::scale( (*this)[r], scalar, _numColumns );
+
+	return *this;
+}
+
+template < class T >
+template < class V >
+MatrixView< T >& MatrixView< T >::operator/= ( const V& scalar )
+{
+	for( unsigned int r = 0; r < _numRows; r++ )
+		for( unsigned int c = 0; c < _numColumns; c++ )
+			(*this)[r][c] /= scalar;
+
+	return *this;
+}
+
+template < class T >
+T* MatrixView< T >::operator[] ( const unsigned int r ) const
+{
+	return _first + r * _leadingDimension;
+}
+
+template < class T >
+VectorView< T > MatrixView< T >::row( const unsigned int r ) const
+{
+	return VectorView< T >( (*this)[r], _numColumns );
+}
+
+template < class T >
+VectorView< T > MatrixView< T >::column( const unsigned int c ) const
+{
+	return VectorView< T >( _first + c, _numRows, _leadingDimension );
+}
+
+template < class T >
+VectorView< T > MatrixView< T >::diagonal() const
+{
+	return VectorView< T >( _first, std::min( _numRows, _numColumns ), _leadingDimension + 1 );
+}
+
+// The rows x columns block whose top-left element is ( r, c ).
+template < class T >
+MatrixView< T > MatrixView< T >::block( const unsigned int r, const unsigned int c, const unsigned int rows, const unsigned int columns ) const
+{
+	if( r + rows > _numRows || c + columns > _numColumns )
+	{
+		class BlockBoundsException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Block extends past the edge of the matrix.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	return MatrixView< T >( (*this)[r] + c, rows, columns, _leadingDimension );
+}
+
+template < class T >
+T* MatrixView< T >::data() const noexcept
+{
+	return _first;
+}
+
+template < class T >
+unsigned int MatrixView< T >::numRows() const
+{
+	return _numRows;
+}
+
+template < class T >
+unsigned int MatrixView< T >::numColumns() const
+{
+	return _numColumns;
+}
+
+template < class T >
+std::size_t MatrixView< T >::leadingDimension() const
+{
+	return _leadingDimension;
+}
+
+template < class T >
+template < class U >
+void MatrixView< T >::assign( const MatrixView< U >& other )
+{
+	checkSameDimensions( other );
+
+	for( unsigned int r = 0; r < _numRows; r++ )
+		std::copy( other[r], other[r] + _numColumns, (*this)[r] );
+}
+
+template < class T >
+template < class U >
+void MatrixView< T >::checkSameDimensions( const MatrixView< U >& other ) const
+{
+	if( _numRows != other.numRows() || _numColumns != other.numColumns() )
+	{
+		class MatrixDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot combine matrices of different dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+// Matrix members returning views
+
+template < class T >
+template < class U >
+Matrix< T >::Matrix( const MatrixView< U >& view ) :
+	Vector< T >::Vector( view.numRows() * view.numColumns() ),
+	_numRows( view.numRows() ),
+	_numColumns( view.numColumns() )
+{
+	MatrixView< T >( *this ) = view;
+}
+
+template < class T >
+VectorView< T > Matrix< T >::row( const unsigned int r )
+{
+	return VectorView< T >( (*this)[r], _numColumns );
+}
+
+template < class T >
+VectorView< const T > Matrix< T >::row( const unsigned int r ) const
+{
+	return VectorView< const T >( (*this)[r], _numColumns );
+}
+
+template < class T >
+VectorView< T > Matrix< T >::column( const unsigned int c )
+{
+	return VectorView< T >( data() + c, _numRows, _numColumns );
+}
+
+template < class T >
+VectorView< const T > Matrix< T >::column( const unsigned int c ) const
+{
+	return VectorView< const T >( data() + c, _numRows, _numColumns );
+}
+
+template < class T >
+VectorView< T > Matrix< T >::diagonal()
+{
+	return MatrixView< T >( *this ).diagonal();
+}
+
+template < class T >
+VectorView< const T > Matrix< T >::diagonal() const
+{
+	return MatrixView< const T >( *this ).diagonal();
+}
+
+template < class T >
+MatrixView< T > Matrix< T >::block( const unsigned int r, const unsigned int c, const unsigned int rows, const unsigned int columns )
+{
+	return MatrixView< T >( *this ).block( r, c, rows, columns );
+}
+
+template < class T >
+MatrixView< const T > Matrix< T >::block( const unsigned int r, const unsigned int c, const unsigned int rows, const unsigned int columns ) const
+{
+	return MatrixView< const T >( *this ).block( r, c, rows, columns );
+}
+
+// View arithmetic
+
+template < class T, class U >
+typename VectorView< T >::value_type dot( const VectorView< T >& lhs, const VectorView< U >& rhs )
+{
+	typedef typename VectorView< T >::value_type value_type;
+	static_assert( std::is_same< value_type, typename VectorView< U >::value_type >::value, "dot needs views of the same element type" );
+
+	const unsigned int n = std::min( lhs.length(), rhs.length() );
+
+	if( lhs.contiguous() && rhs.contiguous() )
+		return VectorKernels< value_type >::dot( lhs.data(), rhs.data(), n );
+
+	value_type out( 0 );
+
+	for( unsigned int i = 0; i < n; i++ )
+		out += lhs.data()[ i * lhs.stride() ] * rhs.data()[ i * rhs.stride() ];
+
+	return out;
+}
+
+template < class T, class U >
+T dot( const Vector< T >& lhs, const VectorView< U >& rhs )
+{
+	return dot( VectorView< const T >( lhs ), rhs );
+}
+
+template < class T, class U >
+U dot( const VectorView< T >& lhs, const Vector< U >& rhs )
+{
+	return dot( lhs, VectorView< const U >( rhs ) );
+}
+
+template < class T >
+typename VectorView< T >::value_type sum( const VectorView< T >& cView )
+{
+	typedef typename VectorView< T >::value_type value_type;
+
+	if( cView.contiguous() )
+		return VectorKernels< value_type >::sum( cView.data(), cView.length() );
+
+	value_type out( 0 );
+
+	for( unsigned int i = 0; i < cView.length(); i++ )
+		out += cView.data()[ i * cView.stride() ];
+
+	return out;
+}
+
+// y += a * x, over the first x.length() elements of y.
+template < class T, class U >
+VectorView< T > axpy( VectorView< T > y, const typename VectorView< T >::value_type& a, const VectorView< U >& x )
+{
+	typedef typename VectorView< T >::value_type value_type;
+
+	if( x.length() > y.length() )
+	{
+		class ViewLengthException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot store a vector of a different length into a view.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	if( y.contiguous() && x.contiguous() )
+		VectorKernels< value_type >::axpy( y.data(), a, x.data(), x.length() );
+	else
+		for( unsigned int i = 0; i < x.length(); i++ )
+			y.data()[ i * y.stride() ] += a * x.data()[ i * x.stride() ];
+
+	return y;
+}
+
+// Exchanges the elements of two views of the same length.
+template < class T >
+void swap( VectorView< T > lhs, VectorView< T > rhs )
+{
+	const unsigned int n = std::min( lhs.length(), rhs.length() );
+
+	for( unsigned int i = 0; i < n; i++ )
+		std::swap( lhs.data()[ i * lhs.stride() ], rhs.data()[ i * rhs.stride() ] );
+}
+
+// C += A * B over views, so block algorithms can update a sub-region of a
+// matrix in place.
+template < class T, class A, class B >
+MatrixView< T > multiplyAdd( MatrixView< T > c, const MatrixView< A >& a, const MatrixView< B >& b )
+{
+	if( a.numColumns() != b.numRows() || c.numRows() != a.numRows() || c.numColumns() != b.numColumns() )
+	{
+		class MatrixMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply matrices of incompatible dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	Gemm< typename MatrixView< T >::value_type >::multiply( c.numRows(), c.numColumns(), a.numColumns(),
+															a.data(), a.leadingDimension(),
+															b.data(), b.leadingDimension(),
+															c.data(), c.leadingDimension() );
+
+	return c;
+}
+
+#endif
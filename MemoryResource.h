@@ -0,0 +1,436 @@
+#ifndef __INCL_MEMORYRESOURCE_H__
+#define __INCL_MEMORYRESOURCE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+
+// Where AlignedAllocator, and so every Vector, Matrix and Polynomial, takes
+// its storage from. Each allocator holds the resource current on its thread
+// when it was made, and gives its blocks back to that same resource, so
+// containers from different resources mix freely:
+//
+//   MonotonicArena arena( 1 << 20 );
+//   {
+//       MemoryResourceScope scope( arena );
+//       ... every container made here draws on the arena ...
+//   }
+//   arena.release();
+//
+// Copying a container takes storage from the resource current where the
+// copy is made; moving one keeps its storage. Outside any scope, the heap
+// is used.
+//
+//   - MonotonicArena hands out memory by bumping a pointer through blocks
+//     obtained from its upstream resource, or through a buffer supplied by
+//     the caller, and frees nothing until release() or its destruction;
+//     reset() starts over in the largest block instead of returning it, so
+//     that an arena reused per request settles into one block. Nothing must
+//     still use its memory then.
+//   - SizeClassPool keeps a free list per power-of-two block size from
+//     MIN_BLOCK to MAX_BLOCK, carving the blocks out of larger chunks from
+//     its upstream resource, and passes larger requests straight through.
+//     Freed blocks are reused, and release() returns every chunk at once.
+//
+// Neither is safe to share between threads. A scope applies to its own
+// thread only: the workers of a ThreadPool keep their own resource, the
+// heap by default.
+
+class MemoryResource
+{
+public:
+	virtual ~MemoryResource()
+		{}
+
+	virtual void* allocate( const std::size_t, const std::size_t ) = 0;
+	virtual void deallocate( void*, const std::size_t, const std::size_t ) = 0;
+};
+
+// Global operator new, aligned up to 256 bytes. The offset back to the block
+// returned by operator new is kept in the byte just before the aligned
+// pointer.
+class HeapResource
+	: public MemoryResource
+{
+public:
+	virtual void* allocate( const std::size_t, const std::size_t );
+	virtual void deallocate( void*, const std::size_t, const std::size_t );
+};
+
+class MonotonicArena
+	: public MemoryResource
+{
+public:
+	explicit MonotonicArena( const std::size_t = 64 * 1024, MemoryResource* = nullptr );
+	MonotonicArena( void*, const std::size_t, MemoryResource* = nullptr );
+	MonotonicArena( const MonotonicArena& ) = delete;
+	~MonotonicArena();
+
+	MonotonicArena& operator= ( const MonotonicArena& ) = delete;
+
+	virtual void* allocate( const std::size_t, const std::size_t );
+	virtual void deallocate( void*, const std::size_t, const std::size_t );
+
+	void release();
+	void reset();
+	std::size_t used() const;
+
+private:
+	struct Block
+	{
+		Block* next;
+		std::size_t size;
+		std::size_t alignment;
+	};
+
+	MemoryResource* _upstream;
+	unsigned char* _buffer;
+	std::size_t _bufferSize;
+	std::size_t _initialSize;
+	std::size_t _nextSize;
+
+	Block* _blocks;
+	unsigned char* _current;
+	unsigned char* _end;
+	std::size_t _used;
+};
+
+class SizeClassPool
+	: public MemoryResource
+{
+public:
+	static const std::size_t MIN_BLOCK = 64;
+	static const std::size_t MAX_BLOCK = 1 << 20;
+	static const std::size_t CHUNK = 256 * 1024;
+
+	explicit SizeClassPool( MemoryResource* = nullptr );
+	SizeClassPool( const SizeClassPool& ) = delete;
+	~SizeClassPool();
+
+	SizeClassPool& operator= ( const SizeClassPool& ) = delete;
+
+	virtual void* allocate( const std::size_t, const std::size_t );
+	virtual void deallocate( void*, const std::size_t, const std::size_t );
+
+	void release();
+
+private:
+	static const unsigned int CLASSES = 15;
+	static const std::size_t HEADER = 256;
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct Chunk
+	{
+		Chunk* next;
+		std::size_t size;
+	};
+
+	static unsigned int sizeClass( const std::size_t, const std::size_t );
+
+	MemoryResource* _upstream;
+	FreeBlock* _free[ CLASSES ];
+	Chunk* _chunks;
+};
+
+MemoryResource* heapResource();
+MemoryResource* currentResource();
+
+// Makes a resource current on this thread for the lifetime of the scope.
+class MemoryResourceScope
+{
+public:
+	explicit MemoryResourceScope( MemoryResource& );
+	MemoryResourceScope( const MemoryResourceScope& ) = delete;
+	~MemoryResourceScope();
+
+	MemoryResourceScope& operator= ( const MemoryResourceScope& ) = delete;
+
+	friend MemoryResource* currentResource();
+
+private:
+	static MemoryResource*& slot();
+
+	MemoryResource* _previous;
+};
+
+// Heap
+
+inline void* HeapResource::allocate( const std::size_t bytes, const std::size_t alignment )
+{
+	if( bytes > std::size_t( -1 ) - alignment )
+		throw std::bad_alloc();
+
+	unsigned char* block = static_cast< unsigned char* >( ::operator new( bytes + alignment ) );
+	const std::size_t offset = alignment - reinterpret_cast< std::uintptr_t >( block ) % alignment;
+	unsigned char* aligned = block + offset;
+
+	aligned[ -1 ] = static_cast< unsigned char >( offset - 1 );
+
+	return aligned;
+}
+
+inline void HeapResource::deallocate( void* p, const std::size_t, const std::size_t )
+{
+	unsigned char* aligned = static_cast< unsigned char* >( p );
+
+	::operator delete( aligned - aligned[ -1 ] - 1 );
+}
+
+inline MemoryResource* heapResource()
+{
+	static HeapResource heap;
+
+	return &heap;
+}
+
+inline MemoryResource*& MemoryResourceScope::slot()
+{
+	static thread_local MemoryResource* current = nullptr;
+
+	return current;
+}
+
+inline MemoryResource* currentResource()
+{
+	MemoryResource* current = MemoryResourceScope::slot();
+
+	return current ? current : heapResource();
+}
+
+inline MemoryResourceScope::MemoryResourceScope( MemoryResource& resource ) :
+	_previous( slot() )
+{
+	slot() = &resource;
+}
+
+inline MemoryResourceScope::~MemoryResourceScope()
+{
+	slot() = _previous;
+}
+
+// Monotonic arena
+
+// The first block from upstream holds initialSize bytes; each further one
+// doubles the last.
+inline MonotonicArena::MonotonicArena( const std::size_t initialSize, MemoryResource* upstream ) :
+	_upstream( upstream ? upstream : heapResource() ),
+	_buffer( nullptr ),
+	_bufferSize( 0 ),
+	_initialSize( std::max< std::size_t >( initialSize, 1024 ) ),
+	_nextSize( _initialSize ),
+	_blocks( nullptr ),
+	_current( nullptr ),
+	_end( nullptr ),
+	_used( 0 )
+{
+}
+
+// Serves from buffer first, which the caller owns and must outlive the arena,
+// and from upstream only once it is full.
+inline MonotonicArena::MonotonicArena( void* buffer, const std::size_t size, MemoryResource* upstream ) :
+	_upstream( upstream ? upstream : heapResource() ),
+	_buffer( static_cast< unsigned char* >( buffer ) ),
+	_bufferSize( size ),
+	_initialSize( std::max< std::size_t >( size, 1024 ) ),
+	_nextSize( _initialSize ),
+	_blocks( nullptr ),
+	_current( _buffer ),
+	_end( _buffer + size ),
+	_used( 0 )
+{
+}
+
+inline MonotonicArena::~MonotonicArena()
+{
+	release();
+}
+
+inline void* MonotonicArena::allocate( const std::size_t bytes, const std::size_t alignment )
+{
+	std::size_t padding = _current ? ( alignment - reinterpret_cast< std::uintptr_t >( _current ) % alignment ) % alignment : 0;
+
+	if( !_current || bytes + padding > std::size_t( _end - _current ) )
+	{
+		const std::size_t header = ( sizeof( Block ) + alignment - 1 ) / alignment * alignment;
+		std::size_t size = _nextSize;
+		while( size < bytes + header )
+			size *= 2;
+
+		const std::size_t blockAlignment = std::max< std::size_t >( alignment, alignof( Block ) );
+		Block* block = static_cast< Block* >( _upstream->allocate( size, blockAlignment ) );
+		block->next = _blocks;
+		block->size = size;
+		block->alignment = blockAlignment;
+		_blocks = block;
+		_nextSize = size * 2;
+
+		_current = reinterpret_cast< unsigned char* >( block ) + header;
+		_end = reinterpret_cast< unsigned char* >( block ) + size;
+		padding = 0;
+	}
+
+	void* p = _current + padding;
+	_current += padding + bytes;
+	_used += bytes;
+
+	return p;
+}
+
+inline void MonotonicArena::deallocate( void*, const std::size_t, const std::size_t )
+{
+}
+
+// Returns every block to upstream at once and starts over, from the
+// caller's buffer if there is one.
+inline void MonotonicArena::release()
+{
+	while( _blocks )
+	{
+		Block* next = _blocks->next;
+		_upstream->deallocate( _blocks, _blocks->size, _blocks->alignment );
+		_blocks = next;
+	}
+
+	_current = _buffer;
+	_end = _buffer ? _buffer + _bufferSize : nullptr;
+	_nextSize = _initialSize;
+	_used = 0;
+}
+
+// Returns every block but the largest to upstream and starts over in it,
+// or in the caller's buffer when no block is larger.
+inline void MonotonicArena::reset()
+{
+	Block* largest = nullptr;
+
+	while( _blocks )
+	{
+		Block* next = _blocks->next;
+		if( !largest || _blocks->size > largest->size )
+			std::swap( largest, _blocks );
+
+		if( _blocks )
+			_upstream->deallocate( _blocks, _blocks->size, _blocks->alignment );
+		_blocks = next;
+	}
+
+	_used = 0;
+
+	if( !largest || ( _buffer && largest->size <= _bufferSize ) )
+	{
+		if( largest )
+			_upstream->deallocate( largest, largest->size, largest->alignment );
+
+		release();
+		return;
+	}
+
+	largest->next = nullptr;
+	_blocks = largest;
+	_current = reinterpret_cast< unsigned char* >( largest ) + ( ( sizeof( Block ) + largest->alignment - 1 ) / largest->alignment * largest->alignment );
+	_end = reinterpret_cast< unsigned char* >( largest ) + largest->size;
+	_nextSize = largest->size * 2;
+}
+
+// The bytes handed out since the last release() or reset().
+inline std::size_t MonotonicArena::used() const
+{
+	return _used;
+}
+
+// Size-class pool
+
+inline SizeClassPool::SizeClassPool( MemoryResource* upstream ) :
+	_upstream( upstream ? upstream : heapResource() ),
+	_chunks( nullptr )
+{
+	std::fill( _free, _free + CLASSES, nullptr );
+}
+
+inline SizeClassPool::~SizeClassPool()
+{
+	release();
+}
+
+// The class of blocks of MIN_BLOCK << k bytes serving the request, or
+// CLASSES when it is too large for any. Blocks sit at multiples of their
+// size from a 256-byte aligned base, so a block at least as large as the
+// alignment is aligned.
+inline unsigned int SizeClassPool::sizeClass( const std::size_t bytes, const std::size_t alignment )
+{
+	const std::size_t size = std::max( bytes, alignment );
+
+	unsigned int k = 0;
+	while( k < CLASSES && ( MIN_BLOCK << k ) < size )
+		k++;
+
+	return k;
+}
+
+inline void* SizeClassPool::allocate( const std::size_t bytes, const std::size_t alignment )
+{
+	const unsigned int k = sizeClass( bytes, alignment );
+
+	if( k == CLASSES || alignment > HEADER )
+		return _upstream->allocate( bytes, alignment );
+
+	if( !_free[k] )
+	{
+		const std::size_t block = MIN_BLOCK << k;
+		const std::size_t size = HEADER + ( block > CHUNK ? block : CHUNK );
+
+		Chunk* chunk = static_cast< Chunk* >( _upstream->allocate( size, HEADER ) );
+		chunk->next = _chunks;
+		chunk->size = size;
+		_chunks = chunk;
+
+		unsigned char* first = reinterpret_cast< unsigned char* >( chunk ) + HEADER;
+		for( std::size_t offset = size - HEADER; offset >= block; offset -= block )
+		{
+			FreeBlock* free = reinterpret_cast< FreeBlock* >( first + offset - block );
+			free->next = _free[k];
+			_free[k] = free;
+		}
+	}
+
+	FreeBlock* p = _free[k];
+	_free[k] = p->next;
+
+	return p;
+}
+
+inline void SizeClassPool::deallocate( void* p, const std::size_t bytes, const std::size_t alignment )
+{
+	const unsigned int k = sizeClass( bytes, alignment );
+
+	if( k == CLASSES || alignment > HEADER )
+	{
+		_upstream->deallocate( p, bytes, alignment );
+		return;
+	}
+
+	FreeBlock* free = static_cast< FreeBlock* >( p );
+	free->next = _free[k];
+	_free[k] = free;
+}
+
+// Returns every chunk to upstream. Blocks larger than MAX_BLOCK went to
+// upstream directly and are not affected.
+inline void SizeClassPool::release()
+{
+	while( _chunks )
+	{
+		Chunk* next = _chunks->next;
+		_upstream->deallocate( _chunks, _chunks->size, HEADER );
+		_chunks = next;
+	}
+
+	std::fill( _free, _free + CLASSES, nullptr );
+}
+
+#endif
@@ -0,0 +1,986 @@
+#ifndef __INCL_MULTIVARIATEPOLYNOMIAL_H__
+#define __INCL_MULTIVARIATEPOLYNOMIAL_H__
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <cstddef>
+#include <iostream>
+#include <exception>
+
+// Polynomials in a fixed number of variables x0, ..., x(n-1), kept as their
+// non-zero terms in decreasing monomial order, leading term first.
+//
+// A monomial is packed into one 64-bit word of n fields, each 64 / n bits
+// wide (at most 32), with the total degree in the top field:
+//
+//   GRADED_LEX           ( d, e0, e1, ..., e(n-2) )
+//   GRADED_REVERSE_LEX   ( d, e0 + ... + e(n-2), ..., e0 + e1, e0 )
+//
+// so that comparing the words compares the monomials in that order, and
+// adding the words multiplies the monomials. No field exceeds the total
+// degree, which bounds the degree at 2^( 64 / n ) - 1; products past it
+// throw.
+//
+// Products follow Johnson's heap merge, with equal monomials chained on one
+// heap node; with a pool, the shorter operand is split across the threads
+// and the sorted partial products merged pairwise. Evaluation at many
+// points takes them BLOCK at a time against a table of the powers of each
+// coordinate, so that every term is a run of multiplies across a block of
+// points.
+
+enum MonomialOrder
+{
+	GRADED_LEX,
+	GRADED_REVERSE_LEX
+};
+
+template < class T >
+struct MultivariateTerm
+{
+	std::vector< unsigned int > exponents;
+	T coefficient;
+};
+
+template < class T >
+class MultivariatePolynomial;
+
+template < class T >
+MultivariatePolynomial< T > multiply( const MultivariatePolynomial< T >&, const MultivariatePolynomial< T >&, const ExecutionPolicy& = ExecutionPolicy() );
+template < class T >
+void evaluate( const MultivariatePolynomial< T >&, const T*, const std::size_t, T*, const ExecutionPolicy& = ExecutionPolicy() );
+
+template < class T >
+class MultivariateKernels
+{
+public:
+	static const std::size_t BLOCK = 64;
+
+	friend class MultivariatePolynomial< T >;
+	template < class U >
+		friend MultivariatePolynomial< U > multiply( const MultivariatePolynomial< U >&, const MultivariatePolynomial< U >&, const ExecutionPolicy& );
+	template < class U >
+		friend void evaluate( const MultivariatePolynomial< U >&, const U*, const std::size_t, U*, const ExecutionPolicy& );
+
+private:
+	static std::size_t heapMultiply( const unsigned long long*, const T*, const std::size_t,
+									 const unsigned long long*, const T*, const std::size_t,
+									 std::vector< unsigned long long >&, std::vector< T >& );
+	static void merge( std::vector< unsigned long long >&, std::vector< T >&,
+					   const std::vector< unsigned long long >&, const std::vector< T >&, const T& );
+	static void evaluate( const unsigned int*, const T*, const std::size_t, const unsigned int,
+						  const T*, const std::size_t, T* );
+};
+
+template < class T >
+const std::size_t MultivariateKernels< T >::BLOCK;
+
+template < class T >
+class MultivariatePolynomial
+{
+public:
+	static const unsigned int MAX_VARIABLES = 32;
+
+	explicit MultivariatePolynomial( const unsigned int, const MonomialOrder = GRADED_REVERSE_LEX );
+	MultivariatePolynomial( const unsigned int, std::initializer_list< MultivariateTerm< T > >, const MonomialOrder = GRADED_REVERSE_LEX );
+	template < class InputIterator >
+		MultivariatePolynomial( const unsigned int, InputIterator, InputIterator, const MonomialOrder = GRADED_REVERSE_LEX );
+	MultivariatePolynomial( const unsigned int, const MonomialOrder, std::vector< unsigned long long >, std::vector< T > );
+
+	static MultivariatePolynomial< T > variable( const unsigned int, const unsigned int, const MonomialOrder = GRADED_REVERSE_LEX );
+
+	unsigned int variables() const;
+	MonomialOrder order() const;
+	std::size_t terms() const;
+	int degree() const;
+	unsigned int maxDegree() const;
+
+	unsigned long long monomial( const unsigned int* ) const;
+	std::vector< unsigned int > exponents( const std::size_t ) const;
+	const std::vector< unsigned long long >& monomials() const;
+	const std::vector< T >& coefficients() const;
+
+	T operator[] ( const std::vector< unsigned int >& ) const;
+	T operator() ( const T* ) const;
+	T operator() ( const std::vector< T >& ) const;
+
+	MultivariatePolynomial< T >& operator+= ( const MultivariatePolynomial< T >& );
+	MultivariatePolynomial< T >& operator-= ( const MultivariatePolynomial< T >& );
+	MultivariatePolynomial< T >& operator*= ( const MultivariatePolynomial< T >& );
+	MultivariatePolynomial< T >& operator*= ( const T& );
+
+	void checkCompatible( const MultivariatePolynomial< T >& ) const;
+
+	template < class U >
+		friend std::ostream& operator<< ( std::ostream&, const MultivariatePolynomial< U >& );
+
+private:
+	void unpack( unsigned long long, unsigned int* ) const;
+	void checkDegree( const unsigned long long ) const;
+
+	unsigned int _variables;
+	MonomialOrder _order;
+	unsigned int _bits;
+
+	std::vector< unsigned long long > _monomials;
+	std::vector< T > _coefficients;
+};
+
+// Kernels
+
+// The product of the terms ( am, ac )[0..an) and ( bm, bc )[0..bn), both in
+// decreasing order, appended to ( outM, outC ) in decreasing order.
+//
+// Each term i of a walks along b, with at most one pending product
+// a[i] b[next[i]] at a time: taking it admits a[i] b[next[i] + 1], and
+// a[i + 1] b[0] when next[i] was 0. The pending products sit in a heap by
+// monomial, and those found equal to a node on their way up are chained to
+// it instead of taking a node of their own, which keeps the heap small when
+// the product collapses many terms together.
+template < class T >
+std::size_t MultivariateKernels< T >::heapMultiply( const unsigned long long* am, const T* ac, const std::size_t an,
+													const unsigned long long* bm, const T* bc, const std::size_t bn,
+													std::vector< unsigned long long >& outM, std::vector< T >& outC )
+{
+	if( !an || !bn )
+		return 0;
+
+	struct Node
+	{
+		unsigned long long monomial;
+		std::size_t head;
+	};
+
+	const std::size_t none = an;
+	std::vector< std::size_t > next( an, 0 ), chain( an, none ), taken;
+	std::vector< Node > heap;
+	heap.reserve( an );
+
+	auto insert = [&]( const std::size_t i )
+	{
+		const unsigned long long monomial = am[i] + bm[ next[i] ];
+
+		std::size_t k = heap.size();
+		while( k > 0 && heap[ ( k - 1 ) / 2 ].monomial < monomial )
+			k = ( k - 1 ) / 2;
+
+		if( k > 0 && heap[ ( k - 1 ) / 2 ].monomial == monomial )
+		{
+			Node& node = heap[ ( k - 1 ) / 2 ];
+			chain[i] = node.head;
+			node.head = i;
+			return;
+		}
+
+		k = heap.size();
+		heap.push_back( Node{ monomial, i } );
+		for( ; k > 0 && heap[ ( k - 1 ) / 2 ].monomial < monomial; k = ( k - 1 ) / 2 )
+			heap[k] = heap[ ( k - 1 ) / 2 ];
+
+		heap[k] = Node{ monomial, i };
+		chain[i] = none;
+	};
+
+	auto pop = [&heap]()
+	{
+		const Node moving = heap.back();
+		heap.pop_back();
+
+		const std::size_t size = heap.size();
+		if( !size )
+			return;
+
+		std::size_t k = 0;
+		for( std::size_t child = 1; child < size; child = 2 * k + 1 )
+		{
+			if( child + 1 < size && heap[ child + 1 ].monomial > heap[child].monomial )
+				child++;
+
+			if( heap[child].monomial <= moving.monomial )
+				break;
+
+			heap[k] = heap[child];
+			k = child;
+		}
+
+		heap[k] = moving;
+	};
+
+	insert( 0 );
+	const std::size_t start = outM.size();
+
+	while( !heap.empty() )
+	{
+		const unsigned long long monomial = heap.front().monomial;
+		T sum( 0 );
+		taken.clear();
+
+		do
+		{
+			for( std::size_t i = heap.front().head; i != none; i = chain[i] )
+			{
+				sum += ac[i] * bc[ next[i] ];
+				taken.push_back( i );
+			}
+
+			pop();
+		} while( !heap.empty() && heap.front().monomial == monomial );
+
+		for( const std::size_t i : taken )
+		{
+			if( next[i] == 0 && i + 1 < an )
+				insert( i + 1 );
+
+			if( ++next[i] < bn )
+				insert( i );
+		}
+
+		if( sum != T( 0 ) )
+		{
+			outM.push_back( monomial );
+			outC.push_back( sum );
+		}
+	}
+
+	return outM.size() - start;
+}
+
+// ( m, c ) += sign * ( rm, rc ), both in decreasing order.
+template < class T >
+void MultivariateKernels< T >::merge( std::vector< unsigned long long >& m, std::vector< T >& c,
+									  const std::vector< unsigned long long >& rm, const std::vector< T >& rc, const T& sign )
+{
+	std::vector< unsigned long long > outM;
+	std::vector< T > outC;
+	outM.reserve( m.size() + rm.size() );
+	outC.reserve( m.size() + rm.size() );
+
+	std::size_t i = 0, j = 0;
+	while( i < m.size() || j < rm.size() )
+	{
+		if( j == rm.size() || ( i < m.size() && m[i] > rm[j] ) )
+		{
+			outM.push_back( m[i] );
+			outC.push_back( c[ i++ ] );
+		}
+		else if( i == m.size() || rm[j] > m[i] )
+		{
+			outM.push_back( rm[j] );
+			outC.push_back( sign * rc[ j++ ] );
+		}
+		else
+		{
+			const T sum = c[ i++ ] + sign * rc[j];
+			if( sum != T( 0 ) )
+			{
+				outM.push_back( rm[j] );
+				outC.push_back( sum );
+			}
+			j++;
+		}
+	}
+
+	m.swap( outM );
+	c.swap( outC );
+}
+
+// Writes to out[p] the value at points[p * n .. p * n + n) of the polynomial
+// with the given terms, exponents holding n entries per term, for every
+// p < count. Within a block of points, the powers of each coordinate up to
+// the largest exponent of its variable are tabulated with the points
+// innermost, and every term is then a product across the block.
+template < class T >
+void MultivariateKernels< T >::evaluate( const unsigned int* exponents, const T* coefficients, const std::size_t terms, const unsigned int n,
+										 const T* points, const std::size_t count, T* out )
+{
+	std::vector< std::size_t > offset( n + 1, 0 );
+	for( unsigned int v = 0; v < n; v++ )
+	{
+		unsigned int top = 0;
+		for( std::size_t t = 0; t < terms; t++ )
+			top = std::max( top, exponents[ t * n + v ] );
+
+		offset[ v + 1 ] = offset[v] + top + 1;
+	}
+
+	std::vector< T > powers( offset[n] * BLOCK ), product( BLOCK ), sum( BLOCK );
+
+	for( std::size_t first = 0; first < count; first += BLOCK )
+	{
+		const std::size_t lanes = std::min( BLOCK, count - first );
+
+		for( unsigned int v = 0; v < n; v++ )
+		{
+			T* row = powers.data() + offset[v] * BLOCK;
+			for( std::size_t l = 0; l < lanes; l++ )
+				row[l] = T( 1 );
+
+			for( std::size_t e = 1; e < offset[ v + 1 ] - offset[v]; e++ )
+				for( std::size_t l = 0; l < lanes; l++ )
+					row[ e * BLOCK + l ] = row[ ( e - 1 ) * BLOCK + l ] * points[ ( first + l ) * n + v ];
+		}
+
+		std::fill( sum.begin(), sum.begin() + lanes, T( 0 ) );
+
+		for( std::size_t t = 0; t < terms; t++ )
+		{
+			std::fill( product.begin(), product.begin() + lanes, coefficients[t] );
+
+			for( unsigned int v = 0; v < n; v++ )
+			{
+				const unsigned int e = exponents[ t * n + v ];
+				if( !e )
+					continue;
+
+				const T* row = powers.data() + ( offset[v] + e ) * BLOCK;
+				for( std::size_t l = 0; l < lanes; l++ )
+					product[l] *= row[l];
+			}
+
+			for( std::size_t l = 0; l < lanes; l++ )
+				sum[l] += product[l];
+		}
+
+		std::copy( sum.begin(), sum.begin() + lanes, out + first );
+	}
+}
+
+// Members
+
+template < class T >
+MultivariatePolynomial< T >::MultivariatePolynomial( const unsigned int variables, const MonomialOrder order ) :
+	_variables( variables ),
+	_order( order ),
+	_bits( variables ? std::min( 64 / variables, 32u ) : 0 )
+{
+	if( variables == 0 || variables > MAX_VARIABLES )
+	{
+		class VariableCountException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "A multivariate polynomial needs between 1 and MAX_VARIABLES variables.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+template < class T >
+MultivariatePolynomial< T >::MultivariatePolynomial( const unsigned int variables, std::initializer_list< MultivariateTerm< T > > iList,
+													 const MonomialOrder order ) :
+	MultivariatePolynomial( variables, iList.begin(), iList.end(), order )
+{
+}
+
+// Builds the polynomial from terms in any order. Coefficients given more
+// than once for the same monomial are summed, and zero terms dropped.
+template < class T >
+template < class InputIterator >
+MultivariatePolynomial< T >::MultivariatePolynomial( const unsigned int variables, InputIterator first, InputIterator last,
+													 const MonomialOrder order ) :
+	MultivariatePolynomial( variables, order )
+{
+	std::vector< std::pair< unsigned long long, T > > packed;
+
+	for( ; first != last; ++first )
+	{
+		const MultivariateTerm< T >& term = *first;
+
+		if( term.exponents.size() != _variables )
+		{
+			class ExponentCountException
+				: public std::exception
+			{
+				virtual const char* what() const throw()
+				{
+					return "A term needs one exponent per variable.";
+				}
+			} ex;
+
+			throw ex;
+		}
+
+		packed.emplace_back( monomial( term.exponents.data() ), term.coefficient );
+	}
+
+	std::stable_sort( packed.begin(), packed.end(), []( const std::pair< unsigned long long, T >& a, const std::pair< unsigned long long, T >& b )
+	{
+		return a.first > b.first;
+	} );
+
+	for( std::size_t i = 0; i < packed.size(); )
+	{
+		const unsigned long long m = packed[i].first;
+		T sum( 0 );
+
+		for( ; i < packed.size() && packed[i].first == m; i++ )
+			sum += packed[i].second;
+
+		if( sum != T( 0 ) )
+		{
+			_monomials.push_back( m );
+			_coefficients.push_back( sum );
+		}
+	}
+}
+
+// Adopts terms already packed for this number of variables and order.
+template < class T >
+MultivariatePolynomial< T >::MultivariatePolynomial( const unsigned int variables, const MonomialOrder order,
+													 std::vector< unsigned long long > monomials, std::vector< T > coefficients ) :
+	MultivariatePolynomial( variables, order )
+{
+	bool valid = monomials.size() == coefficients.size();
+
+	for( std::size_t i = 0; valid && i < monomials.size(); i++ )
+		valid = coefficients[i] != T( 0 ) && ( i == 0 || monomials[ i - 1 ] > monomials[i] );
+
+	if( !valid )
+	{
+		class MultivariateFormatException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Terms must be non-zero with strictly decreasing monomials.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	_monomials = std::move( monomials );
+	_coefficients = std::move( coefficients );
+}
+
+// The polynomial x( index ).
+template < class T >
+MultivariatePolynomial< T > MultivariatePolynomial< T >::variable( const unsigned int variables, const unsigned int index,
+																   const MonomialOrder order )
+{
+	MultivariatePolynomial< T > x( variables, order );
+
+	std::vector< unsigned int > e( variables, 0 );
+	e.at( index ) = 1;
+
+	x._monomials.push_back( x.monomial( e.data() ) );
+	x._coefficients.push_back( T( 1 ) );
+
+	return x;
+}
+
+template < class T >
+unsigned int MultivariatePolynomial< T >::variables() const
+{
+	return _variables;
+}
+
+template < class T >
+MonomialOrder MultivariatePolynomial< T >::order() const
+{
+	return _order;
+}
+
+template < class T >
+std::size_t MultivariatePolynomial< T >::terms() const
+{
+	return _monomials.size();
+}
+
+// The total degree of the leading term, which is the largest in a graded
+// order; -1 for the zero polynomial.
+template < class T >
+int MultivariatePolynomial< T >::degree() const
+{
+	if( _monomials.empty() )
+		return -1;
+
+	return (int)( _monomials.front() >> ( _bits * ( _variables - 1 ) ) );
+}
+
+// The largest total degree the packing can hold.
+template < class T >
+unsigned int MultivariatePolynomial< T >::maxDegree() const
+{
+	return (unsigned int)( ( 1ull << _bits ) - 1 );
+}
+
+// The packed word for the given exponents, one per variable.
+template < class T >
+unsigned long long MultivariatePolynomial< T >::monomial( const unsigned int* exponents ) const
+{
+	unsigned long long total = 0;
+	for( unsigned int v = 0; v < _variables; v++ )
+		total += exponents[v];
+
+	checkDegree( total );
+
+	unsigned long long packed = total, partial = 0;
+
+	if( _order == GRADED_LEX )
+		for( unsigned int v = 0; v + 1 < _variables; v++ )
+			packed = ( packed << _bits ) | exponents[v];
+	else
+	{
+		partial = total;
+		for( unsigned int v = _variables - 1; v > 0; v-- )
+		{
+			partial -= exponents[v];
+			packed = ( packed << _bits ) | partial;
+		}
+	}
+
+	return packed;
+}
+
+template < class T >
+void MultivariatePolynomial< T >::unpack( unsigned long long packed, unsigned int* exponents ) const
+{
+	const unsigned long long mask = ( 1ull << _bits ) - 1;
+	const unsigned int n = _variables;
+
+	if( _order == GRADED_LEX )
+	{
+		unsigned int rest = 0;
+		for( unsigned int v = n - 1; v-- > 0; packed >>= _bits )
+		{
+			exponents[v] = (unsigned int)( packed & mask );
+			rest += exponents[v];
+		}
+
+		exponents[ n - 1 ] = (unsigned int)packed - rest;
+	}
+	else
+	{
+		// The fields from the bottom are e0, e0 + e1, ..., up to the total.
+		unsigned int previous = 0;
+		for( unsigned int v = 0; v < n; v++, packed >>= _bits )
+		{
+			const unsigned int partial = (unsigned int)( packed & mask );
+			exponents[v] = partial - previous;
+			previous = partial;
+		}
+	}
+}
+
+template < class T >
+std::vector< unsigned int > MultivariatePolynomial< T >::exponents( const std::size_t term ) const
+{
+	std::vector< unsigned int > e( _variables );
+	unpack( _monomials.at( term ), e.data() );
+
+	return e;
+}
+
+template < class T >
+const std::vector< unsigned long long >& MultivariatePolynomial< T >::monomials() const
+{
+	return _monomials;
+}
+
+template < class T >
+const std::vector< T >& MultivariatePolynomial< T >::coefficients() const
+{
+	return _coefficients;
+}
+
+template < class T >
+T MultivariatePolynomial< T >::operator[] ( const std::vector< unsigned int >& e ) const
+{
+	unsigned long long total = 0;
+	for( const unsigned int exponent : e )
+		total += exponent;
+
+	if( e.size() != _variables || total > maxDegree() )
+		return T( 0 );
+
+	const unsigned long long m = monomial( e.data() );
+	const auto it = std::lower_bound( _monomials.begin(), _monomials.end(), m, std::greater< unsigned long long >() );
+
+	if( it == _monomials.end() || *it != m )
+		return T( 0 );
+
+	return _coefficients[ it - _monomials.begin() ];
+}
+
+template < class T >
+T MultivariatePolynomial< T >::operator() ( const T* point ) const
+{
+	T value;
+	evaluate( *this, point, 1, &value );
+
+	return value;
+}
+
+template < class T >
+T MultivariatePolynomial< T >::operator() ( const std::vector< T >& point ) const
+{
+	if( point.size() != _variables )
+	{
+		class PointDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Points need one coordinate per variable.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	return ( *this )( point.data() );
+}
+
+template < class T >
+MultivariatePolynomial< T >& MultivariatePolynomial< T >::operator+= ( const MultivariatePolynomial< T >& rhPolynomial )
+{
+	checkCompatible( rhPolynomial );
+	MultivariateKernels< T >::merge( _monomials, _coefficients, rhPolynomial._monomials, rhPolynomial._coefficients, T( 1 ) );
+
+	return *this;
+}
+
+template < class T >
+MultivariatePolynomial< T >& MultivariatePolynomial< T >::operator-= ( const MultivariatePolynomial< T >& rhPolynomial )
+{
+	checkCompatible( rhPolynomial );
+	MultivariateKernels< T >::merge( _monomials, _coefficients, rhPolynomial._monomials, rhPolynomial._coefficients, T( -1 ) );
+
+	return *this;
+}
+
+template < class T >
+MultivariatePolynomial< T >& MultivariatePolynomial< T >::operator*= ( const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return *this = multiply( *this, rhPolynomial );
+}
+
+template < class T >
+MultivariatePolynomial< T >& MultivariatePolynomial< T >::operator*= ( const T& scalar )
+{
+	if( scalar == T( 0 ) )
+	{
+		_monomials.clear();
+		_coefficients.clear();
+	}
+	else
+		for( T& coefficient : _coefficients )
+			coefficient *= scalar;
+
+	return *this;
+}
+
+template < class T >
+void MultivariatePolynomial< T >::checkCompatible( const MultivariatePolynomial< T >& other ) const
+{
+	if( _variables != other._variables || _order != other._order )
+	{
+		class IncompatiblePolynomialsException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Polynomials differ in their variables or monomial order.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+template < class T >
+void MultivariatePolynomial< T >::checkDegree( const unsigned long long total ) const
+{
+	if( total > maxDegree() )
+	{
+		class DegreeOverflowException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "The total degree does not fit in the packed monomials.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+template < class U >
+std::ostream& operator<< ( std::ostream& out, const MultivariatePolynomial< U >& cPolynomial )
+{
+	if( !cPolynomial.terms() )
+		return out << 0;
+
+	std::vector< unsigned int > e( cPolynomial._variables );
+
+	for( std::size_t t = 0; t < cPolynomial.terms(); t++ )
+	{
+		cPolynomial.unpack( cPolynomial._monomials[t], e.data() );
+
+		const U& coefficient = cPolynomial._coefficients[t];
+		const bool constant = std::all_of( e.begin(), e.end(), []( unsigned int k ) { return k == 0; } );
+		U magnitude = coefficient;
+
+		if( t == 0 )
+		{
+			if( coefficient == U( -1 ) && !constant )
+				out << '-';
+		}
+		else
+		{
+			const bool negative = coefficient < U( 0 );
+			magnitude = negative ? -coefficient : coefficient;
+			out << ( negative ? " - " : " + " );
+		}
+
+		bool space = false;
+		if( ( magnitude != U( 1 ) && magnitude != U( -1 ) ) || constant )
+		{
+			out << magnitude;
+			space = true;
+		}
+
+		for( unsigned int v = 0; v < e.size(); v++ )
+			if( e[v] )
+			{
+				out << ( space ? " " : "" ) << 'x' << v;
+				if( e[v] > 1 )
+					out << '^' << e[v];
+				space = true;
+			}
+	}
+
+	return out;
+}
+
+// Free functions
+
+template < class T >
+bool operator== ( const MultivariatePolynomial< T >& lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return lhPolynomial.variables() == rhPolynomial.variables() && lhPolynomial.order() == rhPolynomial.order() &&
+		   lhPolynomial.monomials() == rhPolynomial.monomials() && lhPolynomial.coefficients() == rhPolynomial.coefficients();
+}
+
+template < class T >
+bool operator!= ( const MultivariatePolynomial< T >& lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return !( lhPolynomial == rhPolynomial );
+}
+
+template < class T >
+MultivariatePolynomial< T > operator+ ( MultivariatePolynomial< T > lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return lhPolynomial += rhPolynomial;
+}
+
+template < class T >
+MultivariatePolynomial< T > operator- ( MultivariatePolynomial< T > lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return lhPolynomial -= rhPolynomial;
+}
+
+template < class T >
+MultivariatePolynomial< T > operator* ( MultivariatePolynomial< T > cPolynomial, const T& scalar )
+{
+	return cPolynomial *= scalar;
+}
+
+template < class T >
+MultivariatePolynomial< T > operator* ( const T& scalar, MultivariatePolynomial< T > cPolynomial )
+{
+	return cPolynomial *= scalar;
+}
+
+// With the policy allowing it, the shorter operand is cut into one run of
+// terms per thread, each run multiplied by the other operand through its
+// own heap, and the sorted partial products merged pairwise.
+template < class T >
+MultivariatePolynomial< T > multiply( const MultivariatePolynomial< T >& lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial,
+									  const ExecutionPolicy& policy )
+{
+	lhPolynomial.checkCompatible( rhPolynomial );
+
+	if( !lhPolynomial.terms() || !rhPolynomial.terms() )
+		return MultivariatePolynomial< T >( lhPolynomial.variables(), lhPolynomial.order() );
+
+	if( (unsigned long long)lhPolynomial.degree() + rhPolynomial.degree() > lhPolynomial.maxDegree() )
+	{
+		class DegreeOverflowException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "The degree of the product does not fit in the packed monomials.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const bool swap = lhPolynomial.terms() > rhPolynomial.terms();
+	const MultivariatePolynomial< T >& a = swap ? rhPolynomial : lhPolynomial;
+	const MultivariatePolynomial< T >& b = swap ? lhPolynomial : rhPolynomial;
+
+	const unsigned long work = (unsigned long)a.terms() * b.terms();
+	const std::size_t runs = policy.parallel( work ) ? std::min< std::size_t >( a.terms(), policy.pool().size() ) : 1;
+
+	std::vector< std::vector< unsigned long long > > monomials( runs );
+	std::vector< std::vector< T > > coefficients( runs );
+
+	auto multiplyRun = [&]( std::size_t r )
+	{
+		const std::size_t first = a.terms() * r / runs, last = a.terms() * ( r + 1 ) / runs;
+		MultivariateKernels< T >::heapMultiply( a.monomials().data() + first, a.coefficients().data() + first, last - first,
+												b.monomials().data(), b.coefficients().data(), b.terms(),
+												monomials[r], coefficients[r] );
+	};
+
+	if( runs == 1 )
+		multiplyRun( 0 );
+	else
+	{
+		policy.pool().parallelFor( 0, runs, [&]( std::size_t first, std::size_t last )
+		{
+			for( std::size_t r = first; r < last; r++ )
+				multiplyRun( r );
+		} );
+
+		for( std::size_t step = 1; step < runs; step *= 2 )
+			policy.pool().parallelFor( 0, ( runs + 2 * step - 1 ) / ( 2 * step ), [&]( std::size_t first, std::size_t last )
+			{
+				for( std::size_t r = first * 2 * step; r < last * 2 * step; r += 2 * step )
+					if( r + step < runs )
+					{
+						MultivariateKernels< T >::merge( monomials[r], coefficients[r], monomials[ r + step ], coefficients[ r + step ], T( 1 ) );
+						std::vector< unsigned long long >().swap( monomials[ r + step ] );
+						std::vector< T >().swap( coefficients[ r + step ] );
+					}
+			} );
+	}
+
+	return MultivariatePolynomial< T >( a.variables(), a.order(), std::move( monomials[0] ), std::move( coefficients[0] ) );
+}
+
+template < class T >
+MultivariatePolynomial< T > operator* ( const MultivariatePolynomial< T >& lhPolynomial, const MultivariatePolynomial< T >& rhPolynomial )
+{
+	return multiply( lhPolynomial, rhPolynomial );
+}
+
+template < class T >
+MultivariatePolynomial< T > pow( const MultivariatePolynomial< T >& cPolynomial, unsigned long long exponent,
+								 const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	const std::vector< unsigned int > zero( cPolynomial.variables(), 0 );
+	MultivariatePolynomial< T > result( cPolynomial.variables(), { { zero, T( 1 ) } }, cPolynomial.order() );
+	MultivariatePolynomial< T > base( cPolynomial );
+
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result = multiply( result, base, policy );
+
+		exponent >>= 1;
+		if( exponent )
+			base = multiply( base, base, policy );
+	}
+
+	return result;
+}
+
+// The partial derivative in x( index ). Dividing the surviving terms by
+// x( index ) keeps them in order, so the packed words only need the packed
+// x( index ) subtracted.
+template < class T >
+MultivariatePolynomial< T > derivative( const MultivariatePolynomial< T >& cPolynomial, const unsigned int index )
+{
+	std::vector< unsigned int > e( cPolynomial.variables(), 0 );
+	e.at( index ) = 1;
+	const unsigned long long x = cPolynomial.monomial( e.data() );
+
+	std::vector< unsigned long long > monomials;
+	std::vector< T > coefficients;
+
+	for( std::size_t t = 0; t < cPolynomial.terms(); t++ )
+	{
+		const unsigned int exponent = cPolynomial.exponents( t )[ index ];
+		const T coefficient = cPolynomial.coefficients()[t] * T( exponent );
+
+		if( exponent && coefficient != T( 0 ) )
+		{
+			monomials.push_back( cPolynomial.monomials()[t] - x );
+			coefficients.push_back( coefficient );
+		}
+	}
+
+	return MultivariatePolynomial< T >( cPolynomial.variables(), cPolynomial.order(), std::move( monomials ), std::move( coefficients ) );
+}
+
+// Batched evaluation
+
+// Writes cPolynomial( points + p * n ) to out[p] for every p < count, with
+// n the number of variables and the points stored one after another. Blocks
+// of points are split across the pool when the policy allows.
+template < class T >
+void evaluate( const MultivariatePolynomial< T >& cPolynomial, const T* points, const std::size_t count, T* out,
+			   const ExecutionPolicy& policy )
+{
+	const unsigned int n = cPolynomial.variables();
+
+	std::vector< unsigned int > exponents( cPolynomial.terms() * n );
+	for( std::size_t t = 0; t < cPolynomial.terms(); t++ )
+	{
+		const std::vector< unsigned int > e = cPolynomial.exponents( t );
+		std::copy( e.begin(), e.end(), exponents.begin() + t * n );
+	}
+
+	const std::size_t block = MultivariateKernels< T >::BLOCK;
+	const std::size_t blocks = ( count + block - 1 ) / block;
+
+	if( blocks > 1 && policy.parallel( (unsigned long)count * cPolynomial.terms() * n ) )
+		policy.pool().parallelFor( 0, blocks, [&]( std::size_t first, std::size_t last )
+		{
+			const std::size_t begin = first * block, end = std::min( count, last * block );
+			MultivariateKernels< T >::evaluate( exponents.data(), cPolynomial.coefficients().data(), cPolynomial.terms(), n,
+												points + begin * n, end - begin, out + begin );
+		} );
+	else
+		MultivariateKernels< T >::evaluate( exponents.data(), cPolynomial.coefficients().data(), cPolynomial.terms(), n,
+											points, count, out );
+}
+
+// The values at the rows of points, one point per row.
+template < class T >
+Vector< T > evaluate( const MultivariatePolynomial< T >& cPolynomial, const Matrix< T >& points, const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	if( points.numColumns() != cPolynomial.variables() )
+	{
+		class PointDimensionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Points need one coordinate per variable.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	Vector< T > values( points.numRows() );
+	evaluate( cPolynomial, points.data(), points.numRows(), values.data(), policy );
+
+	return values;
+}
+
+#endif
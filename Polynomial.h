@@ -2,8 +2,21 @@
 #define __INCL_POLYNOMIAL_H__
 
 #include "Vector.h"
+#include "Convolution.h"
+#include "Evaluation.h"
+#include "ThreadPool.h"
+#include "Instrumentation.h"
+#include "Integer.h"
 #include <iterator>
 #include <initializer_list>
+#include <utility>
+#include <limits>
+#include <type_traits>
+#include <exception>
+#include <cstddef>
+
+template < class T >
+class SubproductTree;
 
 template < class T >
 class Polynomial
@@ -19,6 +32,9 @@ public:
 	Polynomial( const Vector< T >& cVector ) :
 		Vector< T >::Vector( cVector )
 		{}
+	Polynomial( Vector< T >&& cVector ) :
+		Vector< T >::Vector( std::move( cVector ) )
+		{}
 	template < class InputIterator >
 		Polynomial( InputIterator first, InputIterator last ) :
 			Vector< T >::Vector( first, last )
@@ -26,39 +42,89 @@ public:
 	Polynomial( std::initializer_list< T > iList ) :
 		Vector< T >::Vector( iList )
 		{}
+	template < class E >
+		Polynomial( const VectorExpression< E >& expression ) :
+			Vector< T >::Vector( expression )
+			{}
+	
+	using Vector< T >::operator=;
 	
 	Polynomial< T >& operator*= ( const Polynomial< T >& );
 	
-	template <class U > U operator() ( const U& );
+	template <class U > U operator() ( const U& ) const;
 	
 	template < class U >
 		friend std::ostream& operator<< ( std::ostream&, const Polynomial< U >& );
 	
-	const int degree() const;
+	int degree() const;
+	Polynomial< T >& trim();
+	Polynomial< T >& truncate( const unsigned int );
+	
+	static const unsigned int NEWTON_DIVISION = 2048;
+	static const unsigned int NEWTON_DIVISION_MODULO = 128;
+	static const unsigned int HALF_GCD = 32;
+	
+	template < class U >
+		friend Polynomial< U > inverseSeries( const Polynomial< U >&, const unsigned int );
+	template < class U >
+		friend std::pair< Polynomial< U >, Polynomial< U > > divide( const Polynomial< U >&, const Polynomial< U >& );
+	template < class U >
+		friend std::pair< Polynomial< U >, Polynomial< U > > divideModulo( const Polynomial< U >&, Polynomial< U >, const U& );
+	template < class U >
+		friend Polynomial< U > pseudoRemainder( const Polynomial< U >&, const Polynomial< U >& );
+	template < class U >
+		friend class SubproductTree;
 	
 private:
+	static void checkDivisor( const Polynomial< T >& );
+	static T exactQuotient( const T&, const T& );
+	static T exactQuotient( const T&, const T&, std::true_type );
+	static T exactQuotient( const T&, const T&, std::false_type );
+	static bool newtonDivisible( const T& );
+	static bool newtonDivisible( const T&, std::true_type );
+	static bool newtonDivisible( const T&, std::false_type );
+	static Polynomial< T > newtonQuotient( const Polynomial< T >&, const Polynomial< T >&, const Polynomial< T >& );
+	
 	using Vector< T >::_values;
 };
 
 template < class T >
 Polynomial< T >& Polynomial< T >::operator*= ( const Polynomial< T >& rhVector )
 {
-	Polynomial< T > temp( _values );
+	_values = std::move( ( (*this) * rhVector )._values );
 	
-	_values = ( temp * rhVector )._values;
+	return *this;
 }
 
+// Estrin's scheme over blocks of four coefficients: Horner's rule in x^4,
+// with the two halves of each block independent of one another and of the
+// running value, which shortens the chain of dependent multiplies to about
+// a quarter of the degree. Use evaluate() for many points at once.
 template < class T >
 template < class U >
-U Polynomial< T >::operator() ( const U& param )
+U Polynomial< T >::operator() ( const U& param ) const
 {
-	U eval(0);
-	U mult(1);
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_EVALUATE, 2ull * length() );
+	
+	const unsigned int n = length();
+	unsigned int i = n - n % 4;
+	U eval( 0 );
+	
+	for( unsigned int k = n; k-- > i; )
+		eval = eval * param + U( _values[k] );
+	
+	if( i == 0 )
+		return eval;
 	
-	for( unsigned int i = 0; i < length(); i++ )
+	const U square = param * param;
+	const U fourth = square * square;
+	
+	while( i )
 	{
-		eval += mult * _values[i];
-		mult *= param;
+		i -= 4;
+		const U low = U( _values[i] ) + param * _values[ i + 1 ];
+		const U high = U( _values[ i + 2 ] ) + param * _values[ i + 3 ];
+		eval = eval * fourth + ( low + square * high );
 	}
 	
 	return eval;
@@ -111,38 +177,490 @@ std::ostream& operator<< ( std::ostream &out, const Polynomial< U > &cPolynomial
 }
 
 template < class T >
-const int Polynomial< T >::degree() const
+int Polynomial< T >::degree() const
 {
 	return _values.size() - 1;
 }
 
+// Drops zero coefficients above the leading term, so that degree() is exact.
+template < class T >
+Polynomial< T >& Polynomial< T >::trim()
+{
+	while( !_values.empty() && _values.back() == T( 0 ) )
+		_values.pop_back();
+	
+	return *this;
+}
+
+// Reduces modulo x^terms, keeping exactly terms coefficients.
+template < class T >
+Polynomial< T >& Polynomial< T >::truncate( const unsigned int terms )
+{
+	_values.resize( terms, T( 0 ) );
+	
+	return *this;
+}
+
 template < class T >
 Polynomial< T > operator* ( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial )
 {
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_MULTIPLY, 2ull * lhPolynomial.length() * rhPolynomial.length() );
+	
 	Polynomial< T > product;
-	product.resize( lhPolynomial.degree() + rhPolynomial.degree() + 1 );
+	if( !lhPolynomial.length() || !rhPolynomial.length() )
+		return product;
 	
-	for( unsigned int i = 0; i < lhPolynomial.length(); i++ )
-		for( unsigned int j = 0; j < rhPolynomial.length(); j++ )
-			product[ i + j ] += lhPolynomial[i] * rhPolynomial[j];
+	product.resize( lhPolynomial.length() + rhPolynomial.length() - 1 );
+	
+	Convolution< T >::multiply( lhPolynomial.data(), lhPolynomial.length(),
+								rhPolynomial.data(), rhPolynomial.length(), product.data() );
 	
 	return product;
 }
 
+// Exponentiation by squaring: O( log exponent ) products.
+template < class T >
+Polynomial< T > pow( const Polynomial< T >& cPolynomial, unsigned long long exponent )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_POW, 0 );
+	
+	Polynomial< T > result{ T( 1 ) };
+	Polynomial< T > base( cPolynomial );
+	
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result *= base;
+		
+		exponent >>= 1;
+		if( exponent )
+			base = base * base;
+	}
+	
+	return result;
+}
+
+// Division
+
+template < class T >
+void Polynomial< T >::checkDivisor( const Polynomial< T >& divisor )
+{
+	if( divisor.degree() < 0 || divisor[ divisor.degree() ] == T( 0 ) )
+	{
+		class PolynomialDivisionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot divide by the zero polynomial or one with a zero leading coefficient.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+}
+
+// a / b, which must be exact for exact types.
+template < class T >
+T Polynomial< T >::exactQuotient( const T& a, const T& b )
+{
+	return exactQuotient( a, b, std::integral_constant< bool, std::numeric_limits< T >::is_integer >() );
+}
+
+template < class T >
+T Polynomial< T >::exactQuotient( const T& a, const T& b, std::false_type )
+{
+	return a / b;
+}
+
+template < class T >
+T Polynomial< T >::exactQuotient( const T& a, const T& b, std::true_type )
+{
+	if( a % b != T( 0 ) )
+	{
+		class InexactDivisionException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Polynomial division is not exact over the coefficient type.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+	
+	return a / b;
+}
+
+// Whether divide() may find the quotient by Newton iteration against a
+// divisor with leading coefficient lead. Over the integers that needs lead
+// to be a unit; the inverse series then has integral coefficients, and even
+// where they wrap, which divide() lets them do in the unsigned type, the
+// quotient comes out right. Over floating point they grow with the size of
+// the other coefficients relative to the leading one and cancel
+// catastrophically, so floating types keep to long division.
+template < class T >
+bool Polynomial< T >::newtonDivisible( const T& lead )
+{
+	return newtonDivisible( lead, std::integral_constant< bool, std::numeric_limits< T >::is_integer >() );
+}
+
+template < class T >
+bool Polynomial< T >::newtonDivisible( const T&, std::false_type )
+{
+	return false;
+}
+
+template < class T >
+bool Polynomial< T >::newtonDivisible( const T& lead, std::true_type )
+{
+	return lead == T( 1 ) || lead == T( -1 );
+}
+
+// The coefficients in reverse order: x^degree * cPolynomial( 1 / x ).
+template < class T >
+Polynomial< T > reverse( const Polynomial< T >& cPolynomial )
+{
+	return Polynomial< T >( cPolynomial.crbegin(), cPolynomial.crend() );
+}
+
+// 1 / cPolynomial as a power series, to the first terms coefficients, by
+// Newton iteration: each step doubles the number of correct terms at the
+// cost of two products. The constant term must be invertible in T.
+template < class T >
+Polynomial< T > inverseSeries( const Polynomial< T >& cPolynomial, const unsigned int terms )
+{
+	if( !cPolynomial.length() || cPolynomial[0] == T( 0 ) )
+	{
+		class SeriesInverseException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "A power series with a zero constant term has no inverse.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+	
+	Polynomial< T > inverse{ Polynomial< T >::exactQuotient( T( 1 ), cPolynomial[0] ) };
+	
+	for( unsigned int precision = 1; precision < terms; )
+	{
+		precision = std::min( 2 * precision, terms );
+		
+		Polynomial< T > error( cPolynomial.cbegin(), cPolynomial.cbegin() + std::min( precision, cPolynomial.length() ) );
+		error *= inverse;
+		error.truncate( precision );
+		
+		for( unsigned int i = 0; i < precision; i++ )
+			error[i] = -error[i];
+		error[0] += T( 2 );
+		
+		inverse *= error;
+		inverse.truncate( precision );
+	}
+	
+	inverse.truncate( terms );
+	
+	return inverse;
+}
+
+// The quotient of dividend by divisor, given at least as many terms of
+// 1 / reverse( divisor ) as the quotient has coefficients: reversed, the
+// quotient is the truncated product of the reversed dividend with that
+// inverse. The dividend must be at least as long as the divisor.
+template < class T >
+Polynomial< T > Polynomial< T >::newtonQuotient( const Polynomial< T >& dividend, const Polynomial< T >& divisor, const Polynomial< T >& inverse )
+{
+	const unsigned int k = dividend.length() - divisor.degree();
+	
+	Polynomial< T > quotient( dividend.crbegin(), dividend.crbegin() + k );
+	quotient *= Polynomial< T >( inverse.cbegin(), inverse.cbegin() + k );
+	quotient.truncate( k );
+	
+	return reverse( quotient );
+}
+
+// Quotient and remainder, with the remainder trimmed. Long division costs
+// O( k m ) for a quotient of k and a divisor of m coefficients; once both
+// reach NEWTON_DIVISION, and newtonDivisible allows, the quotient is found
+// by Newton iteration instead, in a few products. For exact types each
+// quotient coefficient must divide exactly by the leading coefficient of
+// the divisor, which always holds for a monic divisor; otherwise an
+// exception is thrown.
+template < class T >
+std::pair< Polynomial< T >, Polynomial< T > > divide( const Polynomial< T >& dividend, const Polynomial< T >& divisor )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_DIVIDE, 2ull * dividend.length() * divisor.length() );
+	
+	Polynomial< T >::checkDivisor( divisor );
+	
+	const int m = divisor.degree();
+	const T& lead = divisor[m];
+	Polynomial< T > quotient, remainder( dividend );
+	remainder.trim();
+	
+	if( remainder.degree() < m )
+		return std::make_pair( std::move( quotient ), std::move( remainder ) );
+	
+	const unsigned int k = remainder.length() - m;
+	
+	if( std::min< unsigned int >( k, m ) >= Polynomial< T >::NEWTON_DIVISION && Polynomial< T >::newtonDivisible( lead ) )
+	{
+		// The inverse series and the truncated products overflow an
+		// integral T even when the quotient fits, so they are formed in
+		// WrappingInteger< T >::type, where they wrap. The divisor is made
+		// monic first, as exactQuotient does not invert the wrapped -1.
+		typedef typename WrappingInteger< T >::type Word;
+		
+		const Word sign = ( lead == T( 1 ) ) ? Word( 1 ) : Word( 0 ) - Word( 1 );
+		const Polynomial< Word > a( remainder.cbegin(), remainder.cend() );
+		Polynomial< Word > b( divisor.cbegin(), divisor.cbegin() + m + 1 );
+		VectorKernels< Word >::scale( b.data(), sign, b.length() );
+		
+		Polynomial< Word > q = Polynomial< Word >::newtonQuotient( a, b, inverseSeries( reverse( b ), k ) );
+		const Polynomial< Word > multiple = q * b;
+		VectorKernels< Word >::scale( q.data(), sign, q.length() );
+		
+		quotient = Polynomial< T >( q.cbegin(), q.cend() );
+		for( int i = 0; i < m; i++ )
+			remainder[i] = static_cast< T >( a[i] - multiple[i] );
+	}
+	else
+	{
+		quotient.truncate( k );
+		
+		for( int i = remainder.degree(); i >= m; i-- )
+		{
+			if( remainder[i] == T( 0 ) )
+				continue;
+			
+			const T q = Polynomial< T >::exactQuotient( remainder[i], lead );
+			VectorKernels< T >::axpy( remainder.data() + i - m, -q, divisor.data(), m );
+			quotient[ i - m ] = q;
+		}
+	}
+	
+	remainder.truncate( m ).trim();
+	
+	return std::make_pair( std::move( quotient ), std::move( remainder ) );
+}
+
 template < class T >
-Polynomial< T > pow( const Polynomial< T >& cPolynomial, unsigned int exponent )
+Polynomial< T > operator/ ( const Polynomial< T >& dividend, const Polynomial< T >& divisor )
 {
-	Polynomial< T > result( std::vector< T > { T( 1 ) } );
+	return divide( dividend, divisor ).first;
+}
+
+template < class T >
+Polynomial< T > operator% ( const Polynomial< T >& dividend, const Polynomial< T >& divisor )
+{
+	return divide( dividend, divisor ).second;
+}
+
+// Modular arithmetic
+//
+// The functions taking a modulus work in ( Z / modulus )[x], with every
+// coefficient kept in [ 0, modulus ). Products are formed in T before they
+// are reduced, so modulus^2 times the length of the shorter operand must
+// fit in T.
+
+// Reduces every coefficient into [ 0, modulus ).
+template < class T >
+Polynomial< T >& reduceCoefficients( Polynomial< T >& cPolynomial, const T& modulus )
+{
+	for( unsigned int i = 0; i < cPolynomial.length(); i++ )
+	{
+		cPolynomial[i] %= modulus;
+		if( cPolynomial[i] < T( 0 ) )
+			cPolynomial[i] += modulus;
+	}
 	
-	for( unsigned int i = 0; i < exponent; i++ )
-		result *= cPolynomial;
+	return cPolynomial.trim();
+}
+
+// Inverse of a modulo modulus, by the extended Euclidean algorithm.
+template < class T >
+T inverseModulo( const T& a, const T& modulus )
+{
+	T r0 = modulus, r1 = a % modulus, s0 = T( 0 ), s1 = T( 1 );
+	if( r1 < T( 0 ) )
+		r1 += modulus;
+	
+	while( r1 != T( 0 ) )
+	{
+		const T q = r0 / r1;
+		T t = r0 - q * r1;
+		r0 = r1;
+		r1 = t;
+		t = s0 - q * s1;
+		s0 = s1;
+		s1 = t;
+	}
+	
+	if( r0 != T( 1 ) )
+	{
+		class NotInvertibleException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Leading coefficient is not invertible modulo the coefficient modulus.";
+			}
+		} ex;
+		
+		throw ex;
+	}
+	
+	return ( s0 < T( 0 ) ) ? s0 + modulus : s0;
+}
+
+template < class T >
+Polynomial< T > multiplyModulo( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial, const T& modulus )
+{
+	Polynomial< T > product = lhPolynomial * rhPolynomial;
+	
+	return reduceCoefficients( product, modulus );
+}
+
+// As inverseSeries, with the constant term invertible modulo modulus.
+template < class T >
+Polynomial< T > inverseSeriesModulo( const Polynomial< T >& cPolynomial, const unsigned int terms, const T& modulus )
+{
+	Polynomial< T > inverse{ inverseModulo( cPolynomial.length() ? cPolynomial[0] : T( 0 ), modulus ) };
+	
+	for( unsigned int precision = 1; precision < terms; )
+	{
+		precision = std::min( 2 * precision, terms );
 		
+		Polynomial< T > error( cPolynomial.cbegin(), cPolynomial.cbegin() + std::min( precision, cPolynomial.length() ) );
+		error = multiplyModulo( error, inverse, modulus );
+		error.truncate( precision );
+		
+		for( unsigned int i = 0; i < precision; i++ )
+			error[i] = ( error[i] == T( 0 ) ) ? T( 0 ) : modulus - error[i];
+		error[0] = ( error[0] + T( 2 ) ) % modulus;
+		
+		inverse = multiplyModulo( inverse, error, modulus );
+		inverse.truncate( precision );
+	}
+	
+	inverse.truncate( terms );
+	
+	return inverse;
+}
+
+// Quotient and remainder over ( Z / modulus )[x], both trimmed, by long
+// division or, past NEWTON_DIVISION_MODULO, by Newton iteration as in
+// divide(); the reductions make long division dearer here, so the
+// crossover comes much earlier.
+// The leading coefficient of the divisor must be invertible.
+template < class T >
+std::pair< Polynomial< T >, Polynomial< T > > divideModulo( const Polynomial< T >& dividend, Polynomial< T > divisor, const T& modulus )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_DIVIDE, 2ull * dividend.length() * divisor.length() );
+	
+	reduceCoefficients( divisor, modulus );
+	Polynomial< T >::checkDivisor( divisor );
+	
+	const int m = divisor.degree();
+	Polynomial< T > quotient, remainder( dividend );
+	reduceCoefficients( remainder, modulus );
+	
+	if( remainder.degree() < m )
+		return std::make_pair( std::move( quotient ), std::move( remainder ) );
+	
+	const unsigned int k = remainder.length() - m;
+	
+	if( std::min< unsigned int >( k, m ) >= Polynomial< T >::NEWTON_DIVISION_MODULO )
+	{
+		quotient = Polynomial< T >::newtonQuotient( remainder, divisor, inverseSeriesModulo( reverse( divisor ), k, modulus ) );
+		reduceCoefficients( quotient, modulus );
+		
+		const Polynomial< T > multiple = multiplyModulo( quotient, divisor, modulus );
+		for( unsigned int i = 0; i < std::min< unsigned int >( m, multiple.length() ); i++ )
+			remainder[i] = ( remainder[i] + modulus - multiple[i] ) % modulus;
+	}
+	else
+	{
+		const T leadInverse = inverseModulo( divisor[m], modulus );
+		quotient.truncate( k );
+		
+		for( int i = remainder.degree(); i >= m; i-- )
+		{
+			const T q = remainder[i] * leadInverse % modulus;
+			
+			if( q != T( 0 ) )
+				for( int j = 0; j < m; j++ )
+					remainder[ i - m + j ] = ( remainder[ i - m + j ] + ( modulus - q ) * divisor[j] ) % modulus;
+			
+			quotient[ i - m ] = q;
+		}
+	}
+	
+	remainder.truncate( m ).trim();
+	quotient.trim();
+	
+	return std::make_pair( std::move( quotient ), std::move( remainder ) );
+}
+
+template < class T >
+Polynomial< T > remainderModulo( const Polynomial< T >& dividend, const Polynomial< T >& divisor, const T& modulus )
+{
+	return divideModulo( dividend, divisor, modulus ).second;
+}
+
+// cPolynomial^exponent mod divisor, reducing after every product so that
+// the degree stays below that of the divisor throughout.
+template < class T >
+Polynomial< T > powmod( const Polynomial< T >& cPolynomial, unsigned long long exponent, const Polynomial< T >& divisor )
+{
+	Polynomial< T > result = Polynomial< T >{ T( 1 ) } % divisor;
+	Polynomial< T > base = cPolynomial % divisor;
+	
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result = ( result * base ) % divisor;
+		
+		exponent >>= 1;
+		if( exponent )
+			base = ( base * base ) % divisor;
+	}
+	
+	return result;
+}
+
+// As above, in ( Z / modulus )[x] / ( divisor ).
+template < class T >
+Polynomial< T > powmod( const Polynomial< T >& cPolynomial, unsigned long long exponent, const Polynomial< T >& divisor, const T& modulus )
+{
+	static_assert( std::numeric_limits< T >::is_integer, "A coefficient modulus needs an exact coefficient type" );
+	
+	Polynomial< T > result = remainderModulo( Polynomial< T >{ T( 1 ) }, divisor, modulus );
+	Polynomial< T > base = remainderModulo( cPolynomial, divisor, modulus );
+	
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result = remainderModulo( result * base, divisor, modulus );
+		
+		exponent >>= 1;
+		if( exponent )
+			base = remainderModulo( base * base, divisor, modulus );
+	}
+	
 	return result;
 }
 
 template < class T >
 Polynomial< T > derivative( const Polynomial< T >& cPolynomial, unsigned int iter = 1 )
 {
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_DERIVATIVE, cPolynomial.length() );
+	
 	Polynomial< T > result;
 	if( !cPolynomial )
 		return result;
@@ -158,4 +676,48 @@ Polynomial< T > derivative( const Polynomial< T >& cPolynomial, unsigned int ite
 		return derivative( result, iter - 1 );
 }
 
+// Batched evaluation
+
+// Writes cPolynomial( points[i] ) to out[i] for every i < count; out may
+// alias points. Points are evaluated several at a time with Horner's rule
+// in SIMD registers, split across the pool when the policy allows. For
+// exact types, when both the degree and the number of points reach
+// SubproductTree< T >::THRESHOLD, the subproduct tree is used instead.
+template < class T >
+void evaluate( const Polynomial< T >& cPolynomial, const T* points, const std::size_t count, T* out,
+			   const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_POLYNOMIAL_EVALUATE, 2ull * count * cPolynomial.length() );
+	
+	if( std::numeric_limits< T >::is_integer &&
+		std::min< std::size_t >( count, cPolynomial.length() ) >= SubproductTree< T >::THRESHOLD )
+	{
+		SubproductTree< T >( points, count, policy ).evaluate( cPolynomial, out, policy );
+		return;
+	}
+	
+	if( policy.parallel( (unsigned long)count * cPolynomial.length() ) )
+	{
+		policy.pool().parallelFor( 0, count, [&]( std::size_t first, std::size_t last )
+		{
+			EvaluationKernels< T >::horner( cPolynomial.data(), cPolynomial.length(), points + first, last - first, out + first );
+		} );
+	}
+	else
+		EvaluationKernels< T >::horner( cPolynomial.data(), cPolynomial.length(), points, count, out );
+}
+
+template < class T >
+Vector< T > evaluate( const Polynomial< T >& cPolynomial, const Vector< T >& points, const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	Vector< T > values( points.length() );
+	evaluate( cPolynomial, points.data(), points.length(), values.data(), policy );
+	
+	return values;
+}
+
+#include "SubproductTree.h"
+#include "PolynomialGcd.h"
+#include "PolynomialRoots.h"
+
 #endif
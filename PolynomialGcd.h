@@ -0,0 +1,308 @@
+#ifndef __INCL_POLYNOMIALGCD_H__
+#define __INCL_POLYNOMIALGCD_H__
+
+#include "Polynomial.h"
+#include "Integer.h"
+#include "VectorKernels.h"
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+// Greatest common divisors.
+//
+//   - gcd( a, b ) over a floating type runs Euclid's algorithm, treating
+//     remainder coefficients below a relative tolerance as zero, and returns
+//     a monic result;
+//   - over an exact type it follows the primitive remainder sequence, so
+//     that the coefficients stay integral, and returns the primitive gcd
+//     scaled by the gcd of the contents, with a positive leading coefficient;
+//   - gcd( a, b, modulus ) works in ( Z / modulus )[x] for a prime modulus
+//     and returns a monic result. Past HALF_GCD it takes the half-gcd
+//     recursion, which reaches the middle of the remainder sequence in
+//     O( M( n ) log n ) through a 2 x 2 matrix of quotients, without forming
+//     the remainders in between.
+
+// The zero polynomial is empty, with degree -1.
+
+template < class T >
+typename std::enable_if< !std::numeric_limits< T >::is_integer, Polynomial< T > >::type
+	gcd( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial )
+{
+	using std::abs;
+
+	const T tolerance = std::sqrt( std::numeric_limits< T >::epsilon() );
+	Polynomial< T > a( lhPolynomial ), b( rhPolynomial );
+	a.trim();
+	b.trim();
+
+	if( a.degree() < b.degree() )
+		std::swap( a, b );
+
+	while( b.length() )
+	{
+		T scale( 0 );
+		for( unsigned int i = 0; i < a.length(); i++ )
+			scale = std::max( scale, abs( a[i] ) );
+
+		Polynomial< T > r = divide( a, b ).second;
+		for( unsigned int i = 0; i < r.length(); i++ )
+			if( abs( r[i] ) <= tolerance * scale )
+				r[i] = T( 0 );
+
+		a = std::move( b );
+		b = std::move( r.trim() );
+	}
+
+	if( a.length() )
+		VectorKernels< T >::scale( a.data(), T( 1 ) / a[ a.degree() ], a.length() );
+
+	return a;
+}
+
+template < class T >
+T content( const Polynomial< T >& cPolynomial )
+{
+	T divisor( 0 );
+	for( unsigned int i = 0; i < cPolynomial.length() && divisor != T( 1 ); i++ )
+		divisor = gcd( divisor, cPolynomial[i] );
+
+	return divisor;
+}
+
+// cPolynomial divided by its content, with a positive leading coefficient.
+template < class T >
+Polynomial< T > primitivePart( Polynomial< T > cPolynomial )
+{
+	cPolynomial.trim();
+	if( !cPolynomial.length() )
+		return cPolynomial;
+
+	T divisor = content( cPolynomial );
+	if( cPolynomial[ cPolynomial.degree() ] < T( 0 ) )
+		divisor = -divisor;
+
+	for( unsigned int i = 0; i < cPolynomial.length(); i++ )
+		cPolynomial[i] /= divisor;
+
+	return cPolynomial;
+}
+
+// A multiple of the remainder of dividend by divisor, found without leaving
+// the integers: each step scales the partial remainder by the leading
+// coefficient of the divisor before cancelling its leading term.
+template < class T >
+Polynomial< T > pseudoRemainder( const Polynomial< T >& dividend, const Polynomial< T >& divisor )
+{
+	Polynomial< T >::checkDivisor( divisor );
+
+	const int m = divisor.degree();
+	const T& lead = divisor[m];
+	Polynomial< T > remainder( dividend );
+	remainder.trim();
+
+	for( int i = remainder.degree(); i >= m; i-- )
+	{
+		if( remainder[i] == T( 0 ) )
+			continue;
+
+		const T factor = remainder[i];
+		VectorKernels< T >::scale( remainder.data(), lead, i );
+		VectorKernels< T >::axpy( remainder.data() + i - m, -factor, divisor.data(), m );
+		remainder[i] = T( 0 );
+	}
+
+	return remainder.trim();
+}
+
+template < class T >
+typename std::enable_if< std::numeric_limits< T >::is_integer, Polynomial< T > >::type
+	gcd( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial )
+{
+	const T scale = gcd( content( lhPolynomial ), content( rhPolynomial ) );
+	Polynomial< T > a = primitivePart( lhPolynomial ), b = primitivePart( rhPolynomial );
+
+	if( a.degree() < b.degree() )
+		std::swap( a, b );
+
+	while( b.length() )
+	{
+		Polynomial< T > r = primitivePart( pseudoRemainder( a, b ) );
+		a = std::move( b );
+		b = std::move( r );
+	}
+
+	VectorKernels< T >::scale( a.data(), scale, a.length() );
+
+	return a;
+}
+
+// A product of Euclidean quotient steps, acting on a pair of polynomials as
+// ( a, b ) -> ( m00 a + m01 b, m10 a + m11 b ), over ( Z / modulus )[x].
+template < class T >
+struct GcdMatrix
+{
+	Polynomial< T > m00, m01, m10, m11;
+
+	static GcdMatrix< T > identity();
+	static GcdMatrix< T > halfGcd( const Polynomial< T >&, const Polynomial< T >&, const T& );
+
+	void apply( Polynomial< T >&, Polynomial< T >&, const T& ) const;
+
+private:
+	static Polynomial< T > addModulo( const Polynomial< T >&, const Polynomial< T >&, const T& );
+	static Polynomial< T > shiftDown( const Polynomial< T >&, const int );
+	static GcdMatrix< T > compose( const GcdMatrix< T >&, const GcdMatrix< T >&, const T& );
+	static GcdMatrix< T > quotientStep( const Polynomial< T >&, const T& );
+};
+
+template < class T >
+GcdMatrix< T > GcdMatrix< T >::identity()
+{
+	GcdMatrix< T > out;
+	out.m00 = Polynomial< T >{ T( 1 ) };
+	out.m11 = Polynomial< T >{ T( 1 ) };
+
+	return out;
+}
+
+template < class T >
+Polynomial< T > GcdMatrix< T >::addModulo( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial, const T& modulus )
+{
+	Polynomial< T > sum( lhPolynomial );
+	sum.resize( rhPolynomial.length() );
+
+	for( unsigned int i = 0; i < rhPolynomial.length(); i++ )
+		sum[i] = ( sum[i] + rhPolynomial[i] ) % modulus;
+
+	return sum.trim();
+}
+
+template < class T >
+void GcdMatrix< T >::apply( Polynomial< T >& a, Polynomial< T >& b, const T& modulus ) const
+{
+	Polynomial< T > c = addModulo( multiplyModulo( m00, a, modulus ), multiplyModulo( m01, b, modulus ), modulus );
+	b = addModulo( multiplyModulo( m10, a, modulus ), multiplyModulo( m11, b, modulus ), modulus );
+	a = std::move( c );
+}
+
+// lhs * rhs, so that the result applies rhs first.
+template < class T >
+GcdMatrix< T > GcdMatrix< T >::compose( const GcdMatrix< T >& lhs, const GcdMatrix< T >& rhs, const T& modulus )
+{
+	GcdMatrix< T > out;
+	out.m00 = addModulo( multiplyModulo( lhs.m00, rhs.m00, modulus ), multiplyModulo( lhs.m01, rhs.m10, modulus ), modulus );
+	out.m01 = addModulo( multiplyModulo( lhs.m00, rhs.m01, modulus ), multiplyModulo( lhs.m01, rhs.m11, modulus ), modulus );
+	out.m10 = addModulo( multiplyModulo( lhs.m10, rhs.m00, modulus ), multiplyModulo( lhs.m11, rhs.m10, modulus ), modulus );
+	out.m11 = addModulo( multiplyModulo( lhs.m10, rhs.m01, modulus ), multiplyModulo( lhs.m11, rhs.m11, modulus ), modulus );
+
+	return out;
+}
+
+// cPolynomial divided by x^k, dropping the remainder.
+template < class T >
+Polynomial< T > GcdMatrix< T >::shiftDown( const Polynomial< T >& cPolynomial, const int k )
+{
+	if( (int)cPolynomial.length() <= k )
+		return Polynomial< T >();
+
+	return Polynomial< T >( cPolynomial.cbegin() + k, cPolynomial.cend() );
+}
+
+// The matrix of the quotient step ( c, d ) -> ( d, c - q d ).
+template < class T >
+GcdMatrix< T > GcdMatrix< T >::quotientStep( const Polynomial< T >& quotient, const T& modulus )
+{
+	GcdMatrix< T > step;
+	step.m01 = Polynomial< T >{ T( 1 ) };
+	step.m10 = Polynomial< T >{ T( 1 ) };
+	step.m11 = quotient;
+	for( unsigned int i = 0; i < step.m11.length(); i++ )
+		step.m11[i] = ( step.m11[i] == T( 0 ) ) ? T( 0 ) : modulus - step.m11[i];
+
+	return step;
+}
+
+// For reduced a and b with deg a > deg b, the matrix taking ( a, b ) to the
+// consecutive remainders ( c, d ) of their Euclidean sequence with
+// deg c >= ceil( deg a / 2 ) > deg d. The leading halves of a and b fix the
+// first half of the quotients, so each half is found recursively from the
+// top coefficients alone. Below HALF_GCD the quotients are taken one by one.
+template < class T >
+GcdMatrix< T > GcdMatrix< T >::halfGcd( const Polynomial< T >& a, const Polynomial< T >& b, const T& modulus )
+{
+	const int m = ( a.degree() + 1 ) / 2;
+
+	if( b.degree() < m )
+		return identity();
+
+	if( a.degree() < (int)Polynomial< T >::HALF_GCD )
+	{
+		GcdMatrix< T > product = identity();
+		Polynomial< T > c( a ), d( b );
+
+		while( d.degree() >= m )
+		{
+			std::pair< Polynomial< T >, Polynomial< T > > division = divideModulo( c, d, modulus );
+			product = compose( quotientStep( division.first, modulus ), product, modulus );
+			c = std::move( d );
+			d = std::move( division.second );
+		}
+
+		return product;
+	}
+
+	GcdMatrix< T > first = halfGcd( shiftDown( a, m ), shiftDown( b, m ), modulus );
+
+	Polynomial< T > c( a ), d( b );
+	first.apply( c, d, modulus );
+
+	if( d.degree() < m )
+		return first;
+
+	std::pair< Polynomial< T >, Polynomial< T > > division = divideModulo( c, d, modulus );
+
+	const int k = 2 * m - d.degree();
+	GcdMatrix< T > second = halfGcd( shiftDown( d, k ), shiftDown( division.second, k ), modulus );
+
+	return compose( second, compose( quotientStep( division.first, modulus ), first, modulus ), modulus );
+}
+
+template < class T >
+Polynomial< T > gcd( const Polynomial< T >& lhPolynomial, const Polynomial< T >& rhPolynomial, const T& modulus )
+{
+	static_assert( std::numeric_limits< T >::is_integer, "A coefficient modulus needs an exact coefficient type" );
+
+	Polynomial< T > a( lhPolynomial ), b( rhPolynomial );
+	reduceCoefficients( a, modulus );
+	reduceCoefficients( b, modulus );
+
+	if( a.degree() < b.degree() )
+		std::swap( a, b );
+
+	while( b.length() )
+	{
+		if( a.degree() > b.degree() && b.degree() >= (int)Polynomial< T >::HALF_GCD )
+		{
+			GcdMatrix< T >::halfGcd( a, b, modulus ).apply( a, b, modulus );
+			if( !b.length() )
+				break;
+		}
+
+		Polynomial< T > r = remainderModulo( a, b, modulus );
+		a = std::move( b );
+		b = std::move( r );
+	}
+
+	if( a.length() )
+	{
+		const T leadInverse = inverseModulo( a[ a.degree() ], modulus );
+		for( unsigned int i = 0; i < a.length(); i++ )
+			a[i] = a[i] * leadInverse % modulus;
+	}
+
+	return a;
+}
+
+#endif
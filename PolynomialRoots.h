@@ -0,0 +1,202 @@
+#ifndef __INCL_POLYNOMIALROOTS_H__
+#define __INCL_POLYNOMIALROOTS_H__
+
+#include "Polynomial.h"
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include <exception>
+
+// Numerical roots by the Aberth-Ehrlich iteration, which refines
+// approximations to all n roots at once: each is moved by its Newton
+// correction p / p', deflated against the others,
+//
+//   z_k -= N_k / ( 1 - N_k sum_{ j != k } 1 / ( z_k - z_j ) ),  N_k = p( z_k ) / p'( z_k ),
+//
+// which converges cubically to simple roots from starting points spread on
+// a circle. Each sweep costs O( n^2 ). p / p' is taken by Horner's rule in z
+// inside the unit circle and in 1 / z outside it, so that large degrees do
+// not overflow. Exact coefficient types are solved in double.
+
+template < class T >
+struct RootTraits;
+
+template < class T >
+std::vector< typename RootTraits< T >::complex_type > roots( const Polynomial< T >&, const unsigned int = 500 );
+
+template < class T >
+struct RootTraits
+{
+	typedef typename std::conditional< std::is_floating_point< T >::value, T, double >::type real_type;
+	typedef std::complex< real_type > complex_type;
+
+	template < class U >
+		friend std::vector< typename RootTraits< U >::complex_type > roots( const Polynomial< U >&, const unsigned int );
+
+private:
+	static complex_type newtonCorrection( const std::vector< real_type >&, const complex_type& );
+};
+
+// p( z ) / p'( z ) for the polynomial with coefficients c[0..n], c[0] != 0.
+template < class T >
+typename RootTraits< T >::complex_type RootTraits< T >::newtonCorrection( const std::vector< real_type >& c, const complex_type& z )
+{
+	typedef real_type R;
+
+	const unsigned int n = c.size() - 1;
+
+	if( std::abs( z ) <= R( 1 ) )
+	{
+		std::complex< R > value( c[n] ), slope( 0 );
+		for( unsigned int k = n; k-- > 0; )
+		{
+			slope = slope * z + value;
+			value = value * z + c[k];
+		}
+
+		if( value == std::complex< R >( 0 ) )
+			return value;
+
+		return ( slope == std::complex< R >( 0 ) ) ? value : value / slope;
+	}
+
+	// With w = 1 / z and q( w ) = w^n p( z ), p / p' = z / ( n - w q' / q ).
+	const std::complex< R > w = R( 1 ) / z;
+	std::complex< R > value( c[0] ), slope( 0 );
+	for( unsigned int k = 1; k <= n; k++ )
+	{
+		slope = slope * w + value;
+		value = value * w + c[k];
+	}
+
+	if( value == std::complex< R >( 0 ) )
+		return value;
+
+	return z / ( R( n ) - w * slope / value );
+}
+
+// All complex roots of cPolynomial, repeated by multiplicity, to about
+// machine precision for simple roots. Roots at zero are split off exactly.
+template < class T >
+std::vector< typename RootTraits< T >::complex_type > roots( const Polynomial< T >& cPolynomial, const unsigned int maxIterations )
+{
+	typedef typename RootTraits< T >::real_type R;
+	typedef typename RootTraits< T >::complex_type C;
+
+	Polynomial< T > p( cPolynomial );
+	p.trim();
+
+	if( !p.length() )
+	{
+		class ZeroPolynomialException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Every point is a root of the zero polynomial.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	unsigned int zeros = 0;
+	while( p[ zeros ] == T( 0 ) )
+		zeros++;
+
+	std::vector< R > c( p.cbegin() + zeros, p.cend() );
+	std::vector< C > z( zeros, C( 0 ) );
+
+	const unsigned int n = c.size() - 1;
+	if( n == 0 )
+		return z;
+
+	for( unsigned int k = 0; k <= n; k++ )
+		c[k] /= c[n];
+
+	// Start on the circle whose radius is the geometric mean of the root
+	// moduli, off the real axis to break the symmetry of real polynomials.
+	const R pi = std::acos( R( -1 ) );
+	const R radius = std::pow( std::abs( c[0] ), R( 1 ) / n );
+	std::vector< C > root( n );
+	for( unsigned int k = 0; k < n; k++ )
+		root[k] = std::polar( radius, 2 * pi * k / n + R( 0.4 ) );
+
+	const R tolerance = 4 * std::numeric_limits< R >::epsilon();
+	std::vector< bool > converged( n, false );
+	unsigned int remaining = n;
+
+	for( unsigned int iteration = 0; iteration < maxIterations && remaining; iteration++ )
+		for( unsigned int k = 0; k < n; k++ )
+		{
+			if( converged[k] )
+				continue;
+
+			const C correction = RootTraits< T >::newtonCorrection( c, root[k] );
+			C repulsion( 0 );
+			for( unsigned int j = 0; j < n; j++ )
+				if( j != k )
+					repulsion += R( 1 ) / ( root[k] - root[j] );
+
+			const C step = correction / ( R( 1 ) - correction * repulsion );
+			root[k] -= step;
+
+			if( std::abs( step ) <= tolerance * std::abs( root[k] ) || correction == C( 0 ) )
+			{
+				converged[k] = true;
+				remaining--;
+			}
+		}
+
+	z.insert( z.end(), root.begin(), root.end() );
+
+	return z;
+}
+
+// The real roots in increasing order: the roots whose imaginary part is
+// within tolerance of zero, relative to their modulus where that exceeds one,
+// each polished by real Newton steps while they reduce the residual.
+// Repeated real roots come back as clusters whose spread grows with the
+// multiplicity, so the default tolerance is loose.
+template < class T >
+std::vector< typename RootTraits< T >::real_type > realRoots( const Polynomial< T >& cPolynomial,
+	const typename RootTraits< T >::real_type tolerance = std::sqrt( std::numeric_limits< typename RootTraits< T >::real_type >::epsilon() ) )
+{
+	typedef typename RootTraits< T >::real_type R;
+	typedef typename RootTraits< T >::complex_type C;
+
+	const Polynomial< T > slope = derivative( cPolynomial );
+	std::vector< R > real;
+
+	for( const C& z : roots( cPolynomial ) )
+	{
+		if( std::abs( z.imag() ) > tolerance * std::max( R( 1 ), std::abs( z ) ) )
+			continue;
+
+		R x = z.real(), value = cPolynomial( x );
+		for( unsigned int step = 0; step < 3 && value != R( 0 ); step++ )
+		{
+			const R d = slope( x );
+			if( d == R( 0 ) )
+				break;
+
+			const R next = x - value / d, nextValue = cPolynomial( next );
+			if( std::abs( nextValue ) >= std::abs( value ) )
+				break;
+
+			x = next;
+			value = nextValue;
+		}
+
+		real.push_back( x );
+	}
+
+	std::sort( real.begin(), real.end() );
+
+	return real;
+}
+
+#endif
@@ -0,0 +1,592 @@
+#ifndef __INCL_SPARSEMATRIX_H__
+#define __INCL_SPARSEMATRIX_H__
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <exception>
+
+// Compressed sparse storage. In SPARSE_CSR layout offsets() has one entry
+// per row plus one, and indices() holds the column of each stored value; in
+// SPARSE_CSC the roles of rows and columns are exchanged. Within each row
+// (or column) the indices are strictly increasing.
+
+enum SparseLayout
+{
+	SPARSE_CSR,
+	SPARSE_CSC
+};
+
+template < class T >
+struct Triplet
+{
+	unsigned int row;
+	unsigned int column;
+	T value;
+};
+
+template < class T >
+class SparseMatrix;
+
+template < class T >
+void multiplyInto( const SparseMatrix< T >&, const Vector< T >&, Vector< T >&, const ExecutionPolicy& = ExecutionPolicy() );
+
+template < class T >
+class SparseMatrix
+{
+public:
+	SparseMatrix() :
+		_numRows( 0 ),
+		_numColumns( 0 ),
+		_layout( SPARSE_CSR ),
+		_offsets( 1, 0 )
+		{}
+	SparseMatrix( const unsigned int r, const unsigned int c, SparseLayout layout = SPARSE_CSR ) :
+		_numRows( r ),
+		_numColumns( c ),
+		_layout( layout ),
+		_offsets( ( layout == SPARSE_CSR ? r : c ) + 1, 0 )
+		{}
+	template < class InputIterator >
+		SparseMatrix( const unsigned int, const unsigned int, InputIterator, InputIterator, SparseLayout = SPARSE_CSR );
+	SparseMatrix( const unsigned int, const unsigned int, std::vector< std::size_t >,
+				  std::vector< unsigned int >, std::vector< T >, SparseLayout = SPARSE_CSR );
+	explicit SparseMatrix( const Matrix< T >&, SparseLayout = SPARSE_CSR );
+
+	unsigned int numRows() const;
+	unsigned int numColumns() const;
+	std::size_t nonZeros() const;
+	SparseLayout layout() const;
+
+	const std::vector< std::size_t >& offsets() const;
+	const std::vector< unsigned int >& indices() const;
+	const std::vector< T >& values() const;
+
+	T operator() ( const unsigned int, const unsigned int ) const;
+
+	SparseMatrix< T > toLayout( SparseLayout ) const;
+	SparseMatrix< T > transpose() const;
+	Matrix< T > toDense() const;
+
+	template < class U >
+		friend void multiplyInto( const SparseMatrix< U >&, const Vector< U >&, Vector< U >&, const ExecutionPolicy& );
+	template < class U >
+		friend Matrix< U > operator* ( const SparseMatrix< U >&, const Matrix< U >& );
+	template < class U >
+		friend Matrix< U > operator* ( const Matrix< U >&, const SparseMatrix< U >& );
+	template < class U >
+		friend SparseMatrix< U > operator* ( const SparseMatrix< U >&, const SparseMatrix< U >& );
+
+private:
+	unsigned int majorCount() const;
+	unsigned int minorCount() const;
+
+	static void compress( const unsigned int, const unsigned int,
+						  const std::vector< unsigned int >&, const std::vector< unsigned int >&, const std::vector< T >&,
+						  std::vector< std::size_t >&, std::vector< unsigned int >&, std::vector< T >& );
+	static void checkProductDimensions( const unsigned int, const unsigned int );
+
+	unsigned int _numRows;
+	unsigned int _numColumns;
+	SparseLayout _layout;
+
+	std::vector< std::size_t > _offsets;
+	std::vector< unsigned int > _indices;
+	std::vector< T > _values;
+};
+
+// Builds the matrix from ( row, column, value ) triplets in any order.
+// Values given more than once for the same position are summed.
+template < class T >
+template < class InputIterator >
+SparseMatrix< T >::SparseMatrix( const unsigned int r, const unsigned int c,
+								 InputIterator first, InputIterator last, SparseLayout layout ) :
+	_numRows( r ),
+	_numColumns( c ),
+	_layout( layout )
+{
+	std::vector< unsigned int > major, minor;
+	std::vector< T > values;
+
+	for( ; first != last; ++first )
+	{
+		const Triplet< T >& triplet = *first;
+
+		if( triplet.row >= r || triplet.column >= c )
+		{
+			class SparseIndexException
+				: public std::exception
+			{
+				virtual const char* what() const throw()
+				{
+					return "Triplet lies outside the bounds of the sparse matrix.";
+				}
+			} ex;
+
+			throw ex;
+		}
+
+		major.push_back( layout == SPARSE_CSR ? triplet.row : triplet.column );
+		minor.push_back( layout == SPARSE_CSR ? triplet.column : triplet.row );
+		values.push_back( triplet.value );
+	}
+
+	compress( majorCount(), minorCount(), major, minor, values, _offsets, _indices, _values );
+}
+
+// Adopts arrays that are already in compressed form. The offsets must run
+// from zero to the number of values without decreasing, and the indices of
+// each row (or column) must increase strictly and stay within the matrix.
+template < class T >
+SparseMatrix< T >::SparseMatrix( const unsigned int r, const unsigned int c, std::vector< std::size_t > offsets,
+								 std::vector< unsigned int > indices, std::vector< T > values, SparseLayout layout ) :
+	_numRows( r ),
+	_numColumns( c ),
+	_layout( layout ),
+	_offsets( std::move( offsets ) ),
+	_indices( std::move( indices ) ),
+	_values( std::move( values ) )
+{
+	bool valid = _offsets.size() == majorCount() + 1 && _indices.size() == _values.size() &&
+				 _offsets.front() == 0 && _offsets.back() == _values.size();
+
+	for( unsigned int m = 0; valid && m < majorCount(); m++ )
+		valid = _offsets[m] <= _offsets[ m + 1 ];
+
+	for( unsigned int m = 0; valid && m < majorCount(); m++ )
+		for( std::size_t i = _offsets[m]; valid && i < _offsets[ m + 1 ]; i++ )
+			valid = _indices[i] < minorCount() && ( i == _offsets[m] || _indices[ i - 1 ] < _indices[i] );
+
+	if( !valid )
+	{
+		class SparseFormatException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Compressed arrays do not describe a matrix of the given dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+template < class T >
+SparseMatrix< T >::SparseMatrix( const Matrix< T >& dense, SparseLayout layout ) :
+	_numRows( dense.numRows() ),
+	_numColumns( dense.numColumns() ),
+	_layout( layout ),
+	_offsets( 1, 0 )
+{
+	_offsets.reserve( majorCount() + 1 );
+
+	for( unsigned int i = 0; i < majorCount(); i++ )
+	{
+		for( unsigned int j = 0; j < minorCount(); j++ )
+		{
+			const T& value = ( layout == SPARSE_CSR ) ? dense[i][j] : dense[j][i];
+
+			if( value != T( 0 ) )
+			{
+				_indices.push_back( j );
+				_values.push_back( value );
+			}
+		}
+
+		_offsets.push_back( _indices.size() );
+	}
+}
+
+template < class T >
+unsigned int SparseMatrix< T >::numRows() const
+{
+	return _numRows;
+}
+
+template < class T >
+unsigned int SparseMatrix< T >::numColumns() const
+{
+	return _numColumns;
+}
+
+template < class T >
+std::size_t SparseMatrix< T >::nonZeros() const
+{
+	return _values.size();
+}
+
+template < class T >
+SparseLayout SparseMatrix< T >::layout() const
+{
+	return _layout;
+}
+
+template < class T >
+const std::vector< std::size_t >& SparseMatrix< T >::offsets() const
+{
+	return _offsets;
+}
+
+template < class T >
+const std::vector< unsigned int >& SparseMatrix< T >::indices() const
+{
+	return _indices;
+}
+
+template < class T >
+const std::vector< T >& SparseMatrix< T >::values() const
+{
+	return _values;
+}
+
+template < class T >
+T SparseMatrix< T >::operator() ( const unsigned int r, const unsigned int c ) const
+{
+	const unsigned int major = ( _layout == SPARSE_CSR ) ? r : c;
+	const unsigned int minor = ( _layout == SPARSE_CSR ) ? c : r;
+
+	const auto first = _indices.begin() + _offsets[ major ];
+	const auto last = _indices.begin() + _offsets[ major + 1 ];
+	const auto it = std::lower_bound( first, last, minor );
+
+	if( it == last || *it != minor )
+		return T( 0 );
+
+	return _values[ it - _indices.begin() ];
+}
+
+template < class T >
+SparseMatrix< T > SparseMatrix< T >::toLayout( SparseLayout layout ) const
+{
+	if( layout == _layout )
+		return *this;
+
+	// Read as a matrix in the other layout, the current arrays describe the
+	// transpose; re-compressing them with major and minor exchanged gives
+	// the same matrix in the requested layout.
+	std::vector< unsigned int > major, minor;
+	major.reserve( nonZeros() );
+
+	for( unsigned int i = 0; i < majorCount(); i++ )
+		for( std::size_t k = _offsets[i]; k < _offsets[ i + 1 ]; k++ )
+			major.push_back( i );
+
+	SparseMatrix< T > out( _numRows, _numColumns, layout );
+	out._offsets.clear();
+	compress( out.majorCount(), out.minorCount(), _indices, major, _values, out._offsets, out._indices, out._values );
+
+	return out;
+}
+
+// CSR storage of A is CSC storage of A's transpose, so this only copies.
+template < class T >
+SparseMatrix< T > SparseMatrix< T >::transpose() const
+{
+	SparseMatrix< T > out( *this );
+
+	std::swap( out._numRows, out._numColumns );
+	out._layout = ( _layout == SPARSE_CSR ) ? SPARSE_CSC : SPARSE_CSR;
+
+	return out;
+}
+
+template < class T >
+Matrix< T > SparseMatrix< T >::toDense() const
+{
+	Matrix< T > dense( _numRows, _numColumns );
+
+	for( unsigned int i = 0; i < majorCount(); i++ )
+		for( std::size_t k = _offsets[i]; k < _offsets[ i + 1 ]; k++ )
+		{
+			if( _layout == SPARSE_CSR )
+				dense[i][ _indices[k] ] = _values[k];
+			else
+				dense[ _indices[k] ][i] = _values[k];
+		}
+
+	return dense;
+}
+
+template < class T >
+unsigned int SparseMatrix< T >::majorCount() const
+{
+	return ( _layout == SPARSE_CSR ) ? _numRows : _numColumns;
+}
+
+template < class T >
+unsigned int SparseMatrix< T >::minorCount() const
+{
+	return ( _layout == SPARSE_CSR ) ? _numColumns : _numRows;
+}
+
+// Sorts unordered ( major, minor, value ) entries into compressed form with
+// two stable counting sorts, first by minor and then by major, and sums
+// duplicate entries. Runs in O( nonzeros + majorCount + minorCount ).
+template < class T >
+void SparseMatrix< T >::compress( const unsigned int majorCount, const unsigned int minorCount,
+								  const std::vector< unsigned int >& major, const std::vector< unsigned int >& minor,
+								  const std::vector< T >& values,
+								  std::vector< std::size_t >& offsets, std::vector< unsigned int >& indices, std::vector< T >& out )
+{
+	const std::size_t n = values.size();
+
+	std::vector< std::size_t > minorStart( minorCount + 1, 0 );
+	for( std::size_t k = 0; k < n; k++ )
+		minorStart[ minor[k] + 1 ]++;
+	for( unsigned int j = 0; j < minorCount; j++ )
+		minorStart[ j + 1 ] += minorStart[j];
+
+	std::vector< std::size_t > byMinor( n );
+	for( std::size_t k = 0; k < n; k++ )
+		byMinor[ minorStart[ minor[k] ]++ ] = k;
+
+	offsets.assign( majorCount + 1, 0 );
+	for( std::size_t k = 0; k < n; k++ )
+		offsets[ major[k] + 1 ]++;
+	for( unsigned int i = 0; i < majorCount; i++ )
+		offsets[ i + 1 ] += offsets[i];
+
+	std::vector< std::size_t > next( offsets.begin(), offsets.end() - 1 );
+	indices.resize( n );
+	out.resize( n );
+
+	for( std::size_t k : byMinor )
+	{
+		const std::size_t position = next[ major[k] ]++;
+		indices[ position ] = minor[k];
+		out[ position ] = values[k];
+	}
+
+	std::size_t write = 0;
+	for( unsigned int i = 0; i < majorCount; i++ )
+	{
+		const std::size_t first = offsets[i], last = offsets[ i + 1 ];
+		offsets[i] = write;
+
+		for( std::size_t k = first; k < last; k++ )
+		{
+			if( write > offsets[i] && indices[ write - 1 ] == indices[k] )
+				out[ write - 1 ] += out[k];
+			else
+			{
+				indices[ write ] = indices[k];
+				out[ write ] = out[k];
+				write++;
+			}
+		}
+	}
+	offsets[ majorCount ] = write;
+
+	indices.resize( write );
+	out.resize( write );
+}
+
+// Products
+
+template < class T >
+void SparseMatrix< T >::checkProductDimensions( const unsigned int lhColumns, const unsigned int rhRows )
+{
+	if( lhColumns != rhRows )
+	{
+		class MatrixMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply matrices of incompatible dimensions.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+// Sparse matrix-vector product into a vector of the right length, which is
+// reused rather than reallocated. Rows of a CSR matrix are independent and
+// are split across the pool; a CSC matrix scatters into the result and is
+// always computed serially.
+template < class T >
+void multiplyInto( const SparseMatrix< T >& lhs, const Vector< T >& rhs, Vector< T >& product, const ExecutionPolicy& policy )
+{
+	SparseMatrix< T >::checkProductDimensions( lhs.numColumns(), rhs.length() );
+
+	if( product.length() != lhs.numRows() )
+		product = Vector< T >( lhs.numRows() );
+
+	const std::size_t* offsets = lhs.offsets().data();
+	const unsigned int* indices = lhs.indices().data();
+	const T* values = lhs.values().data();
+
+	if( lhs.layout() == SPARSE_CSC )
+	{
+		std::fill( product.data(), product.data() + product.length(), T( 0 ) );
+
+		for( unsigned int c = 0; c < lhs.numColumns(); c++ )
+			for( std::size_t k = offsets[c]; k < offsets[ c + 1 ]; k++ )
+				product[ indices[k] ] += values[k] * rhs[c];
+
+		return;
+	}
+
+	auto rows = [&]( std::size_t first, std::size_t last )
+	{
+		for( std::size_t r = first; r < last; r++ )
+		{
+			T sum( 0 );
+
+			for( std::size_t k = offsets[r]; k < offsets[ r + 1 ]; k++ )
+				sum += values[k] * rhs[ indices[k] ];
+
+			product[r] = sum;
+		}
+	};
+
+	if( policy.parallel( lhs.nonZeros() ) )
+		policy.pool().parallelFor( 0, lhs.numRows(), rows );
+	else
+		rows( 0, lhs.numRows() );
+}
+
+template < class T >
+Vector< T > multiply( const SparseMatrix< T >& lhs, const Vector< T >& rhs, const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	Vector< T > product;
+	multiplyInto( lhs, rhs, product, policy );
+
+	return product;
+}
+
+template < class T >
+Vector< T > operator* ( const SparseMatrix< T >& lhs, const Vector< T >& rhs )
+{
+	return multiply( lhs, rhs );
+}
+
+// Sparse times dense: every stored A( i, k ) adds a multiple of row k of B
+// to row i of the product.
+template < class T >
+Matrix< T > operator* ( const SparseMatrix< T >& lhs, const Matrix< T >& rhs )
+{
+	SparseMatrix< T >::checkProductDimensions( lhs.numColumns(), rhs.numRows() );
+
+	Matrix< T > product( lhs.numRows(), rhs.numColumns() );
+	const unsigned int n = rhs.numColumns();
+
+	for( unsigned int i = 0; i < ( lhs.layout() == SPARSE_CSR ? lhs.numRows() : lhs.numColumns() ); i++ )
+		for( std::size_t k = lhs.offsets()[i]; k < lhs.offsets()[ i + 1 ]; k++ )
+		{
+			const unsigned int r = ( lhs.layout() == SPARSE_CSR ) ? i : lhs.indices()[k];
+			const unsigned int c = ( lhs.layout() == SPARSE_CSR ) ? lhs.indices()[k] : i;
+
+			VectorKernels< T >::axpy( product[r], lhs.values()[k], rhs[c], n );
+		}
+
+	return product;
+}
+
+// Dense times sparse. Against CSR, each A( i, k ) scatters a multiple of
+// row k of B into row i of the product; against CSC, each product entry is
+// a sparse dot product of a row of A with a column of B.
+template < class T >
+Matrix< T > operator* ( const Matrix< T >& lhs, const SparseMatrix< T >& rhs )
+{
+	SparseMatrix< T >::checkProductDimensions( lhs.numColumns(), rhs.numRows() );
+
+	Matrix< T > product( lhs.numRows(), rhs.numColumns() );
+	const std::size_t* offsets = rhs.offsets().data();
+	const unsigned int* indices = rhs.indices().data();
+	const T* values = rhs.values().data();
+
+	for( unsigned int r = 0; r < lhs.numRows(); r++ )
+	{
+		if( rhs.layout() == SPARSE_CSR )
+		{
+			for( unsigned int k = 0; k < lhs.numColumns(); k++ )
+			{
+				const T& scalar = lhs[r][k];
+
+				if( scalar == T( 0 ) )
+					continue;
+
+				for( std::size_t l = offsets[k]; l < offsets[ k + 1 ]; l++ )
+					product[r][ indices[l] ] += scalar * values[l];
+			}
+		}
+		else
+		{
+			for( unsigned int c = 0; c < rhs.numColumns(); c++ )
+			{
+				T sum( 0 );
+
+				for( std::size_t l = offsets[c]; l < offsets[ c + 1 ]; l++ )
+					sum += lhs[r][ indices[l] ] * values[l];
+
+				product[r][c] = sum;
+			}
+		}
+	}
+
+	return product;
+}
+
+// Sparse times sparse by Gustavson's algorithm: each row of the product is
+// accumulated densely, then its touched columns are sorted and gathered.
+// The result is in CSR layout.
+template < class T >
+SparseMatrix< T > operator* ( const SparseMatrix< T >& lhs, const SparseMatrix< T >& rhs )
+{
+	SparseMatrix< T >::checkProductDimensions( lhs.numColumns(), rhs.numRows() );
+
+	const SparseMatrix< T > a = lhs.toLayout( SPARSE_CSR );
+	const SparseMatrix< T > b = rhs.toLayout( SPARSE_CSR );
+
+	std::vector< std::size_t > offsets( 1, 0 );
+	std::vector< unsigned int > indices;
+	std::vector< T > values;
+	std::vector< T > accumulator( b.numColumns(), T( 0 ) );
+	std::vector< bool > touched( b.numColumns(), false );
+	std::vector< unsigned int > columns;
+
+	for( unsigned int r = 0; r < a.numRows(); r++ )
+	{
+		columns.clear();
+
+		for( std::size_t k = a.offsets()[r]; k < a.offsets()[ r + 1 ]; k++ )
+		{
+			const unsigned int inner = a.indices()[k];
+			const T& scalar = a.values()[k];
+
+			for( std::size_t l = b.offsets()[ inner ]; l < b.offsets()[ inner + 1 ]; l++ )
+			{
+				const unsigned int c = b.indices()[l];
+
+				if( !touched[c] )
+				{
+					touched[c] = true;
+					columns.push_back( c );
+				}
+				accumulator[c] += scalar * b.values()[l];
+			}
+		}
+
+		std::sort( columns.begin(), columns.end() );
+
+		for( unsigned int c : columns )
+		{
+			indices.push_back( c );
+			values.push_back( accumulator[c] );
+			accumulator[c] = T( 0 );
+			touched[c] = false;
+		}
+		offsets.push_back( indices.size() );
+	}
+
+	return SparseMatrix< T >( a.numRows(), b.numColumns(), std::move( offsets ), std::move( indices ), std::move( values ) );
+}
+
+#endif
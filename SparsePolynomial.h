@@ -0,0 +1,544 @@
+#ifndef __INCL_SPARSEPOLYNOMIAL_H__
+#define __INCL_SPARSEPOLYNOMIAL_H__
+
+#include "Polynomial.h"
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <utility>
+#include <cstddef>
+#include <limits>
+#include <iostream>
+#include <exception>
+
+// A polynomial kept as its non-zero terms only, with exponents in strictly
+// increasing order alongside their coefficients, so that x^1000000 + 1
+// holds two terms. Products merge through a heap in O( t u log min( t, u ) )
+// for t and u terms; once t u exceeds DENSE_PRODUCT times the degree of the
+// result, products over exact coefficient types go through the dense product
+// instead, whose transforms cost O( n log n ) in the degree alone. Inexact
+// types always merge, since the rounding of a dense product would leave
+// spurious tiny terms where the true coefficient is zero. isDense() and
+// preferDense() tell which form holds a polynomial in less memory.
+
+template < class T >
+struct Term
+{
+	unsigned long long exponent;
+	T coefficient;
+};
+
+template < class T >
+class SparsePolynomial
+{
+public:
+	static const unsigned int DENSE_RATIO = 8;
+	static const unsigned int DENSE_PRODUCT = 8;
+
+	SparsePolynomial()
+		{}
+	SparsePolynomial( std::initializer_list< Term< T > > iList ) :
+		SparsePolynomial( iList.begin(), iList.end() )
+		{}
+	template < class InputIterator >
+		SparsePolynomial( InputIterator, InputIterator );
+	SparsePolynomial( std::vector< unsigned long long >, std::vector< T > );
+	explicit SparsePolynomial( const Polynomial< T >& );
+
+	std::size_t terms() const;
+	long long degree() const;
+	bool isDense() const;
+
+	const std::vector< unsigned long long >& exponents() const;
+	const std::vector< T >& coefficients() const;
+
+	T operator[] ( const unsigned long long ) const;
+	template < class U > U operator() ( const U& ) const;
+
+	Polynomial< T > toDense() const;
+
+	SparsePolynomial< T >& operator+= ( const SparsePolynomial< T >& );
+	SparsePolynomial< T >& operator-= ( const SparsePolynomial< T >& );
+	SparsePolynomial< T >& operator*= ( const SparsePolynomial< T >& );
+	SparsePolynomial< T >& operator*= ( const T& );
+
+	template < class U >
+		friend std::ostream& operator<< ( std::ostream&, const SparsePolynomial< U >& );
+	template < class U >
+		friend SparsePolynomial< U > operator+ ( const SparsePolynomial< U >&, const SparsePolynomial< U >& );
+	template < class U >
+		friend SparsePolynomial< U > operator- ( const SparsePolynomial< U >&, const SparsePolynomial< U >& );
+	template < class U >
+		friend SparsePolynomial< U > operator* ( const SparsePolynomial< U >&, const SparsePolynomial< U >& );
+
+private:
+	template < class U >
+		static U power( U, unsigned long long );
+
+	static SparsePolynomial< T > merge( const SparsePolynomial< T >&, const SparsePolynomial< T >&, const T& );
+	static SparsePolynomial< T > heapMultiply( const SparsePolynomial< T >&, const SparsePolynomial< T >& );
+
+	std::vector< unsigned long long > _exponents;
+	std::vector< T > _coefficients;
+};
+
+// Builds the polynomial from terms in any order. Coefficients given more
+// than once for the same exponent are summed, and zero terms dropped.
+template < class T >
+template < class InputIterator >
+SparsePolynomial< T >::SparsePolynomial( InputIterator first, InputIterator last )
+{
+	std::vector< Term< T > > sorted( first, last );
+	std::stable_sort( sorted.begin(), sorted.end(), []( const Term< T >& a, const Term< T >& b ) { return a.exponent < b.exponent; } );
+
+	for( std::size_t i = 0; i < sorted.size(); )
+	{
+		const unsigned long long exponent = sorted[i].exponent;
+		T sum( 0 );
+
+		for( ; i < sorted.size() && sorted[i].exponent == exponent; i++ )
+			sum += sorted[i].coefficient;
+
+		if( sum != T( 0 ) )
+		{
+			_exponents.push_back( exponent );
+			_coefficients.push_back( sum );
+		}
+	}
+}
+
+// Adopts arrays that are already in sparse form.
+template < class T >
+SparsePolynomial< T >::SparsePolynomial( std::vector< unsigned long long > exponents, std::vector< T > coefficients ) :
+	_exponents( std::move( exponents ) ),
+	_coefficients( std::move( coefficients ) )
+{
+	bool valid = _exponents.size() == _coefficients.size();
+
+	for( std::size_t i = 0; valid && i < _exponents.size(); i++ )
+		valid = _coefficients[i] != T( 0 ) && ( i == 0 || _exponents[ i - 1 ] < _exponents[i] );
+
+	if( !valid )
+	{
+		class SparseFormatException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Sparse terms must be non-zero with strictly increasing exponents.";
+			}
+		} ex;
+
+		throw ex;
+	}
+}
+
+template < class T >
+SparsePolynomial< T >::SparsePolynomial( const Polynomial< T >& dense )
+{
+	for( unsigned int i = 0; i < dense.length(); i++ )
+		if( dense[i] != T( 0 ) )
+		{
+			_exponents.push_back( i );
+			_coefficients.push_back( dense[i] );
+		}
+}
+
+template < class T >
+std::size_t SparsePolynomial< T >::terms() const
+{
+	return _exponents.size();
+}
+
+// -1 for the zero polynomial.
+template < class T >
+long long SparsePolynomial< T >::degree() const
+{
+	return _exponents.empty() ? -1 : (long long)_exponents.back();
+}
+
+// Whether at least 1 / DENSE_RATIO of the coefficients up to the degree are
+// non-zero, so that the dense form is the better one.
+template < class T >
+bool SparsePolynomial< T >::isDense() const
+{
+	return !_exponents.empty() && ( _exponents.back() + 1 ) / DENSE_RATIO < terms();
+}
+
+template < class T >
+const std::vector< unsigned long long >& SparsePolynomial< T >::exponents() const
+{
+	return _exponents;
+}
+
+template < class T >
+const std::vector< T >& SparsePolynomial< T >::coefficients() const
+{
+	return _coefficients;
+}
+
+template < class T >
+T SparsePolynomial< T >::operator[] ( const unsigned long long exponent ) const
+{
+	const auto it = std::lower_bound( _exponents.begin(), _exponents.end(), exponent );
+
+	if( it == _exponents.end() || *it != exponent )
+		return T( 0 );
+
+	return _coefficients[ it - _exponents.begin() ];
+}
+
+// Horner's rule over the terms, stepping across each gap in the exponents
+// by squaring: O( t log( degree / t ) ) multiplies for t terms.
+template < class T >
+template < class U >
+U SparsePolynomial< T >::operator() ( const U& param ) const
+{
+	if( _exponents.empty() )
+		return U( 0 );
+
+	U eval( _coefficients.back() );
+
+	for( std::size_t i = terms() - 1; i-- > 0; )
+		eval = eval * power( param, _exponents[ i + 1 ] - _exponents[i] ) + U( _coefficients[i] );
+
+	return eval * power( param, _exponents[0] );
+}
+
+template < class T >
+Polynomial< T > SparsePolynomial< T >::toDense() const
+{
+	Polynomial< T > dense;
+	dense.truncate( degree() + 1 );
+
+	for( std::size_t i = 0; i < terms(); i++ )
+		dense[ _exponents[i] ] = _coefficients[i];
+
+	return dense;
+}
+
+template < class T >
+SparsePolynomial< T >& SparsePolynomial< T >::operator+= ( const SparsePolynomial< T >& rhPolynomial )
+{
+	return *this = *this + rhPolynomial;
+}
+
+template < class T >
+SparsePolynomial< T >& SparsePolynomial< T >::operator-= ( const SparsePolynomial< T >& rhPolynomial )
+{
+	return *this = *this - rhPolynomial;
+}
+
+template < class T >
+SparsePolynomial< T >& SparsePolynomial< T >::operator*= ( const SparsePolynomial< T >& rhPolynomial )
+{
+	return *this = *this * rhPolynomial;
+}
+
+template < class T >
+SparsePolynomial< T >& SparsePolynomial< T >::operator*= ( const T& scalar )
+{
+	if( scalar == T( 0 ) )
+	{
+		_exponents.clear();
+		_coefficients.clear();
+	}
+	else
+		for( T& coefficient : _coefficients )
+			coefficient *= scalar;
+
+	return *this;
+}
+
+template < class U >
+std::ostream& operator<< ( std::ostream& out, const SparsePolynomial< U >& cPolynomial )
+{
+	if( !cPolynomial.terms() )
+		return out << 0;
+
+	for( std::size_t i = cPolynomial.terms(); i-- > 0; )
+	{
+		const U& coefficient = cPolynomial._coefficients[i];
+		const unsigned long long exponent = cPolynomial._exponents[i];
+
+		if( i + 1 == cPolynomial.terms() )
+		{
+			if( coefficient == U( -1 ) && exponent )
+				out << '-';
+			else if( coefficient != U( 1 ) || !exponent )
+				out << coefficient << ( exponent ? " " : "" );
+		}
+		else
+		{
+			const bool negative = coefficient < U( 0 );
+			const U magnitude = negative ? -coefficient : coefficient;
+
+			out << ( negative ? " - " : " + " );
+			if( magnitude != U( 1 ) || !exponent )
+				out << magnitude << ( exponent ? " " : "" );
+		}
+
+		if( exponent )
+		{
+			out << 'x';
+			if( exponent > 1 )
+				out << '^' << exponent;
+		}
+	}
+
+	return out;
+}
+
+template < class T >
+template < class U >
+U SparsePolynomial< T >::power( U base, unsigned long long exponent )
+{
+	U result( 1 );
+
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result = result * base;
+
+		exponent >>= 1;
+		if( exponent )
+			base = base * base;
+	}
+
+	return result;
+}
+
+// Free functions
+
+template < class T >
+bool operator== ( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	return lhPolynomial.exponents() == rhPolynomial.exponents() && lhPolynomial.coefficients() == rhPolynomial.coefficients();
+}
+
+template < class T >
+bool operator!= ( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	return !( lhPolynomial == rhPolynomial );
+}
+
+// Merges the two term lists, scaling the right-hand one by sign.
+template < class T >
+SparsePolynomial< T > SparsePolynomial< T >::merge( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial, const T& sign )
+{
+	const std::vector< unsigned long long >& a = lhPolynomial.exponents(), & b = rhPolynomial.exponents();
+	const std::vector< T >& x = lhPolynomial.coefficients(), & y = rhPolynomial.coefficients();
+
+	std::vector< unsigned long long > exponents;
+	std::vector< T > coefficients;
+	exponents.reserve( a.size() + b.size() );
+	coefficients.reserve( a.size() + b.size() );
+
+	std::size_t i = 0, j = 0;
+	while( i < a.size() || j < b.size() )
+	{
+		if( j == b.size() || ( i < a.size() && a[i] < b[j] ) )
+		{
+			exponents.push_back( a[i] );
+			coefficients.push_back( x[ i++ ] );
+		}
+		else if( i == a.size() || b[j] < a[i] )
+		{
+			exponents.push_back( b[j] );
+			coefficients.push_back( sign * y[ j++ ] );
+		}
+		else
+		{
+			const T sum = x[ i++ ] + sign * y[j];
+			if( sum != T( 0 ) )
+			{
+				exponents.push_back( b[j] );
+				coefficients.push_back( sum );
+			}
+			j++;
+		}
+	}
+
+	return SparsePolynomial< T >( std::move( exponents ), std::move( coefficients ) );
+}
+
+template < class T >
+SparsePolynomial< T > operator+ ( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	return SparsePolynomial< T >::merge( lhPolynomial, rhPolynomial, T( 1 ) );
+}
+
+template < class T >
+SparsePolynomial< T > operator- ( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	return SparsePolynomial< T >::merge( lhPolynomial, rhPolynomial, T( -1 ) );
+}
+
+// Johnson's heap product. The heap holds at most one pending product per
+// term of the shorter operand: term i of it is paired with term j of the
+// other, and popping ( i, j ) admits ( i, j + 1 ), and ( i + 1, 0 ) when
+// j = 0. Products leave the heap in increasing exponent order, so the
+// result is built already sorted, summing equal exponents as they meet.
+template < class T >
+SparsePolynomial< T > SparsePolynomial< T >::heapMultiply( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	const bool swap = lhPolynomial.terms() > rhPolynomial.terms();
+	const SparsePolynomial< T >& a = swap ? rhPolynomial : lhPolynomial;
+	const SparsePolynomial< T >& b = swap ? lhPolynomial : rhPolynomial;
+
+	struct Entry
+	{
+		unsigned long long exponent;
+		std::size_t i, j;
+
+		bool operator< ( const Entry& other ) const
+		{
+			return exponent > other.exponent;
+		}
+	};
+
+	std::vector< Entry > heap;
+	heap.reserve( a.terms() );
+	heap.push_back( Entry{ a.exponents()[0] + b.exponents()[0], 0, 0 } );
+
+	std::vector< unsigned long long > exponents;
+	std::vector< T > coefficients;
+
+	while( !heap.empty() )
+	{
+		const unsigned long long exponent = heap.front().exponent;
+		T sum( 0 );
+
+		while( !heap.empty() && heap.front().exponent == exponent )
+		{
+			std::pop_heap( heap.begin(), heap.end() );
+			const Entry top = heap.back();
+			heap.pop_back();
+
+			sum += a.coefficients()[ top.i ] * b.coefficients()[ top.j ];
+
+			if( top.j == 0 && top.i + 1 < a.terms() )
+			{
+				heap.push_back( Entry{ a.exponents()[ top.i + 1 ] + b.exponents()[0], top.i + 1, 0 } );
+				std::push_heap( heap.begin(), heap.end() );
+			}
+
+			if( top.j + 1 < b.terms() )
+			{
+				heap.push_back( Entry{ a.exponents()[ top.i ] + b.exponents()[ top.j + 1 ], top.i, top.j + 1 } );
+				std::push_heap( heap.begin(), heap.end() );
+			}
+		}
+
+		if( sum != T( 0 ) )
+		{
+			exponents.push_back( exponent );
+			coefficients.push_back( sum );
+		}
+	}
+
+	return SparsePolynomial< T >( std::move( exponents ), std::move( coefficients ) );
+}
+
+template < class T >
+SparsePolynomial< T > operator* ( const SparsePolynomial< T >& lhPolynomial, const SparsePolynomial< T >& rhPolynomial )
+{
+	if( !lhPolynomial.terms() || !rhPolynomial.terms() )
+		return SparsePolynomial< T >();
+
+	if( (unsigned long long)lhPolynomial.degree() > std::numeric_limits< unsigned long long >::max() - rhPolynomial.degree() )
+	{
+		class ExponentOverflowException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "The degree of the product does not fit in the exponent type.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const unsigned long long degree = lhPolynomial.degree() + rhPolynomial.degree();
+	const double products = (double)lhPolynomial.terms() * rhPolynomial.terms();
+
+	if( std::numeric_limits< T >::is_exact &&
+		degree < std::numeric_limits< unsigned int >::max() && products > (double)SparsePolynomial< T >::DENSE_PRODUCT * ( degree + 1 ) )
+		return SparsePolynomial< T >( lhPolynomial.toDense() * rhPolynomial.toDense() );
+
+	return SparsePolynomial< T >::heapMultiply( lhPolynomial, rhPolynomial );
+}
+
+template < class T >
+SparsePolynomial< T > operator* ( SparsePolynomial< T > cPolynomial, const T& scalar )
+{
+	return cPolynomial *= scalar;
+}
+
+template < class T >
+SparsePolynomial< T > operator* ( const T& scalar, SparsePolynomial< T > cPolynomial )
+{
+	return cPolynomial *= scalar;
+}
+
+template < class T >
+SparsePolynomial< T > pow( const SparsePolynomial< T >& cPolynomial, unsigned long long exponent )
+{
+	SparsePolynomial< T > result{ Term< T >{ 0, T( 1 ) } };
+	SparsePolynomial< T > base( cPolynomial );
+
+	while( exponent )
+	{
+		if( exponent & 1 )
+			result *= base;
+
+		exponent >>= 1;
+		if( exponent )
+			base = base * base;
+	}
+
+	return result;
+}
+
+template < class T >
+SparsePolynomial< T > derivative( const SparsePolynomial< T >& cPolynomial, unsigned int iter = 1 )
+{
+	std::vector< unsigned long long > exponents;
+	std::vector< T > coefficients;
+
+	for( std::size_t i = 0; i < cPolynomial.terms(); i++ )
+	{
+		const unsigned long long exponent = cPolynomial.exponents()[i];
+		const T coefficient = cPolynomial.coefficients()[i] * T( exponent );
+
+		if( exponent && coefficient != T( 0 ) )
+		{
+			exponents.push_back( exponent - 1 );
+			coefficients.push_back( coefficient );
+		}
+	}
+
+	SparsePolynomial< T > result( std::move( exponents ), std::move( coefficients ) );
+
+	if( iter <= 1 )
+		return result;
+	else
+		return derivative( result, iter - 1 );
+}
+
+// Whether cPolynomial is better kept dense, by the same measure as
+// SparsePolynomial::isDense().
+template < class T >
+bool preferDense( const Polynomial< T >& cPolynomial )
+{
+	std::size_t nonZeros = 0;
+	for( unsigned int i = 0; i < cPolynomial.length(); i++ )
+		if( cPolynomial[i] != T( 0 ) )
+			nonZeros++;
+
+	return cPolynomial.length() / SparsePolynomial< T >::DENSE_RATIO < nonZeros;
+}
+
+#endif
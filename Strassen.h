@@ -0,0 +1,227 @@
+#ifndef __INCL_STRASSEN_H__
+#define __INCL_STRASSEN_H__
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Gemm.h"
+#include "ThreadPool.h"
+#include "AlignedAllocator.h"
+#include "Integer.h"
+
+// Strassen-Winograd multiplication: each level splits the operands into
+// quadrants and forms the product from 7 products of quadrants and 15
+// quadrant additions instead of 8 products, recursing until a dimension
+// falls below CROSSOVER, where gemm takes over. Odd dimensions are peeled:
+// the even part recurses and the last row, column or inner index is added
+// back with thin gemm calls.
+//
+// The additions are scheduled as by Boyer, Dumas, Pernet and Zhou so that
+// a level needs only two temporaries beside the quadrants of C, and the
+// temporaries of every level are carved out of a single workspace
+// allocated up front.
+//
+// Matrix multiplication takes this path by itself for the built-in integer
+// types, whose products it leaves exact. Their quadrant sums can overflow
+// even when the product fits, so the whole recursion runs on
+// WrappingInteger< T >::type, the unsigned type their arithmetic is
+// promoted to, where overflow wraps without undefined behaviour and cancels
+// in the result, which is read back as the classical product wrapped to T.
+// Types of that width are reinterpreted in place; narrower ones, whose
+// unsigned type would itself promote to int, are copied to it and back.
+// Floating point products differ from the classical ones by a larger
+// rounding error, growing with the depth of recursion, so for them it is
+// asked for through strassenMultiply.
+
+template < class T >
+class Strassen
+{
+	typedef typename WrappingInteger< T >::type Word;
+
+public:
+	static const unsigned int CROSSOVER = GemmTraits< Word >::packed ? 512 : 128;
+
+	static bool preferred( const unsigned int, const unsigned int, const unsigned int );
+	static std::size_t workspace( const unsigned int, const unsigned int, const unsigned int );
+
+	static void multiply( const unsigned int, const unsigned int, const unsigned int,
+						  const T*, const unsigned int, const T*, const unsigned int,
+						  T*, const unsigned int, const ExecutionPolicy& = ExecutionPolicy() );
+
+private:
+	static void recurse( const unsigned int, const unsigned int, const unsigned int,
+						 const Word*, const unsigned int, const Word*, const unsigned int,
+						 Word*, const unsigned int, Word*, const ExecutionPolicy& );
+
+	static void add( const unsigned int, const unsigned int, const Word*, const unsigned int, const Word*, const unsigned int, Word*, const unsigned int );
+	static void subtract( const unsigned int, const unsigned int, const Word*, const unsigned int, const Word*, const unsigned int, Word*, const unsigned int );
+	static void zero( const unsigned int, const unsigned int, Word*, const unsigned int );
+};
+
+template < class T >
+bool Strassen< T >::preferred( const unsigned int m, const unsigned int n, const unsigned int k )
+{
+	return std::is_integral< T >::value && !std::is_same< T, bool >::value && std::min( m, std::min( n, k ) ) >= CROSSOVER;
+}
+
+// The elements of workspace needed to multiply an m x k by a k x n matrix:
+// at each level, an m / 2 x max( k / 2, n / 2 ) temporary and a
+// k / 2 x n / 2 one.
+template < class T >
+std::size_t Strassen< T >::workspace( const unsigned int m, const unsigned int n, const unsigned int k )
+{
+	if( std::min( m, std::min( n, k ) ) < CROSSOVER )
+		return 0;
+
+	const std::size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+
+	return m2 * std::max( k2, n2 ) + k2 * n2 + workspace( m2, n2, k2 );
+}
+
+// C = A * B, where A is m x k, B is k x n and C is m x n, all stored
+// row-major with leading dimensions lda, ldb and ldc.
+template < class T >
+void Strassen< T >::multiply( const unsigned int m, const unsigned int n, const unsigned int k,
+							  const T* a, const unsigned int lda, const T* b, const unsigned int ldb,
+							  T* c, const unsigned int ldc, const ExecutionPolicy& policy )
+{
+	std::vector< Word, AlignedAllocator< Word > > scratch( workspace( m, n, k ) );
+
+	if( sizeof( Word ) == sizeof( T ) )
+	{
+		recurse( m, n, k, reinterpret_cast< const Word* >( a ), lda, reinterpret_cast< const Word* >( b ), ldb,
+				 reinterpret_cast< Word* >( c ), ldc, scratch.data(), policy );
+		return;
+	}
+
+	std::vector< Word, AlignedAllocator< Word > > wa( (std::size_t)m * k ), wb( (std::size_t)k * n ), wc( (std::size_t)m * n );
+
+	for( unsigned int i = 0; i < m; i++ )
+		std::copy( a + (std::size_t)i * lda, a + (std::size_t)i * lda + k, wa.begin() + (std::size_t)i * k );
+	for( unsigned int i = 0; i < k; i++ )
+		std::copy( b + (std::size_t)i * ldb, b + (std::size_t)i * ldb + n, wb.begin() + (std::size_t)i * n );
+
+	recurse( m, n, k, wa.data(), k, wb.data(), n, wc.data(), n, scratch.data(), policy );
+
+	for( unsigned int i = 0; i < m; i++ )
+		for( unsigned int j = 0; j < n; j++ )
+			c[ (std::size_t)i * ldc + j ] = static_cast< T >( wc[ (std::size_t)i * n + j ] );
+}
+
+template < class T >
+void Strassen< T >::recurse( const unsigned int m, const unsigned int n, const unsigned int k,
+							 const Word* a, const unsigned int lda, const Word* b, const unsigned int ldb,
+							 Word* c, const unsigned int ldc, Word* work, const ExecutionPolicy& policy )
+{
+	if( std::min( m, std::min( n, k ) ) < CROSSOVER )
+	{
+		zero( m, n, c, ldc );
+		gemm( m, n, k, a, lda, b, ldb, c, ldc, policy );
+		return;
+	}
+
+	const unsigned int m2 = m / 2, n2 = n / 2, k2 = k / 2;
+	const unsigned int ldx = std::max( k2, n2 );
+
+	const Word* a11 = a;
+	const Word* a12 = a + k2;
+	const Word* a21 = a + (std::size_t)m2 * lda;
+	const Word* a22 = a21 + k2;
+	const Word* b11 = b;
+	const Word* b12 = b + n2;
+	const Word* b21 = b + (std::size_t)k2 * ldb;
+	const Word* b22 = b21 + n2;
+	Word* c11 = c;
+	Word* c12 = c + n2;
+	Word* c21 = c + (std::size_t)m2 * ldc;
+	Word* c22 = c21 + n2;
+
+	Word* x = work;
+	Word* y = x + (std::size_t)m2 * ldx;
+	Word* next = y + (std::size_t)k2 * n2;
+
+	subtract( m2, k2, a11, lda, a21, lda, x, k2 );			// S3
+	subtract( k2, n2, b22, ldb, b12, ldb, y, n2 );			// T3
+	recurse( m2, n2, k2, x, k2, y, n2, c21, ldc, next, policy );	// P7
+	add( m2, k2, a21, lda, a22, lda, x, k2 );				// S1
+	subtract( k2, n2, b12, ldb, b11, ldb, y, n2 );			// T1
+	recurse( m2, n2, k2, x, k2, y, n2, c22, ldc, next, policy );	// P5
+	subtract( m2, k2, x, k2, a11, lda, x, k2 );				// S2 = S1 - A11
+	subtract( k2, n2, b22, ldb, y, n2, y, n2 );				// T2 = B22 - T1
+	recurse( m2, n2, k2, x, k2, y, n2, c12, ldc, next, policy );	// P6
+	subtract( m2, k2, a12, lda, x, k2, x, k2 );				// S4 = A12 - S2
+	subtract( k2, n2, y, n2, b21, ldb, y, n2 );				// T4 = T2 - B21
+	recurse( m2, n2, k2, x, k2, b22, ldb, c11, ldc, next, policy );	// P3
+	recurse( m2, n2, k2, a11, lda, b11, ldb, x, n2, next, policy );	// P1
+	add( m2, n2, x, n2, c12, ldc, c12, ldc );				// U2 = P1 + P6
+	add( m2, n2, c12, ldc, c21, ldc, c21, ldc );			// U3 = U2 + P7
+	add( m2, n2, c12, ldc, c22, ldc, c12, ldc );			// U4 = U2 + P5
+	add( m2, n2, c21, ldc, c22, ldc, c22, ldc );			// U7 = U3 + P5
+	add( m2, n2, c12, ldc, c11, ldc, c12, ldc );			// U5 = U4 + P3
+	recurse( m2, n2, k2, a22, lda, y, n2, c11, ldc, next, policy );	// P4
+	subtract( m2, n2, c21, ldc, c11, ldc, c21, ldc );		// U6 = U3 - P4
+	recurse( m2, n2, k2, a12, lda, b21, ldb, c11, ldc, next, policy );	// P2
+	add( m2, n2, c11, ldc, x, n2, c11, ldc );				// U1 = P1 + P2
+
+	// Peeling: the even part above left out the last inner index when k is
+	// odd, and the last column and row of C when n or m is.
+	const unsigned int me = 2 * m2, ne = 2 * n2, ke = 2 * k2;
+
+	if( ke < k )
+		gemm( me, ne, 1u, a + ke, lda, b + (std::size_t)ke * ldb, ldb, c, ldc, policy );
+
+	if( ne < n )
+	{
+		zero( me, 1u, c + ne, ldc );
+		gemm( me, 1u, k, a, lda, b + ne, ldb, c + ne, ldc, policy );
+	}
+
+	if( me < m )
+	{
+		zero( 1u, n, c + (std::size_t)me * ldc, ldc );
+		gemm( 1u, n, k, a + (std::size_t)me * lda, lda, b, ldb, c + (std::size_t)me * ldc, ldc, policy );
+	}
+}
+
+// out = lhs + rhs over an m x n block; out may be either operand.
+template < class T >
+void Strassen< T >::add( const unsigned int m, const unsigned int n,
+						 const Word* lhs, const unsigned int ldl, const Word* rhs, const unsigned int ldr,
+						 Word* out, const unsigned int ldo )
+{
+	for( unsigned int i = 0; i < m; i++ )
+	{
+		const Word* l = lhs + (std::size_t)i * ldl;
+		const Word* r = rhs + (std::size_t)i * ldr;
+		Word* o = out + (std::size_t)i * ldo;
+
+		for( unsigned int j = 0; j < n; j++ )
+			o[j] = l[j] + r[j];
+	}
+}
+
+template < class T >
+void Strassen< T >::subtract( const unsigned int m, const unsigned int n,
+							  const Word* lhs, const unsigned int ldl, const Word* rhs, const unsigned int ldr,
+							  Word* out, const unsigned int ldo )
+{
+	for( unsigned int i = 0; i < m; i++ )
+	{
+		const Word* l = lhs + (std::size_t)i * ldl;
+		const Word* r = rhs + (std::size_t)i * ldr;
+		Word* o = out + (std::size_t)i * ldo;
+
+		for( unsigned int j = 0; j < n; j++ )
+			o[j] = l[j] - r[j];
+	}
+}
+
+template < class T >
+void Strassen< T >::zero( const unsigned int m, const unsigned int n, Word* out, const unsigned int ldo )
+{
+	for( unsigned int i = 0; i < m; i++ )
+		std::fill( out + (std::size_t)i * ldo, out + (std::size_t)i * ldo + n, Word( 0 ) );
+}
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef __INCL_SUBPRODUCTTREE_H__
+#define __INCL_SUBPRODUCTTREE_H__
+
+#include "Polynomial.h"
+#include "Evaluation.h"
+#include "Convolution.h"
+#include "ThreadPool.h"
+#include "Integer.h"
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+// SubproductTree< T > evaluates polynomials at a fixed set of n points in
+// O( M( n ) log n ) operations, with M( n ) the cost of a product, instead
+// of the O( n^2 ) of evaluating point by point.
+//
+// The points are split into leaves of at most LEAF points, and every node
+// of the complete binary tree above them holds the product of ( x - p )
+// over the points below it. A polynomial is reduced modulo the root, and
+// each remainder modulo the products of the two children, down to the
+// leaves, where the remainders have degree below LEAF and are evaluated
+// with Horner's rule. The remainders are taken by Newton division against
+// the reversed node products, whose inverses are computed once when the
+// tree is built, so a tree is worth keeping to evaluate many polynomials at
+// the same points.
+//
+// The node products are monic, so only additions and multiplications are
+// involved and the results are those of Horner's rule in any coefficient
+// ring, the integers modulo 2^k included. Their coefficients overflow an
+// integral T long before the values do, so the tree is built and reduced
+// in WrappingInteger< T >::type, where they wrap, and the values are
+// converted back to T: for every integral T they are those of Horner's rule
+// wrapped to T. Over floating point the intermediate coefficients grow
+// with the spread of the points and the results can lose all accuracy for
+// large trees; there, evaluate() keeps to Horner's rule, and the tree
+// should only be used with care.
+
+template < class T >
+class SubproductTree
+{
+	typedef typename WrappingInteger< T >::type Word;
+
+public:
+	static const std::size_t LEAF = 64;
+	static const std::size_t THRESHOLD = 8192;
+
+	SubproductTree( const T*, const std::size_t, const ExecutionPolicy& = ExecutionPolicy() );
+	explicit SubproductTree( const Vector< T >&, const ExecutionPolicy& = ExecutionPolicy() );
+
+	std::size_t size() const;
+	Polynomial< T > product() const;
+
+	void evaluate( const Polynomial< T >&, T*, const ExecutionPolicy& = ExecutionPolicy() ) const;
+	Vector< T > evaluate( const Polynomial< T >&, const ExecutionPolicy& = ExecutionPolicy() ) const;
+
+private:
+	void build( const ExecutionPolicy& );
+	std::size_t first( const std::size_t ) const;
+	std::size_t last( const std::size_t ) const;
+
+	static Polynomial< Word > remainder( const Polynomial< Word >&, const Polynomial< Word >&, const Polynomial< Word >& );
+
+	template < class Function >
+		static void forEach( const std::size_t, const std::size_t, const unsigned long, const ExecutionPolicy&, Function );
+
+	std::vector< Word > _points;
+	std::size_t _leaves;
+
+	// Node v has children 2v and 2v + 1; the root is node 1 and the leaves
+	// are nodes _leaves to 2 * _leaves - 1.
+	std::vector< Polynomial< Word > > _products;
+	std::vector< Polynomial< Word > > _inverses;
+};
+
+template < class T >
+SubproductTree< T >::SubproductTree( const T* points, const std::size_t count, const ExecutionPolicy& policy ) :
+	_points( points, points + count ),
+	_leaves( 1 )
+{
+	build( policy );
+}
+
+template < class T >
+SubproductTree< T >::SubproductTree( const Vector< T >& points, const ExecutionPolicy& policy ) :
+	_points( points.cbegin(), points.cend() ),
+	_leaves( 1 )
+{
+	build( policy );
+}
+
+template < class T >
+std::size_t SubproductTree< T >::size() const
+{
+	return _points.size();
+}
+
+// The product of ( x - p ) over every point p.
+template < class T >
+Polynomial< T > SubproductTree< T >::product() const
+{
+	return Polynomial< T >( _products[1].cbegin(), _products[1].cend() );
+}
+
+template < class T >
+void SubproductTree< T >::evaluate( const Polynomial< T >& cPolynomial, T* out, const ExecutionPolicy& policy ) const
+{
+	if( _points.empty() )
+		return;
+
+	const Polynomial< Word > polynomial( cPolynomial.cbegin(), cPolynomial.cend() );
+	std::vector< Polynomial< Word > > level( 1, remainder( polynomial, _products[1], Polynomial< Word >() ) ), next;
+	std::vector< Word > values( size() );
+
+	for( std::size_t width = 2; width <= _leaves; width *= 2 )
+	{
+		next.assign( width, Polynomial< Word >() );
+
+		forEach( width, width * 2, (unsigned long)size() * LEAF, policy, [&]( std::size_t v )
+		{
+			next[ v - width ] = remainder( level[ ( v - width ) / 2 ], _products[v], _inverses[v] );
+		} );
+
+		level.swap( next );
+	}
+
+	forEach( _leaves, 2 * _leaves, (unsigned long)size() * LEAF, policy, [&]( std::size_t v )
+	{
+		const Polynomial< Word >& r = level[ v - _leaves ];
+		EvaluationKernels< Word >::horner( r.data(), r.length(), _points.data() + first( v ), last( v ) - first( v ), values.data() + first( v ) );
+	} );
+
+	for( std::size_t i = 0; i < size(); i++ )
+		out[i] = static_cast< T >( values[i] );
+}
+
+template < class T >
+Vector< T > SubproductTree< T >::evaluate( const Polynomial< T >& cPolynomial, const ExecutionPolicy& policy ) const
+{
+	Vector< T > values( size() );
+	evaluate( cPolynomial, values.data(), policy );
+
+	return values;
+}
+
+// Builds the node products bottom up, one level at a time, then the
+// inverses each node will need to reduce its parent's remainder.
+template < class T >
+void SubproductTree< T >::build( const ExecutionPolicy& policy )
+{
+	while( _leaves * LEAF < _points.size() )
+		_leaves *= 2;
+
+	_products.assign( 2 * _leaves, Polynomial< Word >() );
+	_inverses.assign( 2 * _leaves, Polynomial< Word >() );
+
+	if( _points.empty() )
+	{
+		_products[1] = Polynomial< Word >{ Word( 1 ) };
+		return;
+	}
+
+	forEach( _leaves, 2 * _leaves, (unsigned long)size() * LEAF, policy, [&]( std::size_t v )
+	{
+		Polynomial< Word >& p = _products[v];
+		p.truncate( last( v ) - first( v ) + 1 );
+		p[0] = Word( 1 );
+
+		for( std::size_t i = first( v ), degree = 0; i < last( v ); i++, degree++ )
+		{
+			p[ degree + 1 ] = p[ degree ];
+			for( std::size_t k = degree; k > 0; k-- )
+				p[k] = p[ k - 1 ] - _points[i] * p[k];
+			p[0] = -_points[i] * p[0];
+		}
+	} );
+
+	for( std::size_t width = _leaves / 2; width >= 1; width /= 2 )
+		forEach( width, 2 * width, (unsigned long)size() * LEAF, policy, [&]( std::size_t v )
+		{
+			_products[v] = _products[ 2 * v ] * _products[ 2 * v + 1 ];
+		} );
+
+	forEach( 2, 2 * _leaves, (unsigned long)size() * LEAF, policy, [&]( std::size_t v )
+	{
+		const std::size_t degree = _products[v].degree();
+		const std::size_t quotient = _products[ v / 2 ].degree() - degree;
+
+		if( std::min( degree, quotient ) >= Convolution< Word >::KARATSUBA )
+			_inverses[v] = inverseSeries( reverse( _products[v] ), quotient );
+	} );
+}
+
+// Leaf v holds the points [ first( v ), last( v ) ), spread evenly.
+template < class T >
+std::size_t SubproductTree< T >::first( const std::size_t v ) const
+{
+	return _points.size() * ( v - _leaves ) / _leaves;
+}
+
+template < class T >
+std::size_t SubproductTree< T >::last( const std::size_t v ) const
+{
+	return _points.size() * ( v - _leaves + 1 ) / _leaves;
+}
+
+// The remainder of a by the monic polynomial b. With inverse holding at
+// least length( a ) - degree( b ) terms of 1 / reverse( b ), the quotient
+// comes from one truncated product of the reversed dividend; short
+// quotients or divisors take plain long division, and the inverse is
+// computed here when it was not supplied.
+template < class T >
+Polynomial< typename SubproductTree< T >::Word > SubproductTree< T >::remainder( const Polynomial< Word >& a, const Polynomial< Word >& b,
+																				const Polynomial< Word >& inverse )
+{
+	const std::size_t m = b.degree();
+
+	if( a.length() <= m )
+	{
+		Polynomial< Word > r( a );
+		return r.truncate( m );
+	}
+
+	const std::size_t k = a.length() - m;
+
+	if( std::min( k, m ) < Convolution< Word >::KARATSUBA )
+	{
+		Polynomial< Word > r( a );
+
+		for( std::size_t i = a.length(); i-- > m; )
+			if( r[i] != Word( 0 ) )
+				VectorKernels< Word >::axpy( r.data() + i - m, -r[i], b.data(), m );
+
+		return r.truncate( m );
+	}
+
+	const Polynomial< Word > quotient = ( inverse.length() >= k ) ? Polynomial< Word >::newtonQuotient( a, b, inverse )
+																  : Polynomial< Word >::newtonQuotient( a, b, inverseSeries( reverse( b ), k ) );
+	const Polynomial< Word > multiple = quotient * b;
+	Polynomial< Word > r( a.cbegin(), a.cbegin() + m );
+	VectorKernels< Word >::subtract( r.data(), multiple.data(), m );
+
+	return r;
+}
+
+// Calls function( v ) for every v in [ begin, end ), over the pool when the
+// policy allows for the given amount of work.
+template < class T >
+template < class Function >
+void SubproductTree< T >::forEach( const std::size_t begin, const std::size_t end, const unsigned long work,
+								   const ExecutionPolicy& policy, Function function )
+{
+	if( end - begin > 1 && policy.parallel( work ) )
+		policy.pool().parallelFor( begin, end, [&]( std::size_t first, std::size_t last )
+		{
+			for( std::size_t v = first; v < last; v++ )
+				function( v );
+		} );
+	else
+		for( std::size_t v = begin; v < end; v++ )
+			function( v );
+}
+
+#endif
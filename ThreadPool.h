@@ -0,0 +1,193 @@
+#ifndef __INCL_THREADPOOL_H__
+#define __INCL_THREADPOOL_H__
+
+#include <vector>
+#include <cstddef>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+// A fixed set of worker threads. The thread calling parallelFor takes part
+// in the work, so a pool of size n runs n - 1 workers. parallelFor must not
+// be called from inside a task running on the same pool.
+
+class ThreadPool
+{
+public:
+	explicit ThreadPool( unsigned int numThreads = std::thread::hardware_concurrency() );
+	ThreadPool( const ThreadPool& ) = delete;
+	~ThreadPool();
+
+	ThreadPool& operator= ( const ThreadPool& ) = delete;
+
+	unsigned int size() const;
+
+	template < class Function >
+		void parallelFor( std::size_t, std::size_t, Function );
+
+private:
+	void run();
+
+	std::vector< std::thread > _workers;
+	std::deque< std::function< void() > > _tasks;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stopping;
+};
+
+// Describes how an operation may run. A default-constructed policy is
+// serial; one built from a pool parallelizes any operation whose work, in
+// scalar multiply-adds, reaches the threshold.
+
+class ExecutionPolicy
+{
+public:
+	static const unsigned long defaultThreshold = 1ul << 16;
+
+	ExecutionPolicy() :
+		_pool( nullptr ),
+		_threshold( 0 )
+		{}
+	ExecutionPolicy( ThreadPool& pool, unsigned long threshold = defaultThreshold ) :
+		_pool( &pool ),
+		_threshold( threshold )
+		{}
+
+	bool parallel( unsigned long ) const;
+	ThreadPool& pool() const;
+
+private:
+	ThreadPool* _pool;
+	unsigned long _threshold;
+};
+
+inline ThreadPool::ThreadPool( unsigned int numThreads ) :
+	_stopping( false )
+{
+	for( unsigned int i = 1; i < numThreads; i++ )
+		_workers.emplace_back( &ThreadPool::run, this );
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_stopping = true;
+	}
+	_condition.notify_all();
+
+	for( auto& worker : _workers )
+		worker.join();
+}
+
+inline unsigned int ThreadPool::size() const
+{
+	return _workers.size() + 1;
+}
+
+inline void ThreadPool::run()
+{
+	for( ;; )
+	{
+		std::function< void() > task;
+
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+			_condition.wait( lock, [this] { return _stopping || !_tasks.empty(); } );
+
+			if( _tasks.empty() )
+				return;
+
+			task = std::move( _tasks.front() );
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+// Calls function( first, last ) over disjoint chunks covering [begin, end)
+// and returns once every chunk is done; first and last are std::size_t, so
+// ranges of any length reach the function intact. The first exception
+// thrown by any chunk is rethrown here.
+template < class Function >
+void ThreadPool::parallelFor( std::size_t begin, std::size_t end, Function function )
+{
+	if( end <= begin )
+		return;
+
+	const std::size_t count = end - begin;
+	const unsigned int chunks = (unsigned int)std::min< std::size_t >( count, size() * 4 );
+	const unsigned int helpers = std::min< unsigned int >( _workers.size(), chunks - 1 );
+
+	// Chunk i starts at begin + i * quotient + min( i, remainder ), so the
+	// first remainder chunks are one longer.
+	const std::size_t quotient = count / chunks, remainder = count % chunks;
+	auto start = [&]( unsigned int chunk )
+	{
+		return begin + chunk * quotient + std::min< std::size_t >( chunk, remainder );
+	};
+
+	std::atomic< unsigned int > next( 0 );
+	std::exception_ptr error;
+	std::mutex doneMutex;
+	std::condition_variable done;
+	unsigned int pending = helpers;
+
+	auto work = [&]()
+	{
+		for( unsigned int chunk = next++; chunk < chunks; chunk = next++ )
+		{
+			try
+			{
+				function( start( chunk ), start( chunk + 1 ) );
+			}
+			catch( ... )
+			{
+				std::lock_guard< std::mutex > lock( doneMutex );
+				if( !error )
+					error = std::current_exception();
+			}
+		}
+	};
+
+	if( helpers )
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		for( unsigned int i = 0; i < helpers; i++ )
+			_tasks.emplace_back( [&]()
+			{
+				work();
+
+				std::lock_guard< std::mutex > doneLock( doneMutex );
+				if( --pending == 0 )
+					done.notify_one();
+			} );
+	}
+	_condition.notify_all();
+
+	work();
+
+	std::unique_lock< std::mutex > lock( doneMutex );
+	done.wait( lock, [&] { return pending == 0; } );
+
+	if( error )
+		std::rethrow_exception( error );
+}
+
+inline bool ExecutionPolicy::parallel( unsigned long work ) const
+{
+	return _pool && _pool->size() > 1 && work >= _threshold;
+}
+
+inline ThreadPool& ExecutionPolicy::pool() const
+{
+	return *_pool;
+}
+
+#endif
@@ -0,0 +1,645 @@
+#ifndef __INCL_TILEDMATRIX_H__
+#define __INCL_TILEDMATRIX_H__
+
+#include "MatrixFile.h"
+#include "Gemm.h"
+#include "Transpose.h"
+#include "ThreadPool.h"
+#include "AlignedAllocator.h"
+#include "Instrumentation.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <exception>
+
+// A matrix kept on disk rather than in memory, for operands larger than
+// RAM. The backing file is a FILE_TILED matrix file (see MatrixFile.h):
+// square tiles of tileSize() x tileSize() elements, each contiguous, so a
+// tile moves between disk and memory in a single read or write. Tiles are
+// read and written whole through readTile() and writeTile(); the edge
+// tiles hold zeros past the last row and column.
+//
+// multiply and transpose stream the tiles of their operands through memory
+// while a background thread reads ahead the tiles the next step needs, so
+// that the disk and the arithmetic overlap:
+//
+//   - multiply keeps a block of p x q tiles of the product in memory and
+//     sweeps the matching p tiles of the left operand and q tiles of the
+//     right across the inner dimension, two sets of each so that one is
+//     read while the other is used. p and q are the largest the memory
+//     budget allows, p q + 2 ( p + q ) tiles in all, which reads the left
+//     operand once per column of blocks and the right once per row.
+//   - transpose moves one tile at a time, reading the next while the
+//     current one is transposed and written.
+//
+// A TiledMatrix owns its file descriptor but not its file, which stays on
+// disk after destruction. Reads and writes of distinct tiles may run from
+// several threads at once.
+
+template < class T >
+class TiledMatrix
+{
+public:
+	static const unsigned int DEFAULT_TILE = 512;
+
+	TiledMatrix( const std::string&, const unsigned int, const unsigned int, const unsigned int = DEFAULT_TILE );
+	TiledMatrix( const std::string&, const MatrixView< const T >&, const unsigned int = DEFAULT_TILE );
+	TiledMatrix( const std::string&, const Matrix< T >&, const unsigned int = DEFAULT_TILE );
+	explicit TiledMatrix( const std::string& );
+	TiledMatrix( const TiledMatrix< T >& ) = delete;
+	TiledMatrix( TiledMatrix< T >&& ) noexcept;
+	~TiledMatrix();
+
+	TiledMatrix< T >& operator= ( const TiledMatrix< T >& ) = delete;
+	TiledMatrix< T >& operator= ( TiledMatrix< T >&& ) noexcept;
+
+	void readTile( const unsigned int, const unsigned int, T* ) const;
+	void writeTile( const unsigned int, const unsigned int, const T* );
+
+	void write( MatrixFileWriter< T >& ) const;
+	Matrix< T > toMatrix() const;
+
+	unsigned int numRows() const;
+	unsigned int numColumns() const;
+	unsigned int tileSize() const;
+	unsigned int tileRows() const;
+	unsigned int tileColumns() const;
+	std::size_t tileElements() const;
+
+private:
+	void create( const std::string&, const unsigned int, const unsigned int, const unsigned int );
+	void readBand( const unsigned int, T* ) const;
+	std::uint64_t tileOffset( const unsigned int, const unsigned int ) const;
+	void transfer( const bool, const std::uint64_t, char*, std::size_t ) const;
+
+	int _fd;
+	MatrixFileHeader _header;
+};
+
+// One background thread running the jobs given to it in order: the reads
+// ahead of multiply and transpose.
+class TilePrefetcher
+{
+public:
+	TilePrefetcher();
+	TilePrefetcher( const TilePrefetcher& ) = delete;
+	~TilePrefetcher();
+
+	TilePrefetcher& operator= ( const TilePrefetcher& ) = delete;
+
+	void request( std::function< void() > );
+	void wait();
+
+private:
+	void run();
+
+	std::thread _thread;
+	std::deque< std::function< void() > > _jobs;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::condition_variable _idle;
+	std::exception_ptr _error;
+	bool _busy;
+	bool _stopping;
+};
+
+// TiledMatrix
+
+// Creates the backing file, all zeros.
+template < class T >
+TiledMatrix< T >::TiledMatrix( const std::string& path, const unsigned int rows, const unsigned int columns, const unsigned int tile ) :
+	_fd( -1 )
+{
+	create( path, rows, columns, tile );
+}
+
+// Creates the backing file from the elements of a view, which may be that
+// of a MappedMatrix: one band of tiles is read from it at a time.
+template < class T >
+TiledMatrix< T >::TiledMatrix( const std::string& path, const MatrixView< const T >& source, const unsigned int tile ) :
+	_fd( -1 )
+{
+	create( path, source.numRows(), source.numColumns(), tile );
+
+	std::vector< T, AlignedAllocator< T > > buffer( tileElements() );
+
+	for( unsigned int i = 0; i < tileRows(); i++ )
+		for( unsigned int j = 0; j < tileColumns(); j++ )
+		{
+			const unsigned int r0 = i * tileSize(), c0 = j * tileSize();
+			const unsigned int rows = std::min( tileSize(), numRows() - r0 ), columns = std::min( tileSize(), numColumns() - c0 );
+
+			std::fill( buffer.begin(), buffer.end(), T( 0 ) );
+			for( unsigned int r = 0; r < rows; r++ )
+				std::copy( source[ r0 + r ] + c0, source[ r0 + r ] + c0 + columns, buffer.data() + std::size_t( r ) * tileSize() );
+
+			writeTile( i, j, buffer.data() );
+		}
+}
+
+template < class T >
+TiledMatrix< T >::TiledMatrix( const std::string& path, const Matrix< T >& source, const unsigned int tile ) :
+	TiledMatrix( path, MatrixView< const T >( source ), tile )
+{
+}
+
+// Opens an existing backing file for reading and writing.
+template < class T >
+TiledMatrix< T >::TiledMatrix( const std::string& path ) :
+	_fd( ::open( path.c_str(), O_RDWR ) )
+{
+	struct stat status;
+	if( _fd < 0 || ::fstat( _fd, &status ) != 0 || std::uint64_t( status.st_size ) < sizeof( MatrixFileHeader ) )
+	{
+		if( _fd >= 0 )
+			::close( _fd );
+
+		class TiledFileOpenException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot open the tiled matrix file.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	try
+	{
+		transfer( false, 0, reinterpret_cast< char* >( &_header ), sizeof( MatrixFileHeader ) );
+		_header.check< T >( status.st_size, true );
+	}
+	catch( ... )
+	{
+		::close( _fd );
+		throw;
+	}
+}
+
+template < class T >
+TiledMatrix< T >::TiledMatrix( TiledMatrix< T >&& other ) noexcept :
+	_fd( other._fd ),
+	_header( other._header )
+{
+	other._fd = -1;
+}
+
+template < class T >
+TiledMatrix< T >::~TiledMatrix()
+{
+	if( _fd >= 0 )
+		::close( _fd );
+}
+
+template < class T >
+TiledMatrix< T >& TiledMatrix< T >::operator= ( TiledMatrix< T >&& other ) noexcept
+{
+	std::swap( _fd, other._fd );
+	std::swap( _header, other._header );
+
+	return *this;
+}
+
+// Reads tile ( i, j ), tileElements() of them, into tile.
+template < class T >
+void TiledMatrix< T >::readTile( const unsigned int i, const unsigned int j, T* tile ) const
+{
+	transfer( false, tileOffset( i, j ), reinterpret_cast< char* >( tile ), tileElements() * sizeof( T ) );
+}
+
+template < class T >
+void TiledMatrix< T >::writeTile( const unsigned int i, const unsigned int j, const T* tile )
+{
+	transfer( true, tileOffset( i, j ), reinterpret_cast< char* >( const_cast< T* >( tile ) ), tileElements() * sizeof( T ) );
+}
+
+// Streams the matrix out row by row, holding one band of tiles at a time.
+template < class T >
+void TiledMatrix< T >::write( MatrixFileWriter< T >& writer ) const
+{
+	std::vector< T, AlignedAllocator< T > > band( tileElements() * tileColumns() );
+
+	for( unsigned int i = 0; i < tileRows(); i++ )
+	{
+		readBand( i, band.data() );
+
+		const unsigned int rows = std::min( tileSize(), numRows() - i * tileSize() );
+		writer.write( MatrixView< const T >( band.data(), rows, numColumns(), std::size_t( tileColumns() ) * tileSize() ) );
+	}
+}
+
+template < class T >
+Matrix< T > TiledMatrix< T >::toMatrix() const
+{
+	Matrix< T > out( numRows(), numColumns() );
+	std::vector< T, AlignedAllocator< T > > band( tileElements() * tileColumns() );
+
+	for( unsigned int i = 0; i < tileRows(); i++ )
+	{
+		readBand( i, band.data() );
+
+		const unsigned int rows = std::min( tileSize(), numRows() - i * tileSize() );
+		out.block( i * tileSize(), 0, rows, numColumns() ) =
+			MatrixView< const T >( band.data(), rows, numColumns(), std::size_t( tileColumns() ) * tileSize() );
+	}
+
+	return out;
+}
+
+template < class T >
+unsigned int TiledMatrix< T >::numRows() const
+{
+	return _header.rows;
+}
+
+template < class T >
+unsigned int TiledMatrix< T >::numColumns() const
+{
+	return _header.columns;
+}
+
+template < class T >
+unsigned int TiledMatrix< T >::tileSize() const
+{
+	return _header.tileSize;
+}
+
+template < class T >
+unsigned int TiledMatrix< T >::tileRows() const
+{
+	return _header.paddedRows() / _header.tileSize;
+}
+
+template < class T >
+unsigned int TiledMatrix< T >::tileColumns() const
+{
+	return _header.paddedColumns() / _header.tileSize;
+}
+
+template < class T >
+std::size_t TiledMatrix< T >::tileElements() const
+{
+	return std::size_t( tileSize() ) * tileSize();
+}
+
+// Writes the header and sizes the file, which leaves every tile zero
+// without writing it.
+template < class T >
+void TiledMatrix< T >::create( const std::string& path, const unsigned int rows, const unsigned int columns, const unsigned int tile )
+{
+	class TiledFileCreateException
+		: public std::exception
+	{
+		virtual const char* what() const throw()
+		{
+			return "Cannot create the tiled matrix file.";
+		}
+	} ex;
+
+	if( tile == 0 )
+		throw ex;
+
+	_header = MatrixFileHeader::describe< T >( rows, columns, FILE_TILED, tile );
+	_fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+	if( _fd < 0 )
+		throw ex;
+
+	try
+	{
+		transfer( true, 0, reinterpret_cast< char* >( &_header ), sizeof( MatrixFileHeader ) );
+	}
+	catch( ... )
+	{
+		::close( _fd );
+		_fd = -1;
+		throw;
+	}
+
+	if( ::ftruncate( _fd, _header.dataOffset + _header.paddedRows() * _header.paddedColumns() * sizeof( T ) ) != 0 )
+	{
+		::close( _fd );
+		_fd = -1;
+		throw ex;
+	}
+}
+
+// Reads the tiles of band i side by side, as tileSize() rows of
+// tileColumns() * tileSize() elements.
+template < class T >
+void TiledMatrix< T >::readBand( const unsigned int i, T* band ) const
+{
+	std::vector< T, AlignedAllocator< T > > tile( tileElements() );
+	const std::size_t width = std::size_t( tileColumns() ) * tileSize();
+
+	for( unsigned int j = 0; j < tileColumns(); j++ )
+	{
+		readTile( i, j, tile.data() );
+
+		for( unsigned int r = 0; r < tileSize(); r++ )
+			std::copy( tile.data() + std::size_t( r ) * tileSize(), tile.data() + std::size_t( r + 1 ) * tileSize(),
+					   band + r * width + std::size_t( j ) * tileSize() );
+	}
+}
+
+template < class T >
+std::uint64_t TiledMatrix< T >::tileOffset( const unsigned int i, const unsigned int j ) const
+{
+	if( i >= tileRows() || j >= tileColumns() )
+	{
+		class TileIndexException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Tile index is out of range.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	return _header.dataOffset + ( std::uint64_t( i ) * tileColumns() + j ) * tileElements() * sizeof( T );
+}
+
+// pread or pwrite of the whole range, resuming after short transfers and
+// interruptions.
+template < class T >
+void TiledMatrix< T >::transfer( const bool writing, std::uint64_t offset, char* bytes, std::size_t count ) const
+{
+	while( count )
+	{
+		const ssize_t done = writing ? ::pwrite( _fd, bytes, count, offset ) : ::pread( _fd, bytes, count, offset );
+
+		if( done <= 0 )
+		{
+			if( done < 0 && errno == EINTR )
+				continue;
+
+			class TiledFileIOException
+				: public std::exception
+			{
+				virtual const char* what() const throw()
+				{
+					return "Cannot read or write the tiled matrix file.";
+				}
+			} ex;
+
+			throw ex;
+		}
+
+		offset += done;
+		bytes += done;
+		count -= done;
+	}
+}
+
+// TilePrefetcher
+
+inline TilePrefetcher::TilePrefetcher() :
+	_busy( false ),
+	_stopping( false )
+{
+	_thread = std::thread( &TilePrefetcher::run, this );
+}
+
+inline TilePrefetcher::~TilePrefetcher()
+{
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_stopping = true;
+	}
+	_condition.notify_one();
+
+	_thread.join();
+}
+
+inline void TilePrefetcher::request( std::function< void() > job )
+{
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_jobs.push_back( std::move( job ) );
+	}
+	_condition.notify_one();
+}
+
+// Returns once every job requested so far has run, rethrowing the first
+// exception any of them threw since the last wait().
+inline void TilePrefetcher::wait()
+{
+	std::unique_lock< std::mutex > lock( _mutex );
+	_idle.wait( lock, [this] { return !_busy && _jobs.empty(); } );
+
+	if( _error )
+	{
+		std::exception_ptr error = _error;
+		_error = nullptr;
+		std::rethrow_exception( error );
+	}
+}
+
+inline void TilePrefetcher::run()
+{
+	for( ;; )
+	{
+		std::function< void() > job;
+
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+			_condition.wait( lock, [this] { return _stopping || !_jobs.empty(); } );
+
+			if( _jobs.empty() )
+				return;
+
+			job = std::move( _jobs.front() );
+			_jobs.pop_front();
+			_busy = true;
+		}
+
+		std::exception_ptr error;
+		try
+		{
+			job();
+		}
+		catch( ... )
+		{
+			error = std::current_exception();
+		}
+
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			if( error && !_error )
+				_error = error;
+
+			_busy = false;
+		}
+		_idle.notify_all();
+	}
+}
+
+// Out-of-core operations
+
+// The product lhs * rhs, written to a new tiled file at path. memoryBudget
+// bounds, in bytes, the tiles held in memory at once; it must allow five.
+template < class T >
+TiledMatrix< T > multiply( const TiledMatrix< T >& lhs, const TiledMatrix< T >& rhs, const std::string& path,
+						   const std::size_t memoryBudget, const ExecutionPolicy& policy = ExecutionPolicy() )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_MULTIPLY, 2ull * lhs.numRows() * rhs.numColumns() * lhs.numColumns() );
+
+	if( lhs.numColumns() != rhs.numRows() || lhs.tileSize() != rhs.tileSize() )
+	{
+		class TiledMultiplicationException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Cannot multiply tiled matrices of incompatible dimensions or tile sizes.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	const unsigned int t = lhs.tileSize();
+	const std::size_t tile = lhs.tileElements();
+	const std::size_t tiles = memoryBudget / ( tile * sizeof( T ) );
+
+	if( tiles < 5 )
+	{
+		class TiledBudgetException
+			: public std::exception
+		{
+			virtual const char* what() const throw()
+			{
+				return "Memory budget is too small to hold five tiles.";
+			}
+		} ex;
+
+		throw ex;
+	}
+
+	TiledMatrix< T > product( path, lhs.numRows(), rhs.numColumns(), t );
+
+	const unsigned int mt = lhs.tileRows(), nt = rhs.tileColumns(), kt = lhs.tileColumns();
+	if( !mt || !nt || !kt )
+		return product;
+
+	// The largest square block that fits, widened along whichever side the
+	// product is too narrow to fill.
+	unsigned int s = 1;
+	while( std::size_t( s + 1 ) * ( s + 1 ) + 4 * ( s + 1 ) <= tiles )
+		s++;
+
+	const unsigned int q0 = std::min( nt, s );
+	const unsigned int p = std::min< std::size_t >( mt, ( tiles - 2 * q0 ) / ( q0 + 2 ) );
+	const unsigned int q = std::min< std::size_t >( nt, ( tiles - 2 * p ) / ( p + 2 ) );
+
+	std::vector< T, AlignedAllocator< T > > c( p * q * tile );
+	std::vector< T, AlignedAllocator< T > > a[2], b[2];
+	for( unsigned int set = 0; set < 2; set++ )
+	{
+		a[ set ].resize( p * tile );
+		b[ set ].resize( q * tile );
+	}
+
+	const unsigned int blockRows = ( mt + p - 1 ) / p, blockColumns = ( nt + q - 1 ) / q;
+	const unsigned long long steps = (unsigned long long)blockRows * blockColumns * kt;
+
+	// Step s multiplies the tiles of inner index s % kt into block s / kt.
+	auto load = [&]( const unsigned long long step )
+	{
+		const unsigned int block = step / kt, k = step % kt, set = step % 2;
+		const unsigned int i0 = ( block / blockColumns ) * p, j0 = ( block % blockColumns ) * q;
+
+		for( unsigned int i = i0; i < std::min( mt, i0 + p ); i++ )
+			lhs.readTile( i, k, a[ set ].data() + ( i - i0 ) * tile );
+		for( unsigned int j = j0; j < std::min( nt, j0 + q ); j++ )
+			rhs.readTile( k, j, b[ set ].data() + ( j - j0 ) * tile );
+	};
+
+	TilePrefetcher prefetcher;
+	if( steps )
+		prefetcher.request( [&] { load( 0 ); } );
+
+	for( unsigned long long step = 0; step < steps; step++ )
+	{
+		const unsigned int block = step / kt, k = step % kt, set = step % 2;
+		const unsigned int i0 = ( block / blockColumns ) * p, j0 = ( block % blockColumns ) * q;
+		const unsigned int pb = std::min( mt - i0, p ), qb = std::min( nt - j0, q );
+
+		prefetcher.wait();
+		if( step + 1 < steps )
+			prefetcher.request( [&load, step] { load( step + 1 ); } );
+
+		if( k == 0 )
+			std::fill( c.begin(), c.end(), T( 0 ) );
+
+		auto update = [&]( std::size_t first, std::size_t last )
+		{
+			for( std::size_t ij = first; ij < last; ij++ )
+				Gemm< T >::multiply( t, t, t, a[ set ].data() + ( ij / qb ) * tile, t, b[ set ].data() + ( ij % qb ) * tile, t,
+									 c.data() + ( ( ij / qb ) * q + ij % qb ) * tile, t );
+		};
+
+		if( policy.parallel( (unsigned long)pb * qb * t * t * t ) )
+			policy.pool().parallelFor( 0, pb * qb, update );
+		else
+			update( 0, pb * qb );
+
+		if( k + 1 == kt )
+			for( unsigned int i = 0; i < pb; i++ )
+				for( unsigned int j = 0; j < qb; j++ )
+					product.writeTile( i0 + i, j0 + j, c.data() + ( i * q + j ) * tile );
+	}
+
+	return product;
+}
+
+// The transpose of source, written to a new tiled file at path.
+template < class T >
+TiledMatrix< T > transpose( const TiledMatrix< T >& source, const std::string& path )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_MATRIX_TRANSPOSE, 0 );
+
+	const unsigned int t = source.tileSize();
+	TiledMatrix< T > result( path, source.numColumns(), source.numRows(), t );
+
+	const unsigned long long tiles = (unsigned long long)source.tileRows() * source.tileColumns();
+	std::vector< T, AlignedAllocator< T > > buffers[2], transposed( source.tileElements() );
+	buffers[0].resize( source.tileElements() );
+	buffers[1].resize( source.tileElements() );
+
+	auto load = [&]( const unsigned long long n )
+	{
+		source.readTile( n / source.tileColumns(), n % source.tileColumns(), buffers[ n % 2 ].data() );
+	};
+
+	TilePrefetcher prefetcher;
+	if( tiles )
+		prefetcher.request( [&] { load( 0 ); } );
+
+	for( unsigned long long n = 0; n < tiles; n++ )
+	{
+		prefetcher.wait();
+		if( n + 1 < tiles )
+			prefetcher.request( [&load, n] { load( n + 1 ); } );
+
+		TransposeKernels< T >::transpose( t, t, buffers[ n % 2 ].data(), t, transposed.data(), t );
+		result.writeTile( n % source.tileColumns(), n / source.tileColumns(), transposed.data() );
+	}
+
+	return result;
+}
+
+#endif
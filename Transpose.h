@@ -0,0 +1,251 @@
+#ifndef __INCL_TRANSPOSE_H__
+#define __INCL_TRANSPOSE_H__
+
+#include "VectorKernels.h"
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+// Cache-oblivious transposition of row-major storage. The larger dimension
+// is halved until a piece fits in a LEAF x LEAF block, so that both the rows
+// read and the rows written stay in cache at every level of the hierarchy
+// without tuning for it. Each leaf is transposed in W x W tiles; for the
+// element types with SIMD kernels the tiles are transposed in registers
+// with AVX2 when the CPU supports it.
+
+// TransposeTile< T >::transpose writes the transpose of the W x W tile at in
+// to out. The tiles must not overlap.
+
+template < class T, bool Simd = SimdTraits< T >::supported >
+struct TransposeTile
+{
+	static const unsigned int W = 8;
+
+	static void transpose( const T*, std::size_t, T*, std::size_t );
+
+protected:
+	template < unsigned int Width >
+		static void transposeScalar( const T*, std::size_t, T*, std::size_t );
+};
+
+template < class T, bool Simd >
+void TransposeTile< T, Simd >::transpose( const T* in, std::size_t ldIn, T* out, std::size_t ldOut )
+{
+	transposeScalar< W >( in, ldIn, out, ldOut );
+}
+
+// The scalar form of a Width x Width tile transpose, which every
+// TransposeTile falls back on with its own W.
+template < class T, bool Simd >
+template < unsigned int Width >
+void TransposeTile< T, Simd >::transposeScalar( const T* in, std::size_t ldIn, T* out, std::size_t ldOut )
+{
+	for( unsigned int r = 0; r < Width; r++ )
+		for( unsigned int c = 0; c < Width; c++ )
+			out[ c * ldOut + r ] = in[ r * ldIn + c ];
+}
+
+#ifdef LINEAR_ALGEBRA_SIMD
+
+// Register transposes of 8 x 8 four-byte and 4 x 4 eight-byte tiles. They
+// only move bits, so the float and double forms serve the integer types too.
+
+template < std::size_t Size >
+struct Avx2Transpose;
+
+template <>
+struct Avx2Transpose< 4 >
+{
+	LINEAR_ALGEBRA_TARGET_AVX2 static void apply( const void* in, std::size_t ldIn, void* out, std::size_t ldOut )
+	{
+		const float* a = static_cast< const float* >( in );
+		float* b = static_cast< float* >( out );
+
+		const __m256 r0 = _mm256_loadu_ps( a ), r1 = _mm256_loadu_ps( a + ldIn ),
+			r2 = _mm256_loadu_ps( a + 2 * ldIn ), r3 = _mm256_loadu_ps( a + 3 * ldIn ),
+			r4 = _mm256_loadu_ps( a + 4 * ldIn ), r5 = _mm256_loadu_ps( a + 5 * ldIn ),
+			r6 = _mm256_loadu_ps( a + 6 * ldIn ), r7 = _mm256_loadu_ps( a + 7 * ldIn );
+
+		const __m256 t0 = _mm256_unpacklo_ps( r0, r1 ), t1 = _mm256_unpackhi_ps( r0, r1 ),
+			t2 = _mm256_unpacklo_ps( r2, r3 ), t3 = _mm256_unpackhi_ps( r2, r3 ),
+			t4 = _mm256_unpacklo_ps( r4, r5 ), t5 = _mm256_unpackhi_ps( r4, r5 ),
+			t6 = _mm256_unpacklo_ps( r6, r7 ), t7 = _mm256_unpackhi_ps( r6, r7 );
+
+		const __m256 s0 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) ), s1 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) ),
+			s2 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) ), s3 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) ),
+			s4 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ) ), s5 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ) ),
+			s6 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ) ), s7 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+		_mm256_storeu_ps( b, _mm256_permute2f128_ps( s0, s4, 0x20 ) );
+		_mm256_storeu_ps( b + ldOut, _mm256_permute2f128_ps( s1, s5, 0x20 ) );
+		_mm256_storeu_ps( b + 2 * ldOut, _mm256_permute2f128_ps( s2, s6, 0x20 ) );
+		_mm256_storeu_ps( b + 3 * ldOut, _mm256_permute2f128_ps( s3, s7, 0x20 ) );
+		_mm256_storeu_ps( b + 4 * ldOut, _mm256_permute2f128_ps( s0, s4, 0x31 ) );
+		_mm256_storeu_ps( b + 5 * ldOut, _mm256_permute2f128_ps( s1, s5, 0x31 ) );
+		_mm256_storeu_ps( b + 6 * ldOut, _mm256_permute2f128_ps( s2, s6, 0x31 ) );
+		_mm256_storeu_ps( b + 7 * ldOut, _mm256_permute2f128_ps( s3, s7, 0x31 ) );
+	}
+};
+
+template <>
+struct Avx2Transpose< 8 >
+{
+	LINEAR_ALGEBRA_TARGET_AVX2 static void apply( const void* in, std::size_t ldIn, void* out, std::size_t ldOut )
+	{
+		const double* a = static_cast< const double* >( in );
+		double* b = static_cast< double* >( out );
+
+		const __m256d r0 = _mm256_loadu_pd( a ), r1 = _mm256_loadu_pd( a + ldIn ),
+			r2 = _mm256_loadu_pd( a + 2 * ldIn ), r3 = _mm256_loadu_pd( a + 3 * ldIn );
+
+		const __m256d t0 = _mm256_unpacklo_pd( r0, r1 ), t1 = _mm256_unpackhi_pd( r0, r1 ),
+			t2 = _mm256_unpacklo_pd( r2, r3 ), t3 = _mm256_unpackhi_pd( r2, r3 );
+
+		_mm256_storeu_pd( b, _mm256_permute2f128_pd( t0, t2, 0x20 ) );
+		_mm256_storeu_pd( b + ldOut, _mm256_permute2f128_pd( t1, t3, 0x20 ) );
+		_mm256_storeu_pd( b + 2 * ldOut, _mm256_permute2f128_pd( t0, t2, 0x31 ) );
+		_mm256_storeu_pd( b + 3 * ldOut, _mm256_permute2f128_pd( t1, t3, 0x31 ) );
+	}
+};
+
+template < class T >
+struct TransposeTile< T, true >
+	: TransposeTile< T, false >
+{
+	static const unsigned int W = 32 / sizeof( T );
+
+	static void transpose( const T*, std::size_t, T*, std::size_t );
+};
+
+template < class T >
+void TransposeTile< T, true >::transpose( const T* in, std::size_t ldIn, T* out, std::size_t ldOut )
+{
+	if( simdLevel() >= SIMD_AVX2 )
+		Avx2Transpose< sizeof( T ) >::apply( in, ldIn, out, ldOut );
+	else
+		TransposeTile< T, false >::template transposeScalar< W >( in, ldIn, out, ldOut );
+}
+
+#endif
+
+template < class T >
+struct TransposeKernels
+{
+	static const unsigned int LEAF = 32;
+
+	static void transpose( const unsigned int, const unsigned int, const T*, const std::size_t, T*, const std::size_t );
+	static void transposeInPlace( const unsigned int, T*, const std::size_t );
+
+private:
+	typedef TransposeTile< T > Tile;
+
+	static void transposeLeaf( const unsigned int, const unsigned int, const T*, const std::size_t, T*, const std::size_t );
+	static void swapTransposed( const unsigned int, const unsigned int, T*, T*, const std::size_t );
+	static void swapTransposedLeaf( const unsigned int, const unsigned int, T*, T*, const std::size_t );
+};
+
+// Writes the transpose of the rows x cols block at in to the cols x rows
+// block at out.
+template < class T >
+void TransposeKernels< T >::transpose( const unsigned int rows, const unsigned int cols,
+									   const T* in, const std::size_t ldIn, T* out, const std::size_t ldOut )
+{
+	if( rows <= LEAF && cols <= LEAF )
+		transposeLeaf( rows, cols, in, ldIn, out, ldOut );
+	else if( rows >= cols )
+	{
+		const unsigned int half = rows / 2;
+		transpose( half, cols, in, ldIn, out, ldOut );
+		transpose( rows - half, cols, in + half * ldIn, ldIn, out + half, ldOut );
+	}
+	else
+	{
+		const unsigned int half = cols / 2;
+		transpose( rows, half, in, ldIn, out, ldOut );
+		transpose( rows, cols - half, in + half, ldIn, out + half * ldOut, ldOut );
+	}
+}
+
+// Transposes the n x n block at a in place: both diagonal quadrants are
+// transposed recursively, then the off-diagonal ones swapped transposed.
+template < class T >
+void TransposeKernels< T >::transposeInPlace( const unsigned int n, T* a, const std::size_t ld )
+{
+	if( n <= LEAF )
+	{
+		for( unsigned int r = 0; r < n; r++ )
+			for( unsigned int c = r + 1; c < n; c++ )
+				std::swap( a[ r * ld + c ], a[ c * ld + r ] );
+
+		return;
+	}
+
+	const unsigned int half = n / 2;
+
+	transposeInPlace( half, a, ld );
+	transposeInPlace( n - half, a + half * ld + half, ld );
+	swapTransposed( half, n - half, a + half, a + half * ld, ld );
+}
+
+template < class T >
+void TransposeKernels< T >::transposeLeaf( const unsigned int rows, const unsigned int cols,
+										   const T* in, const std::size_t ldIn, T* out, const std::size_t ldOut )
+{
+	const unsigned int W = Tile::W;
+	const unsigned int fullRows = rows - rows % W, fullCols = cols - cols % W;
+
+	for( unsigned int r = 0; r < fullRows; r += W )
+		for( unsigned int c = 0; c < fullCols; c += W )
+			Tile::transpose( in + r * ldIn + c, ldIn, out + c * ldOut + r, ldOut );
+
+	for( unsigned int r = 0; r < rows; r++ )
+		for( unsigned int c = ( r < fullRows ) ? fullCols : 0; c < cols; c++ )
+			out[ c * ldOut + r ] = in[ r * ldIn + c ];
+}
+
+// Exchanges the rows x cols block at a with the transpose of the cols x rows
+// block at b. The blocks must not overlap.
+template < class T >
+void TransposeKernels< T >::swapTransposed( const unsigned int rows, const unsigned int cols, T* a, T* b, const std::size_t ld )
+{
+	if( rows <= LEAF && cols <= LEAF )
+		swapTransposedLeaf( rows, cols, a, b, ld );
+	else if( rows >= cols )
+	{
+		const unsigned int half = rows / 2;
+		swapTransposed( half, cols, a, b, ld );
+		swapTransposed( rows - half, cols, a + half * ld, b + half, ld );
+	}
+	else
+	{
+		const unsigned int half = cols / 2;
+		swapTransposed( rows, half, a, b, ld );
+		swapTransposed( rows, cols - half, a + half, b + half * ld, ld );
+	}
+}
+
+template < class T >
+void TransposeKernels< T >::swapTransposedLeaf( const unsigned int rows, const unsigned int cols, T* a, T* b, const std::size_t ld )
+{
+	const unsigned int W = Tile::W;
+	const unsigned int fullRows = rows - rows % W, fullCols = cols - cols % W;
+	T tile[ W * W ];
+
+	for( unsigned int r = 0; r < fullRows; r += W )
+		for( unsigned int c = 0; c < fullCols; c += W )
+		{
+			T* x = a + r * ld + c;
+			T* y = b + c * ld + r;
+
+			Tile::transpose( x, ld, tile, W );
+			Tile::transpose( y, ld, x, ld );
+			for( unsigned int i = 0; i < W; i++ )
+				std::copy( tile + i * W, tile + ( i + 1 ) * W, y + i * ld );
+		}
+
+	for( unsigned int r = 0; r < rows; r++ )
+		for( unsigned int c = ( r < fullRows ) ? fullCols : 0; c < cols; c++ )
+			std::swap( a[ r * ld + c ], b[ c * ld + r ] );
+}
+
+#endif
@@ -6,19 +6,36 @@
 #include <initializer_list>
 #include <type_traits>
 #include <exception>
+#include <algorithm>
+#include <utility>
+#include "AlignedAllocator.h"
+#include "Instrumentation.h"
+#include "VectorKernels.h"
+#include "VectorExpression.h"
 
 struct VectorBase {};
 
+// Vector< T > is the dynamically sized vector defined here. Vector< T, N >
+// with N > 0 is a fixed-size vector; see FixedVector.h.
+template < class T, unsigned int N = 0 >
+class Vector;
+
 template < class T >
-class Vector
+class Vector< T, 0 >
 	: public VectorBase
 {
 public:
+	typedef T value_type;
+	typedef std::vector< T, AlignedAllocator< T > > container_type;
+	
 	Vector()
 		{}
 	Vector( const Vector< T >& cVector ) :
 		_values( cVector._values )
 		{}
+	Vector( Vector< T >&& cVector ) noexcept :
+		_values( std::move( cVector._values ) )
+		{}
 	Vector( unsigned int size ) :
 		_values( size, T( 0 ) )
 		{}
@@ -29,15 +46,21 @@ public:
 	Vector( std::initializer_list< T > iList ) :
 		_values( iList.begin(), iList.end() )
 		{}
+	template < class E >
+		Vector( const VectorExpression< E >& expression )
+		{
+			LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, expression.self().length() );
+			_values.assign( ::begin( expression ), ::end( expression ) );
+		}
 	
-	typename std::vector< T >::iterator begin();
-	typename std::vector< T >::iterator end();
-	typename std::vector< T >::reverse_iterator rbegin();
-	typename std::vector< T >::reverse_iterator rend();
-	typename std::vector< T >::const_iterator cbegin() const noexcept;
-	typename std::vector< T >::const_iterator cend() const noexcept;
-	typename std::vector< T >::const_reverse_iterator crbegin() const noexcept;
-	typename std::vector< T >::const_reverse_iterator crend() const noexcept;
+	typename container_type::iterator begin();
+	typename container_type::iterator end();
+	typename container_type::reverse_iterator rbegin();
+	typename container_type::reverse_iterator rend();
+	typename container_type::const_iterator cbegin() const noexcept;
+	typename container_type::const_iterator cend() const noexcept;
+	typename container_type::const_reverse_iterator crbegin() const noexcept;
+	typename container_type::const_reverse_iterator crend() const noexcept;
 	
 	template < class R >
 		static R add( const Vector< T >&, const Vector< T >& );
@@ -51,14 +74,21 @@ public:
 		static R divide( const Vector< T >&, const U& );
 	
 	Vector< T >& operator= ( const Vector< T >& );
+	Vector< T >& operator= ( Vector< T >&& ) noexcept;
 	Vector< T >& operator+= ( const Vector< T >& );
 	Vector< T >& operator-= ( const Vector< T >& );
 	template < class V > Vector< T >& operator*= ( const V& );
 	template < class V > Vector< T >& operator/= ( const V& );
+	template < class E > Vector< T >& operator= ( const VectorExpression< E >& );
+	template < class E > Vector< T >& operator+= ( const VectorExpression< E >& );
+	template < class E > Vector< T >& operator-= ( const VectorExpression< E >& );
 	
 	T& operator[] ( const unsigned int& );
 	const T& operator[] ( const unsigned int& ) const;
 	
+	T* data() noexcept;
+	const T* data() const noexcept;
+	
 	operator bool() const;
 	
 	template < class U > friend bool operator! ( const Vector< U >& );
@@ -67,55 +97,55 @@ public:
 	virtual void resize( unsigned int );
 	
 protected:
-	std::vector< T > _values;
+	container_type _values;
 };
 
 // Iterators
 
 template < class T >
-typename std::vector< T >::iterator Vector< T >::begin()
+typename Vector< T >::container_type::iterator Vector< T >::begin()
 {
 	return _values.begin();
 }
 
 template < class T >
-typename std::vector< T >::iterator Vector< T >::end()
+typename Vector< T >::container_type::iterator Vector< T >::end()
 {
 	return _values.end();
 }
 
 template < class T >
-typename std::vector< T >::reverse_iterator Vector< T >::rbegin()
+typename Vector< T >::container_type::reverse_iterator Vector< T >::rbegin()
 {
 	return _values.rbegin();
 }
 
 template < class T >
-typename std::vector< T >::reverse_iterator Vector< T >::rend()
+typename Vector< T >::container_type::reverse_iterator Vector< T >::rend()
 {
 	return _values.rend();
 }
 
 template < class T >
-typename std::vector< T >::const_iterator Vector< T >::cbegin() const noexcept
+typename Vector< T >::container_type::const_iterator Vector< T >::cbegin() const noexcept
 {
 	return _values.cbegin();
 }
 
 template < class T >
-typename std::vector< T >::const_iterator Vector< T >::cend() const noexcept
+typename Vector< T >::container_type::const_iterator Vector< T >::cend() const noexcept
 {
 	return _values.cend();
 }
 
 template < class T >
-typename std::vector< T >::const_reverse_iterator Vector< T >::crbegin() const noexcept
+typename Vector< T >::container_type::const_reverse_iterator Vector< T >::crbegin() const noexcept
 {
 	return _values.crbegin();
 }
 
 template < class T >
-typename std::vector< T >::const_reverse_iterator Vector< T >::crend() const noexcept
+typename Vector< T >::container_type::const_reverse_iterator Vector< T >::crend() const noexcept
 {
 	return _values.crend();
 }
@@ -204,44 +234,107 @@ R Vector< T >::divide( const Vector< T >& lhVector, const U& scalar )
 template < class T >
 Vector< T >& Vector< T >::operator= ( const Vector< T > &otherVector )
 {
-	resize( otherVector.length() );
+	_values = otherVector._values;
 	
-	for( unsigned int i = 0; i < otherVector.length(); i++ )
-		_values[i] = otherVector[i];
+	return *this;
+}
+
+template < class T >
+Vector< T >& Vector< T >::operator= ( Vector< T > &&otherVector ) noexcept
+{
+	_values = std::move( otherVector._values );
+	
+	return *this;
 }
 
 template < class T >
 Vector< T >& Vector< T >::operator+= ( const Vector< T > &otherVector )
 {
-	resize( otherVector.length() );
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, otherVector.length() );
+	
+	if( otherVector.length() > length() )
+		resize( otherVector.length() );
 
-	for( unsigned int i = 0; i < otherVector.length(); i++ )
-		_values[i] += otherVector[i];
+	VectorKernels< T >::add( _values.data(), otherVector._values.data(), otherVector.length() );
+	
+	return *this;
 }
 
 template < class T >
 Vector< T >& Vector< T >::operator-= ( const Vector< T > &otherVector )
 {
-	resize( otherVector.length() );
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, otherVector.length() );
+	
+	if( otherVector.length() > length() )
+		resize( otherVector.length() );
 
-	for( unsigned int i = 0; i < otherVector.length(); i++ )
-		_values[i] -= otherVector[i];
+	VectorKernels< T >::subtract( _values.data(), otherVector._values.data(), otherVector.length() );
+	
+	return *this;
 }
 
 template < class T >
 template < class V >
 Vector< T >& Vector< T >::operator*= ( const V &scalar )
 {
-	for( unsigned int i = 0; i < length(); i++ )
-		_values[i] *= scalar;
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, length() );
+	
+	VectorKernels< T >::scale( _values.data(), scalar, length() );
+	
+	return *this;
 }
 
 template < class T >
 template < class V >
 Vector< T >& Vector< T >::operator/= ( const V &scalar )
 {
-	for( unsigned int i = 0; i < length(); i++ )
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, length() );
+	
+	for( typename container_type::size_type i = 0; i < _values.size(); i++ )
 		_values[i] /= scalar;
+	
+	return *this;
+}
+
+template < class T >
+template < class E >
+Vector< T >& Vector< T >::operator= ( const VectorExpression< E > &expression )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, expression.self().length() );
+	
+	_values.assign( ::begin( expression ), ::end( expression ) );
+	
+	return *this;
+}
+
+template < class T >
+template < class E >
+Vector< T >& Vector< T >::operator+= ( const VectorExpression< E > &expression )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, expression.self().length() );
+	
+	const E& e = expression.self();
+	resize( e.length() );
+	
+	for( unsigned int i = 0; i < e.length(); i++ )
+		_values[i] += e[i];
+	
+	return *this;
+}
+
+template < class T >
+template < class E >
+Vector< T >& Vector< T >::operator-= ( const VectorExpression< E > &expression )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, expression.self().length() );
+	
+	const E& e = expression.self();
+	resize( e.length() );
+	
+	for( unsigned int i = 0; i < e.length(); i++ )
+		_values[i] -= e[i];
+	
+	return *this;
 }
 
 template < class T >
@@ -256,10 +349,22 @@ const T& Vector< T >::operator[] ( const unsigned int &index ) const
 	return _values[ index ];
 }
 
+template < class T >
+T* Vector< T >::data() noexcept
+{
+	return _values.data();
+}
+
+template < class T >
+const T* Vector< T >::data() const noexcept
+{
+	return _values.data();
+}
+
 template < class T >
 Vector< T >::operator bool() const
 {
-	T test();
+	const T test = T( 0 );
 	
 	for( unsigned int i = 0; i < length(); i++ )
 		if( _values[i] != test )
@@ -275,40 +380,92 @@ bool operator! ( const Vector< U > &cVector )
 }
 
 // Free operator overloads
+//
+// Arithmetic on Vector-derived types and on expressions builds a
+// VectorExpression; nothing is computed until it is assigned to its
+// result type.
 
-template < class R >
-typename std::enable_if< std::is_base_of< VectorBase, R >::value, R >::type
-operator+ ( const R &lhs, const R &rhs )
+template < class X, class Enable = void >
+struct VectorOperand
+{
+	static const bool value = false;
+};
+
+template < class X >
+struct VectorOperand< X, typename std::enable_if< std::is_base_of< VectorExpressionBase, X >::value >::type >
+{
+	static const bool value = true;
+	typedef X type;
+	
+	static const X& wrap( const X& operand ) { return operand; }
+};
+
+template < class X >
+struct VectorOperand< X, typename std::enable_if< std::is_base_of< VectorBase, X >::value >::type >
+{
+	static const bool value = true;
+	typedef VectorReference< X > type;
+	
+	static type wrap( const X& operand ) { return type( operand ); }
+};
+
+template < class L, class R, bool = VectorOperand< L >::value && VectorOperand< R >::value >
+struct VectorOperands
+{
+	static const bool value = false;
+};
+
+template < class L, class R >
+struct VectorOperands< L, R, true >
+{
+	static const bool value = std::is_same< typename VectorOperand< L >::type::result_type,
+											typename VectorOperand< R >::type::result_type >::value;
+};
+
+template < class L, class R >
+typename std::enable_if< VectorOperands< L, R >::value,
+						 VectorBinaryExpression< typename VectorOperand< L >::type, typename VectorOperand< R >::type, VectorAdd > >::type
+operator+ ( const L &lhs, const R &rhs )
 {
-	return R::template add<R>( lhs, rhs );
+	return { VectorOperand< L >::wrap( lhs ), VectorOperand< R >::wrap( rhs ) };
 }
 
-template < class R >
-typename std::enable_if< std::is_base_of< VectorBase, R >::value, R >::type
-operator- ( const R &lhs, const R &rhs )
+template < class L, class R >
+typename std::enable_if< VectorOperands< L, R >::value,
+						 VectorBinaryExpression< typename VectorOperand< L >::type, typename VectorOperand< R >::type, VectorSubtract > >::type
+operator- ( const L &lhs, const R &rhs )
 {
-	return R::template subtract<R>( lhs, rhs );
+	return { VectorOperand< L >::wrap( lhs ), VectorOperand< R >::wrap( rhs ) };
 }
 
 template < class R, class U >
-typename std::enable_if< ( std::is_base_of< VectorBase, R >::value && !( std::is_base_of< VectorBase, U >::value ) ), R >::type
+typename std::enable_if< ( VectorOperand< R >::value && !VectorOperand< U >::value ),
+						 VectorScalarExpression< typename VectorOperand< R >::type, U, VectorMultiply > >::type
 operator* ( const R &lhs, const U &rhs )
 {
-	return R::template multiply<R>( lhs, rhs );
+	return { VectorOperand< R >::wrap( lhs ), rhs };
 }
 
 template < class R, class U >
-typename std::enable_if< ( std::is_base_of< VectorBase, R >::value && !( std::is_base_of< VectorBase, U >::value ) ), R >::type
+typename std::enable_if< ( VectorOperand< R >::value && !VectorOperand< U >::value ),
+						 VectorScalarExpression< typename VectorOperand< R >::type, U, VectorMultiplyLeft > >::type
 operator* ( const U &lhs, const R &rhs )
 {
-	return R::template multiply<R>( lhs, rhs );
+	return { VectorOperand< R >::wrap( rhs ), lhs };
 }
 
 template < class R, class U >
-typename std::enable_if< std::is_base_of< VectorBase, R >::value, R >::type
+typename std::enable_if< ( VectorOperand< R >::value && !VectorOperand< U >::value ),
+						 VectorScalarExpression< typename VectorOperand< R >::type, U, VectorDivide > >::type
 operator/ ( const R &lhs, const U &rhs )
 {
-	return R::template divide<R>( lhs, rhs );
+	return { VectorOperand< R >::wrap( lhs ), rhs };
+}
+
+template < class E >
+std::ostream& operator<< ( std::ostream &out, const VectorExpression< E > &expression )
+{
+	return out << eval( expression );
 }
 
 template < class U >
@@ -333,23 +490,40 @@ std::ostream& operator<< ( std::ostream &out, const Vector< U > &cVector )
 template < class T > 
 const T dot( const Vector< T > &firstVector, const Vector< T > &secondVector )
 {
-	Vector< T > temp( firstVector );
-	temp.resize( secondVector );
-	T out(0);
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_DOT, 2ull * std::min( firstVector.length(), secondVector.length() ) );
 	
-	for( unsigned int i = 0; i < secondVector.length(); i++ )
-		temp[i] *= secondVector[i];
-		
-	for( unsigned int i = 0; i < temp.length(); i++ )
-		out += temp[i];
-		
-	return out;
+	return VectorKernels< T >::dot( firstVector.data(), secondVector.data(),
+									std::min( firstVector.length(), secondVector.length() ) );
+}
+
+template < class T >
+const T sum( const Vector< T > &cVector )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, cVector.length() );
+	
+	return VectorKernels< T >::sum( cVector.data(), cVector.length() );
+}
+
+// y += a * x
+template < class T >
+Vector< T >& axpy( Vector< T > &y, const T &a, const Vector< T > &x )
+{
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_ARITHMETIC, 2ull * x.length() );
+	
+	if( x.length() > y.length() )
+		y.resize( x.length() );
+	
+	VectorKernels< T >::axpy( y.data(), a, x.data(), x.length() );
+	
+	return y;
 }
 
 template < class T >
 Vector< T > cross( const Vector< T > &lhVector, const Vector< T > &rhVector )
 {
-	if( lhVector.size() != 3 || rhVector.size() != 3 )
+	LINEAR_ALGEBRA_INSTRUMENT_SCOPE( OP_VECTOR_CROSS, 9 );
+	
+	if( lhVector.length() != 3 || rhVector.length() != 3 )
 	{
 		class CrossProductException
 			: public std::exception
@@ -385,8 +559,10 @@ constexpr unsigned int Vector< T >::length() const
 template < class T >
 void Vector< T >::resize( unsigned int newSize )
 {
-	while( newSize > _values.size() )
-		_values.push_back( T( 0 ) );
+	if( newSize > _values.size() )
+		_values.resize( newSize, T( 0 ) );
 }
 
+#include "FixedVector.h"
+
 #endif
@@ -0,0 +1,289 @@
+#ifndef __INCL_VECTOREXPRESSION_H__
+#define __INCL_VECTOREXPRESSION_H__
+
+#include <iterator>
+#include <cstddef>
+#include <algorithm>
+
+// Lazy element-wise arithmetic. The free operators in Vector.h build a tree
+// of these nodes instead of computing intermediate vectors; the tree is
+// evaluated in a single pass when it is converted to its result type.
+//
+// Every node exposes result_type (the Vector-derived type the expression
+// evaluates to), value_type, length(), operator[] and shape(), which
+// returns the leftmost operand so that e.g. Matrix can recover its
+// dimensions. Operands are held by reference, so an expression must not
+// outlive the full-expression that created it.
+//
+// Building a binary node passes the shapes of both operands to
+// checkExpressionShapes. Vectors and polynomials of different lengths
+// combine by zero padding, so the default accepts anything; Matrix
+// overloads it to reject operands of different dimensions, which covers
+// every leaf of a larger tree as it is built.
+
+struct VectorExpressionBase {};
+
+template < class E >
+class VectorExpression
+	: public VectorExpressionBase
+{
+public:
+	const E& self() const;
+};
+
+template < class E >
+class VectorExpressionIterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename E::value_type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const value_type* pointer;
+	typedef value_type reference;
+
+	VectorExpressionIterator( const E& expression, unsigned int index ) :
+		_expression( &expression ),
+		_index( index )
+		{}
+
+	value_type operator* () const;
+	VectorExpressionIterator< E >& operator++ ();
+	VectorExpressionIterator< E > operator++ ( int );
+
+	bool operator== ( const VectorExpressionIterator< E >& ) const;
+	bool operator!= ( const VectorExpressionIterator< E >& ) const;
+
+private:
+	const E* _expression;
+	unsigned int _index;
+};
+
+template < class S >
+void checkExpressionShapes( const S&, const S& )
+{
+}
+
+// Leaf node referring to a Vector, Polynomial or Matrix. Reads past the end
+// of the operand yield zero, matching the padding done by Vector::add.
+template < class R >
+class VectorReference
+	: public VectorExpression< VectorReference< R > >
+{
+public:
+	typedef R result_type;
+	typedef typename R::value_type value_type;
+
+	explicit VectorReference( const R& operand ) :
+		_operand( operand ),
+		_length( operand.length() )
+		{}
+
+	unsigned int length() const;
+	value_type operator[] ( const unsigned int ) const;
+	const R& shape() const;
+
+private:
+	const R& _operand;
+	unsigned int _length;
+};
+
+template < class L, class R, class Op >
+class VectorBinaryExpression
+	: public VectorExpression< VectorBinaryExpression< L, R, Op > >
+{
+public:
+	typedef typename L::result_type result_type;
+	typedef typename L::value_type value_type;
+
+	VectorBinaryExpression( const L& lhs, const R& rhs ) :
+		_lhs( lhs ),
+		_rhs( rhs )
+		{
+			checkExpressionShapes( _lhs.shape(), _rhs.shape() );
+		}
+
+	unsigned int length() const;
+	value_type operator[] ( const unsigned int ) const;
+	const result_type& shape() const;
+
+private:
+	L _lhs;
+	R _rhs;
+};
+
+template < class E, class S, class Op >
+class VectorScalarExpression
+	: public VectorExpression< VectorScalarExpression< E, S, Op > >
+{
+public:
+	typedef typename E::result_type result_type;
+	typedef typename E::value_type value_type;
+
+	VectorScalarExpression( const E& expression, const S& scalar ) :
+		_expression( expression ),
+		_scalar( scalar )
+		{}
+
+	unsigned int length() const;
+	value_type operator[] ( const unsigned int ) const;
+	const result_type& shape() const;
+
+private:
+	E _expression;
+	S _scalar;
+};
+
+// Element operations
+
+struct VectorAdd
+{
+	template < class A, class B >
+		static constexpr A apply( const A& a, const B& b ) { return a + b; }
+};
+
+struct VectorSubtract
+{
+	template < class A, class B >
+		static constexpr A apply( const A& a, const B& b ) { return a - b; }
+};
+
+struct VectorMultiply
+{
+	template < class A, class B >
+		static constexpr A apply( const A& a, const B& b ) { return a * b; }
+};
+
+struct VectorMultiplyLeft
+{
+	template < class A, class B >
+		static constexpr A apply( const A& a, const B& b ) { return b * a; }
+};
+
+struct VectorDivide
+{
+	template < class A, class B >
+		static constexpr A apply( const A& a, const B& b ) { return a / b; }
+};
+
+// VectorExpression
+
+template < class E >
+const E& VectorExpression< E >::self() const
+{
+	return static_cast< const E& >( *this );
+}
+
+template < class E >
+VectorExpressionIterator< E > begin( const VectorExpression< E >& expression )
+{
+	return VectorExpressionIterator< E >( expression.self(), 0 );
+}
+
+template < class E >
+VectorExpressionIterator< E > end( const VectorExpression< E >& expression )
+{
+	return VectorExpressionIterator< E >( expression.self(), expression.self().length() );
+}
+
+template < class E >
+typename E::result_type eval( const VectorExpression< E >& expression )
+{
+	return typename E::result_type( expression );
+}
+
+// VectorExpressionIterator
+
+template < class E >
+typename VectorExpressionIterator< E >::value_type VectorExpressionIterator< E >::operator* () const
+{
+	return (*_expression)[ _index ];
+}
+
+template < class E >
+VectorExpressionIterator< E >& VectorExpressionIterator< E >::operator++ ()
+{
+	++_index;
+	return *this;
+}
+
+template < class E >
+VectorExpressionIterator< E > VectorExpressionIterator< E >::operator++ ( int )
+{
+	VectorExpressionIterator< E > old( *this );
+	++_index;
+	return old;
+}
+
+template < class E >
+bool VectorExpressionIterator< E >::operator== ( const VectorExpressionIterator< E >& other ) const
+{
+	return _index == other._index;
+}
+
+template < class E >
+bool VectorExpressionIterator< E >::operator!= ( const VectorExpressionIterator< E >& other ) const
+{
+	return _index != other._index;
+}
+
+// VectorReference
+
+template < class R >
+unsigned int VectorReference< R >::length() const
+{
+	return _length;
+}
+
+template < class R >
+typename VectorReference< R >::value_type VectorReference< R >::operator[] ( const unsigned int index ) const
+{
+	return ( index < _length ) ? _operand.data()[ index ] : value_type( 0 );
+}
+
+template < class R >
+const R& VectorReference< R >::shape() const
+{
+	return _operand;
+}
+
+// VectorBinaryExpression
+
+template < class L, class R, class Op >
+unsigned int VectorBinaryExpression< L, R, Op >::length() const
+{
+	return std::max( _lhs.length(), _rhs.length() );
+}
+
+template < class L, class R, class Op >
+typename VectorBinaryExpression< L, R, Op >::value_type VectorBinaryExpression< L, R, Op >::operator[] ( const unsigned int index ) const
+{
+	return Op::apply( _lhs[ index ], _rhs[ index ] );
+}
+
+template < class L, class R, class Op >
+const typename VectorBinaryExpression< L, R, Op >::result_type& VectorBinaryExpression< L, R, Op >::shape() const
+{
+	return _lhs.shape();
+}
+
+// VectorScalarExpression
+
+template < class E, class S, class Op >
+unsigned int VectorScalarExpression< E, S, Op >::length() const
+{
+	return _expression.length();
+}
+
+template < class E, class S, class Op >
+typename VectorScalarExpression< E, S, Op >::value_type VectorScalarExpression< E, S, Op >::operator[] ( const unsigned int index ) const
+{
+	return Op::apply( _expression[ index ], _scalar );
+}
+
+template < class E, class S, class Op >
+const typename VectorScalarExpression< E, S, Op >::result_type& VectorScalarExpression< E, S, Op >::shape() const
+{
+	return _expression.shape();
+}
+
+#endif
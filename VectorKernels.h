@@ -0,0 +1,854 @@
+#ifndef __INCL_VECTORKERNELS_H__
+#define __INCL_VECTORKERNELS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Element-wise kernels over raw storage. For float, double and the 32 and
+// 64 bit integral types on x86 they are vectorized with SSE4.1, AVX2 or
+// AVX-512, chosen at run time from what the CPU supports; every other
+// element type, and every other platform, uses the plain loops. Define
+// LINEAR_ALGEBRA_NO_SIMD to force the plain loops everywhere.
+
+#if !defined( LINEAR_ALGEBRA_NO_SIMD ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define LINEAR_ALGEBRA_SIMD
+#include <immintrin.h>
+#endif
+
+// SimdTraits< T >::lane is the type whose register operations serve T.
+// Integral types are matched by width rather than by name: wrapping
+// addition, subtraction and multiplication give the same bits for every
+// signed and unsigned type of a size, so long, long long and their unsigned
+// forms all take the 64 bit lanes, whichever of them int64_t names.
+
+template < class T, class = void >
+struct SimdTraits
+{
+	static const bool supported = false;
+};
+
+#ifdef LINEAR_ALGEBRA_SIMD
+template <> struct SimdTraits< float > { static const bool supported = true; typedef float lane; };
+template <> struct SimdTraits< double > { static const bool supported = true; typedef double lane; };
+
+template < class T >
+struct SimdTraits< T, typename std::enable_if< std::is_integral< T >::value && !std::is_same< T, bool >::value && sizeof( T ) == 4 >::type >
+{
+	static const bool supported = true;
+	typedef std::int32_t lane;
+};
+
+template < class T >
+struct SimdTraits< T, typename std::enable_if< std::is_integral< T >::value && !std::is_same< T, bool >::value && sizeof( T ) == 8 >::type >
+{
+	static const bool supported = true;
+	typedef std::int64_t lane;
+};
+#endif
+
+template < class T, bool Simd = SimdTraits< T >::supported >
+struct VectorKernels;
+
+// out[i] += in[i], out[i] -= in[i], out[i] *= scalar, out[i] += scalar * in[i],
+// out[i] *= in[i], out[i] -= a[i] * b[i], out[i] += the sum over t < terms of
+// a[t * aStride + i] * b[t * bStride + i], and the dot product and sum of n
+// elements.
+
+template < class T >
+struct VectorKernels< T, false >
+{
+	static void add( T*, const T*, std::size_t );
+	static void subtract( T*, const T*, std::size_t );
+	template < class V >
+		static void scale( T*, const V&, std::size_t );
+	static void axpy( T*, const T&, const T*, std::size_t );
+	static void multiply( T*, const T*, std::size_t );
+	static void multiplyAccumulate( T*, const T*, std::size_t, const T*, std::size_t, unsigned int, std::size_t );
+	static void multiplySubtract( T*, const T*, const T*, std::size_t );
+	static T dot( const T*, const T*, std::size_t );
+	static T sum( const T*, std::size_t );
+};
+
+template < class T >
+void VectorKernels< T, false >::add( T* out, const T* in, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] += in[i];
+}
+
+template < class T >
+void VectorKernels< T, false >::subtract( T* out, const T* in, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] -= in[i];
+}
+
+template < class T >
+template < class V >
+void VectorKernels< T, false >::scale( T* out, const V& scalar, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] *= scalar;
+}
+
+template < class T >
+void VectorKernels< T, false >::axpy( T* out, const T& scalar, const T* in, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] += scalar * in[i];
+}
+
+template < class T >
+void VectorKernels< T, false >::multiply( T* out, const T* in, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] *= in[i];
+}
+
+template < class T >
+void VectorKernels< T, false >::multiplyAccumulate( T* out, const T* a, std::size_t aStride, const T* b, std::size_t bStride, unsigned int terms, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+	{
+		T acc = out[i];
+		for( unsigned int t = 0; t < terms; t++ )
+			acc += a[ t * aStride + i ] * b[ t * bStride + i ];
+		out[i] = acc;
+	}
+}
+
+template < class T >
+void VectorKernels< T, false >::multiplySubtract( T* out, const T* a, const T* b, std::size_t n )
+{
+	for( std::size_t i = 0; i < n; i++ )
+		out[i] -= a[i] * b[i];
+}
+
+template < class T >
+T VectorKernels< T, false >::dot( const T* a, const T* b, std::size_t n )
+{
+	T out( 0 );
+
+	for( std::size_t i = 0; i < n; i++ )
+		out += a[i] * b[i];
+
+	return out;
+}
+
+template < class T >
+T VectorKernels< T, false >::sum( const T* in, std::size_t n )
+{
+	T out( 0 );
+
+	for( std::size_t i = 0; i < n; i++ )
+		out += in[i];
+
+	return out;
+}
+
+#ifdef LINEAR_ALGEBRA_SIMD
+
+#define LINEAR_ALGEBRA_TARGET_SSE41 __attribute__(( target( "sse4.1" ) ))
+#define LINEAR_ALGEBRA_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#define LINEAR_ALGEBRA_TARGET_AVX512 __attribute__(( target( "avx512f" ) ))
+
+enum SimdLevel
+{
+	SIMD_NONE,
+	SIMD_SSE41,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+inline SimdLevel simdLevel()
+{
+	static const SimdLevel level =
+		__builtin_cpu_supports( "avx512f" ) ? SIMD_AVX512 :
+		__builtin_cpu_supports( "avx2" ) ? SIMD_AVX2 :
+		__builtin_cpu_supports( "sse4.1" ) ? SIMD_SSE41 : SIMD_NONE;
+
+	return level;
+}
+
+// Per-instruction-set register operations. Each provides the register type,
+// its width in elements, unaligned load and store, broadcast, and lane-wise
+// add, subtract and multiply (wrapping for the integer types). The integer
+// forms load and store through any pointer, so that every integral type
+// sharing the lanes can use them.
+
+template < class T > struct Sse41Ops;
+template < class T > struct Avx2Ops;
+template < class T > struct Avx512Ops;
+
+template <>
+struct Sse41Ops< float >
+{
+	typedef __m128 reg;
+	static const std::size_t width = 4;
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg load( const float* p ) { return _mm_loadu_ps( p ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static void store( float* p, reg a ) { _mm_storeu_ps( p, a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg set1( float a ) { return _mm_set1_ps( a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg add( reg a, reg b ) { return _mm_add_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg sub( reg a, reg b ) { return _mm_sub_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg mul( reg a, reg b ) { return _mm_mul_ps( a, b ); }
+};
+
+template <>
+struct Sse41Ops< double >
+{
+	typedef __m128d reg;
+	static const std::size_t width = 2;
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg load( const double* p ) { return _mm_loadu_pd( p ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static void store( double* p, reg a ) { _mm_storeu_pd( p, a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg set1( double a ) { return _mm_set1_pd( a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg add( reg a, reg b ) { return _mm_add_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg sub( reg a, reg b ) { return _mm_sub_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg mul( reg a, reg b ) { return _mm_mul_pd( a, b ); }
+};
+
+template <>
+struct Sse41Ops< std::int32_t >
+{
+	typedef __m128i reg;
+	static const std::size_t width = 4;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_SSE41 static reg load( const U* p ) { return _mm_loadu_si128( reinterpret_cast< const reg* >( p ) ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_SSE41 static void store( U* p, reg a ) { _mm_storeu_si128( reinterpret_cast< reg* >( p ), a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg set1( std::int32_t a ) { return _mm_set1_epi32( a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg add( reg a, reg b ) { return _mm_add_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg sub( reg a, reg b ) { return _mm_sub_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg mul( reg a, reg b ) { return _mm_mullo_epi32( a, b ); }
+};
+
+template <>
+struct Sse41Ops< std::int64_t >
+{
+	typedef __m128i reg;
+	static const std::size_t width = 2;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_SSE41 static reg load( const U* p ) { return _mm_loadu_si128( reinterpret_cast< const reg* >( p ) ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_SSE41 static void store( U* p, reg a ) { _mm_storeu_si128( reinterpret_cast< reg* >( p ), a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg set1( std::int64_t a ) { return _mm_set1_epi64x( a ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg add( reg a, reg b ) { return _mm_add_epi64( a, b ); }
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg sub( reg a, reg b ) { return _mm_sub_epi64( a, b ); }
+
+	// Low 64 bits of the product, built from 32 x 32 -> 64 bit multiplies.
+	LINEAR_ALGEBRA_TARGET_SSE41 static reg mul( reg a, reg b )
+	{
+		const reg cross = _mm_add_epi64( _mm_mul_epu32( _mm_srli_epi64( a, 32 ), b ),
+										 _mm_mul_epu32( a, _mm_srli_epi64( b, 32 ) ) );
+		return _mm_add_epi64( _mm_mul_epu32( a, b ), _mm_slli_epi64( cross, 32 ) );
+	}
+};
+
+template <>
+struct Avx2Ops< float >
+{
+	typedef __m256 reg;
+	static const std::size_t width = 8;
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg load( const float* p ) { return _mm256_loadu_ps( p ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static void store( float* p, reg a ) { _mm256_storeu_ps( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg set1( float a ) { return _mm256_set1_ps( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg add( reg a, reg b ) { return _mm256_add_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg sub( reg a, reg b ) { return _mm256_sub_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg mul( reg a, reg b ) { return _mm256_mul_ps( a, b ); }
+};
+
+template <>
+struct Avx2Ops< double >
+{
+	typedef __m256d reg;
+	static const std::size_t width = 4;
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg load( const double* p ) { return _mm256_loadu_pd( p ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static void store( double* p, reg a ) { _mm256_storeu_pd( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg set1( double a ) { return _mm256_set1_pd( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg add( reg a, reg b ) { return _mm256_add_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg sub( reg a, reg b ) { return _mm256_sub_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg mul( reg a, reg b ) { return _mm256_mul_pd( a, b ); }
+};
+
+template <>
+struct Avx2Ops< std::int32_t >
+{
+	typedef __m256i reg;
+	static const std::size_t width = 8;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX2 static reg load( const U* p ) { return _mm256_loadu_si256( reinterpret_cast< const reg* >( p ) ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX2 static void store( U* p, reg a ) { _mm256_storeu_si256( reinterpret_cast< reg* >( p ), a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg set1( std::int32_t a ) { return _mm256_set1_epi32( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg add( reg a, reg b ) { return _mm256_add_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg sub( reg a, reg b ) { return _mm256_sub_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg mul( reg a, reg b ) { return _mm256_mullo_epi32( a, b ); }
+};
+
+template <>
+struct Avx2Ops< std::int64_t >
+{
+	typedef __m256i reg;
+	static const std::size_t width = 4;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX2 static reg load( const U* p ) { return _mm256_loadu_si256( reinterpret_cast< const reg* >( p ) ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX2 static void store( U* p, reg a ) { _mm256_storeu_si256( reinterpret_cast< reg* >( p ), a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg set1( std::int64_t a ) { return _mm256_set1_epi64x( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg add( reg a, reg b ) { return _mm256_add_epi64( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg sub( reg a, reg b ) { return _mm256_sub_epi64( a, b ); }
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static reg mul( reg a, reg b )
+	{
+		const reg cross = _mm256_add_epi64( _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), b ),
+											_mm256_mul_epu32( a, _mm256_srli_epi64( b, 32 ) ) );
+		return _mm256_add_epi64( _mm256_mul_epu32( a, b ), _mm256_slli_epi64( cross, 32 ) );
+	}
+};
+
+template <>
+struct Avx512Ops< float >
+{
+	typedef __m512 reg;
+	static const std::size_t width = 16;
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg load( const float* p ) { return _mm512_loadu_ps( p ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static void store( float* p, reg a ) { _mm512_storeu_ps( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg set1( float a ) { return _mm512_set1_ps( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg add( reg a, reg b ) { return _mm512_add_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg sub( reg a, reg b ) { return _mm512_sub_ps( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg mul( reg a, reg b ) { return _mm512_mul_ps( a, b ); }
+};
+
+template <>
+struct Avx512Ops< double >
+{
+	typedef __m512d reg;
+	static const std::size_t width = 8;
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg load( const double* p ) { return _mm512_loadu_pd( p ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static void store( double* p, reg a ) { _mm512_storeu_pd( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg set1( double a ) { return _mm512_set1_pd( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg add( reg a, reg b ) { return _mm512_add_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg sub( reg a, reg b ) { return _mm512_sub_pd( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg mul( reg a, reg b ) { return _mm512_mul_pd( a, b ); }
+};
+
+template <>
+struct Avx512Ops< std::int32_t >
+{
+	typedef __m512i reg;
+	static const std::size_t width = 16;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX512 static reg load( const U* p ) { return _mm512_loadu_si512( p ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX512 static void store( U* p, reg a ) { _mm512_storeu_si512( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg set1( std::int32_t a ) { return _mm512_set1_epi32( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg add( reg a, reg b ) { return _mm512_add_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg sub( reg a, reg b ) { return _mm512_sub_epi32( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg mul( reg a, reg b ) { return _mm512_mullo_epi32( a, b ); }
+};
+
+template <>
+struct Avx512Ops< std::int64_t >
+{
+	typedef __m512i reg;
+	static const std::size_t width = 8;
+
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX512 static reg load( const U* p ) { return _mm512_loadu_si512( p ); }
+	template < class U >
+		LINEAR_ALGEBRA_TARGET_AVX512 static void store( U* p, reg a ) { _mm512_storeu_si512( p, a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg set1( std::int64_t a ) { return _mm512_set1_epi64( a ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg add( reg a, reg b ) { return _mm512_add_epi64( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg sub( reg a, reg b ) { return _mm512_sub_epi64( a, b ); }
+	LINEAR_ALGEBRA_TARGET_AVX512 static reg mul( reg a, reg b ) { return _mm512_mullox_epi64( a, b ); }
+};
+
+// The loops themselves. They are spelled out once per instruction set
+// because a function's target attribute cannot be a template parameter.
+// Reductions keep two accumulators to hide the add latency and combine the
+// lanes once at the end.
+
+template < class T >
+struct Sse41Kernels
+{
+	typedef Sse41Ops< typename SimdTraits< T >::lane > Ops;
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void add( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] += in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void subtract( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] -= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void scale( T* out, const T scalar, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), s ) );
+		for( ; i < n; i++ )
+			out[i] *= scalar;
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void axpy( T* out, const T scalar, const T* in, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::mul( s, Ops::load( in + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] += scalar * in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void multiply( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] *= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void multiplyAccumulate( T* out, const T* a, std::size_t aStride, const T* b, std::size_t bStride, unsigned int terms, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			typename Ops::reg acc0 = Ops::load( out + i ), acc1 = Ops::load( out + i + Ops::width );
+			for( unsigned int t = 0; t < terms; t++ )
+			{
+				const T* at = a + t * aStride + i;
+				const T* bt = b + t * bStride + i;
+				acc0 = Ops::add( acc0, Ops::mul( Ops::load( at ), Ops::load( bt ) ) );
+				acc1 = Ops::add( acc1, Ops::mul( Ops::load( at + Ops::width ), Ops::load( bt + Ops::width ) ) );
+			}
+			Ops::store( out + i, acc0 );
+			Ops::store( out + i + Ops::width, acc1 );
+		}
+		VectorKernels< T, false >::multiplyAccumulate( out + i, a + i, aStride, b + i, bStride, terms, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static void multiplySubtract( T* out, const T* a, const T* b, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] -= a[i] * b[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static T dot( const T* a, const T* b, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) );
+			acc1 = Ops::add( acc1, Ops::mul( Ops::load( a + i + Ops::width ), Ops::load( b + i + Ops::width ) ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::dot( a + i, b + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static T sum( const T* in, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::load( in + i ) );
+			acc1 = Ops::add( acc1, Ops::load( in + i + Ops::width ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::sum( in + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_SSE41 static T reduce( typename Ops::reg acc )
+	{
+		T lanes[ Ops::width ];
+		Ops::store( lanes, acc );
+		return VectorKernels< T, false >::sum( lanes, Ops::width );
+	}
+};
+
+template < class T >
+struct Avx2Kernels
+{
+	typedef Avx2Ops< typename SimdTraits< T >::lane > Ops;
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void add( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] += in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void subtract( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] -= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void scale( T* out, const T scalar, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), s ) );
+		for( ; i < n; i++ )
+			out[i] *= scalar;
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void axpy( T* out, const T scalar, const T* in, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::mul( s, Ops::load( in + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] += scalar * in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void multiply( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] *= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void multiplyAccumulate( T* out, const T* a, std::size_t aStride, const T* b, std::size_t bStride, unsigned int terms, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			typename Ops::reg acc0 = Ops::load( out + i ), acc1 = Ops::load( out + i + Ops::width );
+			for( unsigned int t = 0; t < terms; t++ )
+			{
+				const T* at = a + t * aStride + i;
+				const T* bt = b + t * bStride + i;
+				acc0 = Ops::add( acc0, Ops::mul( Ops::load( at ), Ops::load( bt ) ) );
+				acc1 = Ops::add( acc1, Ops::mul( Ops::load( at + Ops::width ), Ops::load( bt + Ops::width ) ) );
+			}
+			Ops::store( out + i, acc0 );
+			Ops::store( out + i + Ops::width, acc1 );
+		}
+		VectorKernels< T, false >::multiplyAccumulate( out + i, a + i, aStride, b + i, bStride, terms, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static void multiplySubtract( T* out, const T* a, const T* b, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] -= a[i] * b[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static T dot( const T* a, const T* b, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) );
+			acc1 = Ops::add( acc1, Ops::mul( Ops::load( a + i + Ops::width ), Ops::load( b + i + Ops::width ) ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::dot( a + i, b + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static T sum( const T* in, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::load( in + i ) );
+			acc1 = Ops::add( acc1, Ops::load( in + i + Ops::width ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::sum( in + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX2 static T reduce( typename Ops::reg acc )
+	{
+		T lanes[ Ops::width ];
+		Ops::store( lanes, acc );
+		return VectorKernels< T, false >::sum( lanes, Ops::width );
+	}
+};
+
+template < class T >
+struct Avx512Kernels
+{
+	typedef Avx512Ops< typename SimdTraits< T >::lane > Ops;
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void add( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] += in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void subtract( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] -= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void scale( T* out, const T scalar, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), s ) );
+		for( ; i < n; i++ )
+			out[i] *= scalar;
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void axpy( T* out, const T scalar, const T* in, std::size_t n )
+	{
+		const typename Ops::reg s = Ops::set1( scalar );
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::add( Ops::load( out + i ), Ops::mul( s, Ops::load( in + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] += scalar * in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void multiply( T* out, const T* in, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::mul( Ops::load( out + i ), Ops::load( in + i ) ) );
+		for( ; i < n; i++ )
+			out[i] *= in[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void multiplyAccumulate( T* out, const T* a, std::size_t aStride, const T* b, std::size_t bStride, unsigned int terms, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			typename Ops::reg acc0 = Ops::load( out + i ), acc1 = Ops::load( out + i + Ops::width );
+			for( unsigned int t = 0; t < terms; t++ )
+			{
+				const T* at = a + t * aStride + i;
+				const T* bt = b + t * bStride + i;
+				acc0 = Ops::add( acc0, Ops::mul( Ops::load( at ), Ops::load( bt ) ) );
+				acc1 = Ops::add( acc1, Ops::mul( Ops::load( at + Ops::width ), Ops::load( bt + Ops::width ) ) );
+			}
+			Ops::store( out + i, acc0 );
+			Ops::store( out + i + Ops::width, acc1 );
+		}
+		VectorKernels< T, false >::multiplyAccumulate( out + i, a + i, aStride, b + i, bStride, terms, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static void multiplySubtract( T* out, const T* a, const T* b, std::size_t n )
+	{
+		std::size_t i = 0;
+		for( ; i + Ops::width <= n; i += Ops::width )
+			Ops::store( out + i, Ops::sub( Ops::load( out + i ), Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) ) );
+		for( ; i < n; i++ )
+			out[i] -= a[i] * b[i];
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static T dot( const T* a, const T* b, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) );
+			acc1 = Ops::add( acc1, Ops::mul( Ops::load( a + i + Ops::width ), Ops::load( b + i + Ops::width ) ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::dot( a + i, b + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static T sum( const T* in, std::size_t n )
+	{
+		typename Ops::reg acc0 = Ops::set1( T( 0 ) ), acc1 = acc0;
+		std::size_t i = 0;
+		for( ; i + 2 * Ops::width <= n; i += 2 * Ops::width )
+		{
+			acc0 = Ops::add( acc0, Ops::load( in + i ) );
+			acc1 = Ops::add( acc1, Ops::load( in + i + Ops::width ) );
+		}
+		return reduce( Ops::add( acc0, acc1 ) ) + VectorKernels< T, false >::sum( in + i, n - i );
+	}
+
+	LINEAR_ALGEBRA_TARGET_AVX512 static T reduce( typename Ops::reg acc )
+	{
+		T lanes[ Ops::width ];
+		Ops::store( lanes, acc );
+		return VectorKernels< T, false >::sum( lanes, Ops::width );
+	}
+};
+
+// Runtime dispatch. Scaling by a scalar of another type keeps the plain
+// loop so that the arithmetic conversions are the same as for *=.
+
+template < class T >
+struct VectorKernels< T, true >
+{
+	static void add( T*, const T*, std::size_t );
+	static void subtract( T*, const T*, std::size_t );
+	static void scale( T*, const T&, std::size_t );
+	template < class V >
+		static void scale( T*, const V&, std::size_t );
+	static void axpy( T*, const T&, const T*, std::size_t );
+	static void multiply( T*, const T*, std::size_t );
+	static void multiplyAccumulate( T*, const T*, std::size_t, const T*, std::size_t, unsigned int, std::size_t );
+	static void multiplySubtract( T*, const T*, const T*, std::size_t );
+	static T dot( const T*, const T*, std::size_t );
+	static T sum( const T*, std::size_t );
+};
+
+template < class T >
+void VectorKernels< T, true >::add( T* out, const T* in, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::add( out, in, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::add( out, in, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::add( out, in, n ); break;
+	default: VectorKernels< T, false >::add( out, in, n );
+	}
+}
+
+template < class T >
+void VectorKernels< T, true >::subtract( T* out, const T* in, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::subtract( out, in, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::subtract( out, in, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::subtract( out, in, n ); break;
+	default: VectorKernels< T, false >::subtract( out, in, n );
+	}
+}
+
+template < class T >
+void VectorKernels< T, true >::scale( T* out, const T& scalar, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::scale( out, scalar, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::scale( out, scalar, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::scale( out, scalar, n ); break;
+	default: VectorKernels< T, false >::scale( out, scalar, n );
+	}
+}
+
+template < class T >
+template < class V >
+void VectorKernels< T, true >::scale( T* out, const V& scalar, std::size_t n )
+{
+	VectorKernels< T, false >::scale( out, scalar, n );
+}
+
+template < class T >
+void VectorKernels< T, true >::axpy( T* out, const T& scalar, const T* in, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::axpy( out, scalar, in, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::axpy( out, scalar, in, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::axpy( out, scalar, in, n ); break;
+	default: VectorKernels< T, false >::axpy( out, scalar, in, n );
+	}
+}
+
+template < class T >
+void VectorKernels< T, true >::multiply( T* out, const T* in, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::multiply( out, in, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::multiply( out, in, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::multiply( out, in, n ); break;
+	default: VectorKernels< T, false >::multiply( out, in, n );
+	}
+}
+
+template < class T >
+void VectorKernels< T, true >::multiplyAccumulate( T* out, const T* a, std::size_t aStride, const T* b, std::size_t bStride, unsigned int terms, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::multiplyAccumulate( out, a, aStride, b, bStride, terms, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::multiplyAccumulate( out, a, aStride, b, bStride, terms, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::multiplyAccumulate( out, a, aStride, b, bStride, terms, n ); break;
+	default: VectorKernels< T, false >::multiplyAccumulate( out, a, aStride, b, bStride, terms, n );
+	}
+}
+
+template < class T >
+void VectorKernels< T, true >::multiplySubtract( T* out, const T* a, const T* b, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: Avx512Kernels< T >::multiplySubtract( out, a, b, n ); break;
+	case SIMD_AVX2: Avx2Kernels< T >::multiplySubtract( out, a, b, n ); break;
+	case SIMD_SSE41: Sse41Kernels< T >::multiplySubtract( out, a, b, n ); break;
+	default: VectorKernels< T, false >::multiplySubtract( out, a, b, n );
+	}
+}
+
+template < class T >
+T VectorKernels< T, true >::dot( const T* a, const T* b, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: return Avx512Kernels< T >::dot( a, b, n );
+	case SIMD_AVX2: return Avx2Kernels< T >::dot( a, b, n );
+	case SIMD_SSE41: return Sse41Kernels< T >::dot( a, b, n );
+	default: return VectorKernels< T, false >::dot( a, b, n );
+	}
+}
+
+template < class T >
+T VectorKernels< T, true >::sum( const T* in, std::size_t n )
+{
+	switch( simdLevel() )
+	{
+	case SIMD_AVX512: return Avx512Kernels< T >::sum( in, n );
+	case SIMD_AVX2: return Avx2Kernels< T >::sum( in, n );
+	case SIMD_SSE41: return Sse41Kernels< T >::sum( in, n );
+	default: return VectorKernels< T, false >::sum( in, n );
+	}
+}
+
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __INCL_BENCHMARKDATA_H__
+#define __INCL_BENCHMARKDATA_H__
+
+#include "Vector.h"
+#include "Matrix.h"
+#include "MatrixBatch.h"
+#include "Polynomial.h"
+#include <random>
+#include <type_traits>
+
+// Reproducible inputs for the benchmarks: small integers for exact types,
+// so that products stay clear of overflow, and values in [ -1, 1 ] otherwise.
+
+template < class T >
+typename std::enable_if< std::is_integral< T >::value, T >::type
+	randomValue( std::mt19937& engine )
+{
+	return T( std::uniform_int_distribution< int >( -8, 8 )( engine ) );
+}
+
+template < class T >
+typename std::enable_if< !std::is_integral< T >::value, T >::type
+	randomValue( std::mt19937& engine )
+{
+	return T( std::uniform_real_distribution< double >( -1.0, 1.0 )( engine ) );
+}
+
+template < class T >
+Vector< T > randomVector( const unsigned int size, const unsigned int seed = 1 )
+{
+	std::mt19937 engine( seed );
+	Vector< T > v( size );
+	for( unsigned int i = 0; i < size; i++ )
+		v[i] = randomValue< T >( engine );
+
+	return v;
+}
+
+template < class T >
+Matrix< T > randomMatrix( const unsigned int rows, const unsigned int columns, const unsigned int seed = 1 )
+{
+	std::mt19937 engine( seed );
+	Matrix< T > m( rows, columns );
+	for( unsigned int i = 0; i < rows * columns; i++ )
+		m.data()[i] = randomValue< T >( engine );
+
+	return m;
+}
+
+template < class T >
+MatrixBatch< T > randomBatch( const unsigned int count, const unsigned int rows, const unsigned int columns, const unsigned int seed = 1 )
+{
+	std::mt19937 engine( seed );
+	MatrixBatch< T > batch( count, rows, columns );
+	for( unsigned int r = 0; r < rows; r++ )
+		for( unsigned int c = 0; c < columns; c++ )
+			for( unsigned int b = 0; b < count; b++ )
+				batch( b, r, c ) = randomValue< T >( engine );
+
+	return batch;
+}
+
+template < class T >
+Polynomial< T > randomPolynomial( const unsigned int terms, const unsigned int seed = 1 )
+{
+	std::mt19937 engine( seed );
+	Polynomial< T > p;
+	p.truncate( terms );
+	for( unsigned int i = 0; i < terms; i++ )
+		p[i] = randomValue< T >( engine );
+
+	if( terms && p[ terms - 1 ] == T( 0 ) )
+		p[ terms - 1 ] = T( 1 );
+
+	return p;
+}
+
+#endif
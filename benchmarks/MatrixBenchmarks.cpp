@@ -0,0 +1,139 @@
+#include "BenchmarkData.h"
+#include <benchmark/benchmark.h>
+
+template < class T >
+static void BM_MatrixMultiply( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Matrix< T > a = randomMatrix< T >( n, n, 1 ), b = randomMatrix< T >( n, n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a * b );
+
+	// Multiply-adds.
+	state.SetItemsProcessed( state.iterations() * n * n * n );
+	state.SetComplexityN( n );
+}
+
+template < class T >
+static void BM_StrassenMultiply( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Matrix< T > a = randomMatrix< T >( n, n, 1 ), b = randomMatrix< T >( n, n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( strassenMultiply( a, b ) );
+
+	// Multiply-adds of the classical product, so the rate compares directly
+	// with BM_MatrixMultiply.
+	state.SetItemsProcessed( state.iterations() * n * n * n );
+}
+
+template < class T >
+static void BM_Transpose( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Matrix< T > a = randomMatrix< T >( n, n + 1, 1 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a.transpose() );
+
+	state.SetBytesProcessed( state.iterations() * n * ( n + 1 ) * 2 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_TransposeInPlace( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	Matrix< T > a = randomMatrix< T >( n, n, 1 );
+
+	for( auto _ : state )
+	{
+		a.transposeInPlace();
+		benchmark::DoNotOptimize( a.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed( state.iterations() * n * n * 2 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_Rref( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Matrix< T > a = randomMatrix< T >( n, n, 1 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a.rref() );
+
+	state.SetItemsProcessed( state.iterations() * n * n * n );
+	state.SetComplexityN( n );
+}
+
+template < class T >
+static void BM_Append( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Matrix< T > a = randomMatrix< T >( n, n, 1 ), b = randomMatrix< T >( n, n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( append( a, b ) );
+
+	state.SetBytesProcessed( state.iterations() * n * n * 4 * sizeof( T ) );
+}
+
+// A batch of 4096 matrices of size n, counting matrices processed.
+template < class T >
+static void BM_BatchMultiply( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 ), count = 4096;
+	const MatrixBatch< T > a = randomBatch< T >( count, n, n, 1 ), b = randomBatch< T >( count, n, n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a * b );
+
+	state.SetItemsProcessed( state.iterations() * count );
+}
+
+template < class T >
+static void BM_BatchSolve( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 ), count = 4096;
+	const MatrixBatch< T > a = randomBatch< T >( count, n, n, 1 ), b = randomBatch< T >( count, n, 1, 2 );
+	MatrixBatch< T > x;
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( solve( a, b, x ) );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * count );
+}
+
+#define MATRIX_BENCHMARK( name, type, largest ) \
+	BENCHMARK_TEMPLATE( name, type )->RangeMultiplier( 2 )->Range( 16, largest )
+
+MATRIX_BENCHMARK( BM_MatrixMultiply, float, 512 )->Complexity( benchmark::oNCubed );
+MATRIX_BENCHMARK( BM_MatrixMultiply, double, 512 )->Complexity( benchmark::oNCubed );
+MATRIX_BENCHMARK( BM_MatrixMultiply, long long, 256 )->Complexity( benchmark::oNCubed );
+BENCHMARK_TEMPLATE( BM_StrassenMultiply, double )->Arg( 512 )->Arg( 1024 );
+BENCHMARK_TEMPLATE( BM_StrassenMultiply, int )->Arg( 512 )->Arg( 1024 );
+MATRIX_BENCHMARK( BM_Transpose, float, 2048 );
+MATRIX_BENCHMARK( BM_Transpose, double, 2048 );
+MATRIX_BENCHMARK( BM_TransposeInPlace, double, 2048 );
+MATRIX_BENCHMARK( BM_Rref, float, 256 )->Complexity( benchmark::oNCubed );
+MATRIX_BENCHMARK( BM_Rref, double, 256 )->Complexity( benchmark::oNCubed );
+MATRIX_BENCHMARK( BM_Append, double, 1024 );
+
+#define BATCH_BENCHMARK( name, type ) \
+	BENCHMARK_TEMPLATE( name, type )->DenseRange( 4, 16, 4 )->Arg( 3 )
+
+BATCH_BENCHMARK( BM_BatchMultiply, float );
+BATCH_BENCHMARK( BM_BatchMultiply, double );
+BATCH_BENCHMARK( BM_BatchSolve, float );
+BATCH_BENCHMARK( BM_BatchSolve, double );
+
+// Fraction-free elimination over the integers grows the entries with the
+// size, so the exact type is kept to small matrices.
+BENCHMARK_TEMPLATE( BM_Rref, long long )->RangeMultiplier( 2 )->Range( 4, 8 );
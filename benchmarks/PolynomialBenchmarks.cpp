@@ -0,0 +1,81 @@
+#include "BenchmarkData.h"
+#include <benchmark/benchmark.h>
+
+template < class T >
+static void BM_PolynomialMultiply( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Polynomial< T > a = randomPolynomial< T >( n, 1 ), b = randomPolynomial< T >( n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a * b );
+
+	state.SetComplexityN( n );
+}
+
+// Raising a fixed polynomial of degree 4 with coefficients 0 and 1, which
+// keeps the exact coefficients in range for the exponents used.
+template < class T >
+static void BM_Pow( benchmark::State& state )
+{
+	const unsigned long long exponent = state.range( 0 );
+	const Polynomial< T > base{ T( 1 ), T( 1 ), T( 0 ), T( 1 ), T( 1 ) };
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( pow( base, exponent ) );
+}
+
+template < class T >
+static void BM_Derivative( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Polynomial< T > a = randomPolynomial< T >( n, 1 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( derivative( a ) );
+
+	state.SetItemsProcessed( state.iterations() * n );
+}
+
+template < class T >
+static void BM_Evaluate( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Polynomial< T > a = randomPolynomial< T >( n, 1 );
+	const T x = T( 1 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( a( x ) );
+
+	state.SetItemsProcessed( state.iterations() * n );
+}
+
+// Degree n at n points.
+template < class T >
+static void BM_EvaluateMany( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Polynomial< T > a = randomPolynomial< T >( n, 1 );
+	const Vector< T > points = randomVector< T >( n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( evaluate( a, points ) );
+
+	state.SetItemsProcessed( state.iterations() * n * n );
+	state.SetComplexityN( n );
+}
+
+#define POLYNOMIAL_BENCHMARK( name, type, smallest, largest ) \
+	BENCHMARK_TEMPLATE( name, type )->RangeMultiplier( 4 )->Range( smallest, largest )
+
+POLYNOMIAL_BENCHMARK( BM_PolynomialMultiply, float, 16, 1 << 16 )->Complexity();
+POLYNOMIAL_BENCHMARK( BM_PolynomialMultiply, double, 16, 1 << 16 )->Complexity();
+POLYNOMIAL_BENCHMARK( BM_PolynomialMultiply, long long, 16, 1 << 16 )->Complexity();
+POLYNOMIAL_BENCHMARK( BM_Pow, double, 4, 256 );
+POLYNOMIAL_BENCHMARK( BM_Pow, long long, 4, 16 );
+POLYNOMIAL_BENCHMARK( BM_Derivative, double, 16, 1 << 16 );
+POLYNOMIAL_BENCHMARK( BM_Derivative, long long, 16, 1 << 16 );
+POLYNOMIAL_BENCHMARK( BM_Evaluate, double, 16, 1 << 16 );
+POLYNOMIAL_BENCHMARK( BM_Evaluate, long long, 16, 1 << 16 );
+POLYNOMIAL_BENCHMARK( BM_EvaluateMany, double, 16, 1 << 14 )->Complexity();
+POLYNOMIAL_BENCHMARK( BM_EvaluateMany, long long, 16, 1 << 14 )->Complexity();
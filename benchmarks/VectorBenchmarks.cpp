@@ -0,0 +1,134 @@
+#include "BenchmarkData.h"
+#include <benchmark/benchmark.h>
+
+template < class T >
+static void BM_Dot( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 ), b = randomVector< T >( n, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( dot( a, b ) );
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 2 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_Add( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 ), b = randomVector< T >( n, 2 );
+	Vector< T > c( n );
+
+	for( auto _ : state )
+	{
+		c = a + b;
+		benchmark::DoNotOptimize( c.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 3 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_Subtract( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 ), b = randomVector< T >( n, 2 );
+	Vector< T > c( n );
+
+	for( auto _ : state )
+	{
+		c = a - b;
+		benchmark::DoNotOptimize( c.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 3 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_Scale( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 );
+	Vector< T > c( n );
+
+	for( auto _ : state )
+	{
+		c = a * T( 3 );
+		benchmark::DoNotOptimize( c.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 2 * sizeof( T ) );
+}
+
+// A fused expression, a + 2 b - c, against three separate passes.
+template < class T >
+static void BM_Expression( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 ), b = randomVector< T >( n, 2 ), c = randomVector< T >( n, 3 );
+	Vector< T > d( n );
+
+	for( auto _ : state )
+	{
+		d = a + T( 2 ) * b - c;
+		benchmark::DoNotOptimize( d.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 4 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_CompoundAdd( benchmark::State& state )
+{
+	const unsigned int n = state.range( 0 );
+	const Vector< T > a = randomVector< T >( n, 1 );
+	Vector< T > c = randomVector< T >( n, 2 );
+
+	for( auto _ : state )
+	{
+		c += a;
+		benchmark::DoNotOptimize( c.data() );
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed( state.iterations() * n );
+	state.SetBytesProcessed( state.iterations() * n * 3 * sizeof( T ) );
+}
+
+template < class T >
+static void BM_Cross( benchmark::State& state )
+{
+	const Vector< T > a = randomVector< T >( 3, 1 ), b = randomVector< T >( 3, 2 );
+
+	for( auto _ : state )
+		benchmark::DoNotOptimize( cross( a, b ) );
+
+	state.SetItemsProcessed( state.iterations() );
+}
+
+#define VECTOR_BENCHMARK( name, type ) \
+	BENCHMARK_TEMPLATE( name, type )->RangeMultiplier( 16 )->Range( 64, 1 << 20 )
+
+VECTOR_BENCHMARK( BM_Dot, float );
+VECTOR_BENCHMARK( BM_Dot, double );
+VECTOR_BENCHMARK( BM_Dot, long long );
+VECTOR_BENCHMARK( BM_Add, float );
+VECTOR_BENCHMARK( BM_Add, double );
+VECTOR_BENCHMARK( BM_Add, long long );
+VECTOR_BENCHMARK( BM_Subtract, double );
+VECTOR_BENCHMARK( BM_Scale, float );
+VECTOR_BENCHMARK( BM_Scale, double );
+VECTOR_BENCHMARK( BM_Expression, double );
+VECTOR_BENCHMARK( BM_CompoundAdd, double );
+BENCHMARK_TEMPLATE( BM_Cross, double );
+BENCHMARK_TEMPLATE( BM_Cross, long long );
@@ -0,0 +1,22 @@
+#ifndef __INCL_CHECK_H__
+#define __INCL_CHECK_H__
+
+#include <iostream>
+
+// A minimal harness for the unit tests: CHECK reports a failed condition
+// with its location and counts it, and a test program returns the count
+// from main, so that ctest sees any failure.
+
+static int checkFailures = 0;
+
+#define CHECK( condition ) \
+	do \
+	{ \
+		if( !( condition ) ) \
+		{ \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK( " #condition " ) failed\n"; \
+			checkFailures++; \
+		} \
+	} while( false )
+
+#endif
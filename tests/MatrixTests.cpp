@@ -0,0 +1,64 @@
+#include "Matrix.h"
+#include "Check.h"
+
+static void testRank()
+{
+	const Matrix< int > integer = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+
+	CHECK( integer.rank() == 2 );
+
+	// Unsigned elements take the exact path, which must compile although
+	// abs is ambiguous for them.
+	const Matrix< unsigned int > singular = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+	const Matrix< unsigned int > regular = { { 2, 1 }, { 1, 1 } };
+	const Matrix< unsigned int > zero( 2, 3 );
+
+	CHECK( singular.rank() == 2 );
+	CHECK( regular.rank() == 2 );
+	CHECK( zero.rank() == 0 );
+
+	const Matrix< double > real = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+	const Matrix< double > nearlySingular = { { 1, 1 }, { 1, 1 + 1e-17 } };
+
+	CHECK( real.rank() == 2 );
+	CHECK( nearlySingular.rank() == 1 );
+}
+
+// A product large enough to recurse, with short entries spread over the
+// whole range, so that sums and products of the unsigned short words would
+// overflow int; the result must be the classical product wrapped to short.
+static void testStrassenNarrow()
+{
+	const unsigned int n = Strassen< short >::CROSSOVER + 3;
+	Matrix< short > a( n, n ), b( n, n );
+
+	for( unsigned int i = 0; i < n; i++ )
+		for( unsigned int j = 0; j < n; j++ )
+		{
+			a[i][j] = (short)( ( i * 7919u + j * 104729u ) % 65536u - 32768u );
+			b[i][j] = (short)( ( i * 15485863u + j * 2750159u ) % 65536u - 32768u );
+		}
+
+	const Matrix< short > c = strassenMultiply( a, b );
+
+	bool equal = true;
+	for( unsigned int i = 0; i < n; i++ )
+		for( unsigned int j = 0; j < n; j++ )
+		{
+			unsigned int sum = 0;
+			for( unsigned int l = 0; l < n; l++ )
+				sum += (unsigned int)a[i][l] * (unsigned int)b[l][j];
+
+			equal = equal && c[i][j] == (short)sum;
+		}
+
+	CHECK( equal );
+}
+
+int main()
+{
+	testRank();
+	testStrassenNarrow();
+
+	return checkFailures;
+}
@@ -0,0 +1,36 @@
+#include "MultivariatePolynomial.h"
+#include "Check.h"
+#include <vector>
+
+// Evaluation at more points than MultivariateKernels::BLOCK, which binds
+// BLOCK by reference; built without optimization, this fails to link unless
+// BLOCK is defined out of class.
+static void testEvaluateMany()
+{
+	const MultivariatePolynomial< long long > p( 2, { { { 2, 1 }, 3 }, { { 0, 1 }, 2 }, { { 0, 0 }, -5 } } );
+
+	const std::size_t count = 3 * MultivariateKernels< long long >::BLOCK + 5;
+	std::vector< long long > points( 2 * count ), values( count );
+
+	for( std::size_t i = 0; i < count; i++ )
+	{
+		points[ 2 * i ] = (long long)i - 100;
+		points[ 2 * i + 1 ] = 7 - (long long)i;
+	}
+
+	evaluate( p, points.data(), count, values.data() );
+
+	for( std::size_t i = 0; i < count; i++ )
+	{
+		const long long x = points[ 2 * i ], y = points[ 2 * i + 1 ];
+
+		CHECK( values[i] == 3 * x * x * y + 2 * y - 5 );
+	}
+}
+
+int main()
+{
+	testEvaluateMany();
+
+	return checkFailures;
+}
@@ -0,0 +1,66 @@
+#include "Polynomial.h"
+#include "Check.h"
+
+// With THRESHOLD points and coefficients, evaluate() takes the subproduct
+// tree, whose node products overflow long long long before the values do;
+// at points of magnitude at most 1 the values must still be those of
+// Horner's rule, which does not overflow.
+static void testEvaluateSubproductTree()
+{
+	const std::size_t count = SubproductTree< long long >::THRESHOLD;
+
+	Polynomial< long long > p;
+	p.truncate( count );
+	Vector< long long > points( count );
+
+	for( std::size_t i = 0; i < count; i++ )
+	{
+		p[i] = (long long)( i % 7 ) - 3;
+		points[i] = (long long)( i % 3 ) - 1;
+	}
+
+	const Vector< long long > values = evaluate( p, points );
+
+	for( std::size_t i = 0; i < count; i++ )
+		CHECK( values[i] == EvaluationKernels< long long >::horner( p.data(), p.length(), points[i] ) );
+}
+
+// Past NEWTON_DIVISION the quotient comes from the inverse series of the
+// reversed divisor, whose coefficients overflow long long although the
+// quotient and remainder are small; divide() must still recover them, for
+// either unit as the leading coefficient.
+static void testNewtonDivision()
+{
+	const unsigned int m = Polynomial< long long >::NEWTON_DIVISION + 5, k = Polynomial< long long >::NEWTON_DIVISION + 9;
+
+	for( const long long lead : { 1ll, -1ll } )
+	{
+		Polynomial< long long > divisor, quotient, remainder;
+		divisor.truncate( m + 1 );
+		quotient.truncate( k );
+		remainder.truncate( m );
+
+		for( unsigned int i = 0; i < m; i++ )
+		{
+			divisor[i] = (long long)( i % 5 ) - 2;
+			remainder[i] = (long long)( i % 11 ) - 5;
+		}
+		divisor[m] = lead;
+		for( unsigned int i = 0; i < k; i++ )
+			quotient[i] = (long long)( i % 3 ) - 1;
+
+		const Polynomial< long long > dividend = quotient * divisor + remainder;
+		const std::pair< Polynomial< long long >, Polynomial< long long > > result = divide( dividend, divisor );
+
+		CHECK( result.first == quotient );
+		CHECK( result.second == remainder.trim() );
+	}
+}
+
+int main()
+{
+	testEvaluateSubproductTree();
+	testNewtonDivision();
+
+	return checkFailures;
+}
@@ -0,0 +1,52 @@
+#include "SparseMatrix.h"
+#include "Check.h"
+#include <vector>
+#include <cstddef>
+#include <exception>
+
+// Whether adopting the given compressed arrays as a 2 x 3 CSR matrix throws.
+static bool rejects( std::vector< std::size_t > offsets, std::vector< unsigned int > indices, std::vector< double > values )
+{
+	try
+	{
+		SparseMatrix< double >( 2, 3, std::move( offsets ), std::move( indices ), std::move( values ) );
+	}
+	catch( const std::exception& )
+	{
+		return true;
+	}
+
+	return false;
+}
+
+static void testAdoptCompressed()
+{
+	const SparseMatrix< double > valid( 2, 3, { 0, 2, 3 }, { 0, 2, 1 }, { 1, 2, 3 } );
+
+	CHECK( valid( 0, 2 ) == 2 );
+	CHECK( valid( 1, 1 ) == 3 );
+	CHECK( valid( 1, 0 ) == 0 );
+
+	CHECK( !rejects( { 0, 0, 0 }, {}, {} ) );
+
+	// Offsets of the wrong length, not starting at zero, decreasing, or not
+	// ending at the number of values.
+	CHECK( rejects( { 0, 3 }, { 0, 1, 2 }, { 1, 2, 3 } ) );
+	CHECK( rejects( { 1, 2, 3 }, { 0, 1, 2 }, { 1, 2, 3 } ) );
+	CHECK( rejects( { 0, 3, 2 }, { 0, 1, 2 }, { 1, 2 } ) );
+	CHECK( rejects( { 0, 1, 2 }, { 0, 1, 2 }, { 1, 2, 3 } ) );
+
+	// Indices and values of different lengths, an index past the last
+	// column, and indices out of order within a row.
+	CHECK( rejects( { 0, 1, 2 }, { 0, 1 }, { 1, 2, 3 } ) );
+	CHECK( rejects( { 0, 1, 2 }, { 0, 3 }, { 1, 2 } ) );
+	CHECK( rejects( { 0, 2, 2 }, { 2, 0 }, { 1, 2 } ) );
+	CHECK( rejects( { 0, 2, 2 }, { 1, 1 }, { 1, 2 } ) );
+}
+
+int main()
+{
+	testAdoptCompressed();
+
+	return checkFailures;
+}
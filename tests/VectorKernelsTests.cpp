@@ -0,0 +1,94 @@
+#include "VectorKernels.h"
+#include "Evaluation.h"
+#include "Check.h"
+#include <vector>
+#include <cstddef>
+
+// Integral types are vectorized by width, whatever name int64_t has.
+static void testSupported()
+{
+#ifdef LINEAR_ALGEBRA_SIMD
+	CHECK( SimdTraits< int >::supported );
+	CHECK( SimdTraits< unsigned int >::supported );
+	CHECK( SimdTraits< long long >::supported );
+	CHECK( SimdTraits< unsigned long long >::supported );
+	CHECK( SimdTraits< long >::supported );
+	CHECK( SimdTraits< unsigned long >::supported );
+#endif
+	CHECK( !SimdTraits< bool >::supported );
+	CHECK( !SimdTraits< short >::supported );
+	CHECK( !SimdTraits< long double >::supported );
+}
+
+// Every kernel of VectorKernels< T > against the plain loops, over lengths
+// that leave a tail after the full registers. The values come from seed,
+// which for the unsigned types is chosen so that the products wrap.
+template < class T >
+static void checkAgainstPlain( const T seed )
+{
+	typedef VectorKernels< T > Kernels;
+	typedef VectorKernels< T, false > Plain;
+
+	for( std::size_t n = 0; n < 70; n += 23 )
+	{
+		std::vector< T > a( n ), b( n ), c( 3 * n );
+		for( std::size_t i = 0; i < n; i++ )
+		{
+			a[i] = T( seed * T( i + 1 ) + T( 3 ) );
+			b[i] = T( seed * T( 2 * i + 1 ) - T( i ) );
+		}
+		for( std::size_t i = 0; i < c.size(); i++ )
+			c[i] = T( seed + T( i ) );
+
+		std::vector< T > x( a ), y( a );
+		Kernels::add( x.data(), b.data(), n );
+		Plain::add( y.data(), b.data(), n );
+		CHECK( x == y );
+
+		Kernels::subtract( x.data(), b.data(), n );
+		Plain::subtract( y.data(), b.data(), n );
+		CHECK( x == y );
+
+		Kernels::scale( x.data(), seed, n );
+		Plain::scale( y.data(), seed, n );
+		CHECK( x == y );
+
+		Kernels::axpy( x.data(), seed, b.data(), n );
+		Plain::axpy( y.data(), seed, b.data(), n );
+		CHECK( x == y );
+
+		Kernels::multiply( x.data(), b.data(), n );
+		Plain::multiply( y.data(), b.data(), n );
+		CHECK( x == y );
+
+		Kernels::multiplySubtract( x.data(), a.data(), b.data(), n );
+		Plain::multiplySubtract( y.data(), a.data(), b.data(), n );
+		CHECK( x == y );
+
+		Kernels::multiplyAccumulate( x.data(), c.data(), n, a.data(), 0, 3, n );
+		Plain::multiplyAccumulate( y.data(), c.data(), n, a.data(), 0, 3, n );
+		CHECK( x == y );
+
+		CHECK( Kernels::dot( a.data(), b.data(), n ) == Plain::dot( a.data(), b.data(), n ) );
+		CHECK( Kernels::sum( a.data(), n ) == Plain::sum( a.data(), n ) );
+
+		std::vector< T > values( n ), expected( n );
+		EvaluationKernels< T >::horner( c.data(), 3, a.data(), n, values.data() );
+		EvaluationKernels< T, false >::horner( c.data(), 3, a.data(), n, expected.data() );
+		CHECK( values == expected );
+	}
+}
+
+int main()
+{
+	testSupported();
+
+	checkAgainstPlain< int >( 3 );
+	checkAgainstPlain< long long >( -2 );
+	checkAgainstPlain< long >( 5 );
+	checkAgainstPlain< unsigned int >( 0x9e3779b9u );
+	checkAgainstPlain< unsigned long long >( 0x9e3779b97f4a7c15ull );
+	checkAgainstPlain< unsigned long >( 0xc2b2ae35ul );
+
+	return checkFailures;
+}